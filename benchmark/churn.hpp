@@ -0,0 +1,86 @@
+#ifndef HEIM_BENCHMARK_CHURN_HPP
+#define HEIM_BENCHMARK_CHURN_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "harness.hpp"
+
+namespace heim::benchmark
+{
+/*!
+ * \brief
+ *   Measures the latency of each operation of a steady-state churn: entities with random component
+ *   mixes are continuously despawned and spawned, keeping the population of the registry constant.
+ *
+ * \details
+ *   Each operation is timed individually, so that the spikes caused by the reallocations of the
+ *   core and of the pools show up in the tail percentiles instead of being averaged away. The
+ *   latencies include the overhead of reading the clock twice.
+ */
+template<
+    typename    Registry,
+    typename ...Components>
+void
+run_churn(harness &h, std::size_t const population, std::size_t const operations)
+{
+  using clock_type = std::chrono::steady_clock;
+  using identifier = typename Registry::identifier_type;
+
+  std::string const name{"churn/" + std::to_string(population)};
+
+  if (!h.selected(name))
+    return;
+
+  Registry                reg{};
+  std::vector<identifier> alive;
+  std::mt19937_64         rng{population};
+
+  auto const spawn{[&reg, &rng]
+  {
+    auto                e   {reg.entity()};
+    std::uint64_t const mask{rng()};
+    std::size_t         bit {};
+
+    ((mask >> bit++ & 1 ? e.template emplace<Components>() : void()), ...);
+    return e.identifier();
+  }};
+
+  alive.reserve(population);
+  for (std::size_t i{}; i < population; ++i)
+    alive.push_back(spawn());
+
+  std::vector<double> spawns;
+  std::vector<double> despawns;
+
+  spawns  .reserve(operations);
+  despawns.reserve(operations);
+
+  for (std::size_t op{}; op < operations; ++op)
+  {
+    std::size_t const idx{static_cast<std::size_t>(rng() % alive.size())};
+
+    auto const t0{clock_type::now()};
+    reg.destroy(alive[idx]);
+    auto const t1{clock_type::now()};
+    alive[idx] = spawn();
+    auto const t2{clock_type::now()};
+
+    despawns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+    spawns  .push_back(std::chrono::duration<double, std::nano>(t2 - t1).count());
+  }
+
+  std::vector<double> all{despawns};
+  all.insert(all.end(), spawns.begin(), spawns.end());
+
+  h.report_latencies(name + "/despawn", despawns);
+  h.report_latencies(name + "/spawn"  , spawns);
+  h.report_latencies(name + "/all"    , all);
+}
+
+} // namespace heim::benchmark
+
+#endif // HEIM_BENCHMARK_CHURN_HPP
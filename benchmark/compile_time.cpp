@@ -0,0 +1,70 @@
+// Instantiates a registry of HEIM_COMPILE_TIME_COMPONENTS component types and the operations commonly
+// made on each of them, to measure the cost of compiling registries with many components. It is
+// compiled for several component counts by benchmark/compile_time.py .
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <heim/registry.hpp>
+
+#ifndef HEIM_COMPILE_TIME_COMPONENTS
+  #define HEIM_COMPILE_TIME_COMPONENTS 50
+#endif
+
+namespace
+{
+template<std::size_t I>
+struct component
+{
+  std::uint32_t value;
+};
+
+
+template<typename>
+struct registry_of;
+
+template<std::size_t ...Is>
+struct registry_of<std::index_sequence<Is ...>>
+{
+  using type = heim::sparse::static_registry::with_all<component<Is> ...>;
+};
+
+using registry
+= typename registry_of<std::make_index_sequence<HEIM_COMPILE_TIME_COMPONENTS>>::type;
+
+
+template<std::size_t I>
+std::uint64_t
+exercise(registry &reg, registry::identifier_type const id)
+{
+  reg.emplace<component<I>>(id, static_cast<std::uint32_t>(I));
+
+  std::uint64_t sum{reg.get<component<I>>(id).value};
+
+  for (auto e : reg.query<component<I>>())
+    sum += e.template get<component<I>>().value;
+
+  if constexpr (I > 0)
+  {
+    for (auto e : reg.query<heim::conjunction<component<I - 1>, component<I>>>())
+      sum += e.template get<component<I - 1>>().value;
+  }
+  return sum;
+}
+
+template<std::size_t ...Is>
+std::uint64_t
+exercise_all(registry &reg, std::index_sequence<Is ...>)
+{
+  auto const id{reg.entity().identifier()};
+  return (exercise<Is>(reg, id) + ...);
+}
+
+} // namespace
+
+
+int main()
+{
+  registry reg{};
+  return exercise_all(reg, std::make_index_sequence<HEIM_COMPILE_TIME_COMPONENTS>{}) == 0 ? 1 : 0;
+}
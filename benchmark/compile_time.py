@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Measures the time and peak memory taken to compile benchmark/compile_time.cpp for registries of
+several component counts.
+
+usage: compile_time.py [--counts 50,200,500] [--include DIR] [--source FILE] -- COMPILER [ARGS...]
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+
+def compile_once(compiler, include, source, count, output):
+    command = [*compiler, '-std=c++23', f'-I{include}', f'-DHEIM_COMPILE_TIME_COMPONENTS={count}',
+               '-c', str(source), '-o', output]
+
+    start = time.perf_counter()
+    process = subprocess.Popen(command)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.perf_counter() - start
+
+    if os.waitstatus_to_exitcode(status) != 0:
+        sys.exit(f'compile_time: compilation of {count} components failed')
+
+    # ru_maxrss is in kibibytes on Linux and in bytes on macOS
+    peak = usage.ru_maxrss * (1 if sys.platform == 'darwin' else 1024)
+    return elapsed, peak
+
+
+def main():
+    root = Path(__file__).resolve().parent.parent
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--counts' , default='50,200,500')
+    parser.add_argument('--include', default=str(root / 'include'))
+    parser.add_argument('--source' , default=str(root / 'benchmark' / 'compile_time.cpp'))
+    parser.add_argument('compiler' , nargs='+')
+    args = parser.parse_args()
+
+    print(f'{"components":>10}  {"time (s)":>9}  {"peak memory (MiB)":>17}')
+    with tempfile.TemporaryDirectory() as tmp:
+        for count in (int(c) for c in args.counts.split(',')):
+            elapsed, peak = compile_once(args.compiler, args.include, args.source, count, os.path.join(tmp, 'out.o'))
+            print(f'{count:>10}  {elapsed:>9.2f}  {peak / (1 << 20):>17.1f}', flush=True)
+
+
+if __name__ == '__main__':
+    main()
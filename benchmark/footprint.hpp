@@ -0,0 +1,298 @@
+#ifndef HEIM_BENCHMARK_FOOTPRINT_HPP
+#define HEIM_BENCHMARK_FOOTPRINT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <heim/registry.hpp>
+#include "harness.hpp"
+
+namespace heim::benchmark
+{
+/*!
+ * \brief
+ *   The number of bytes currently and at most allocated through the counting allocators sharing it.
+ */
+struct allocation_counter
+{
+  std::size_t current{};
+  std::size_t peak   {};
+};
+
+
+/*!
+ * \brief
+ *   An allocator forwarding to \c std::allocator and counting the bytes it allocates into a shared
+ *   counter.
+ */
+template<typename T>
+class counting_allocator
+{
+  template<typename>
+  friend class counting_allocator;
+
+public:
+  using value_type = T;
+
+private:
+  allocation_counter *m_counter;
+
+public:
+  explicit constexpr
+  counting_allocator(allocation_counter &counter)
+  noexcept
+    : m_counter{&counter}
+  { }
+
+  template<typename U>
+  constexpr
+  counting_allocator(counting_allocator<U> const &other)
+  noexcept
+    : m_counter{other.m_counter}
+  { }
+
+  [[nodiscard]]
+  T *
+  allocate(std::size_t const n)
+  {
+    T *const ptr{std::allocator<T>{}.allocate(n)};
+
+    m_counter->current += n * sizeof(T);
+    m_counter->peak     = std::max(m_counter->peak, m_counter->current);
+    return ptr;
+  }
+
+  void
+  deallocate(T * const ptr, std::size_t const n)
+  noexcept
+  {
+    m_counter->current -= n * sizeof(T);
+    std::allocator<T>{}.deallocate(ptr, n);
+  }
+
+  template<typename U>
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(counting_allocator const &lhs, counting_allocator<U> const &rhs)
+  noexcept
+  { return lhs.m_counter == rhs.m_counter; }
+};
+
+
+namespace footprint
+{
+template<std::size_t>
+struct component { float x, y, z, w; };
+
+template<typename ...Components>
+using registry
+= typename heim::sparse::generic_static_registry<
+    std::uint64_t,
+    counting_allocator<std::uint64_t>>
+    ::template with_all<Components ...>;
+
+
+struct result
+{
+  std::size_t entities;
+  std::size_t peak;
+  std::size_t steady;
+};
+
+/*!
+ * \brief
+ *   Measures the bytes allocated by a registry holding components on n identifiers, distributed
+ *   among the created identifiers according to the specified distribution:
+ *   - \c dense : every created identifier;
+ *   - \c sparse : one created identifier out of 64;
+ *   - \c fragmented : a random tenth of the created identifiers, the others being destroyed.
+ *
+ * \details
+ *   The steady-state bytes are measured after a churn phase, in which a random quarter of the
+ *   identifiers holding components is destroyed and as many are created with the same components,
+ *   several times over, so that they account for recycled identifiers and grown containers.
+ */
+template<typename ...Components>
+[[nodiscard]]
+result
+measure(std::string_view const dist, std::size_t const n)
+{
+  using registry_type = registry<Components ...>;
+  using identifier    = typename registry_type::identifier_type;
+
+  allocation_counter counter{};
+  result             res    {};
+
+  {
+    registry_type           reg{counting_allocator<identifier>{counter}};
+    std::vector<identifier> ids;
+    std::mt19937_64         rng{n};
+
+    if (dist == "dense")
+    {
+      for (std::size_t i{}; i < n; ++i)
+        ids.push_back(reg.entity().identifier());
+    }
+    else if (dist == "sparse")
+    {
+      for (std::size_t i{}; i < n * 64; ++i)
+      {
+        identifier const id{reg.entity().identifier()};
+
+        if (i % 64 == 0)
+          ids.push_back(id);
+      }
+    }
+    else
+    {
+      std::vector<identifier> created;
+
+      for (std::size_t i{}; i < n * 10; ++i)
+        created.push_back(reg.entity().identifier());
+
+      std::ranges::shuffle(created, rng);
+      ids.assign(created.begin(), created.begin() + static_cast<std::ptrdiff_t>(n));
+
+      for (auto it{created.begin() + static_cast<std::ptrdiff_t>(n)}; it != created.end(); ++it)
+        reg.destroy(*it);
+    }
+
+    for (identifier const id : ids)
+      (reg.template emplace<Components>(id), ...);
+
+    for (std::size_t round{}; round < 8; ++round)
+    {
+      std::ranges::shuffle(ids, rng);
+
+      for (std::size_t i{}; i < ids.size() / 4; ++i)
+      {
+        reg.destroy(ids[i]);
+
+        ids[i] = reg.entity().identifier();
+        (reg.template emplace<Components>(ids[i]), ...);
+      }
+    }
+
+    res.entities = reg.size();
+    res.steady   = counter.current;
+    res.peak     = counter.peak;
+  }
+
+  return res;
+}
+
+} // namespace footprint
+
+
+/*!
+ * \brief
+ *   Measures the peak and steady-state bytes allocated by registries in standard scenarios, and
+ *   returns whether none of them exceeds its baseline.
+ *
+ * \details
+ *   Baselines are read from the CSV file given with \c --footprint-baseline , with lines of the form
+ *   \c scenario,peak_bytes,steady_bytes . A scenario regresses when either of its measures exceeds
+ *   its baseline by more than the tolerance given with \c --footprint-tolerance . The current
+ *   measures can be written in the same format with \c --footprint-record . \n
+ *   The baselines of the repository are kept in \c benchmark/footprint.csv , against which the
+ *   \c footprint test of the build checks every scenario.
+ */
+inline
+bool
+run_footprint(harness &h)
+{
+  struct baseline
+  {
+    std::size_t peak;
+    std::size_t steady;
+  };
+
+  if (!h.selected("footprint"))
+    return true;
+
+  std::map<std::string, baseline, std::less<>> baselines;
+
+  if (h.opts().footprint_baseline != nullptr)
+  {
+    std::FILE *const file{std::fopen(h.opts().footprint_baseline, "r")};
+
+    if (file == nullptr)
+    {
+      std::fprintf(stderr, "error: cannot open %s\n", h.opts().footprint_baseline);
+      return false;
+    }
+
+    char        name[128];
+    std::size_t peak;
+    std::size_t steady;
+
+    while (std::fscanf(file, " %127[^,],%zu,%zu", name, &peak, &steady) == 3)
+      baselines.emplace(name, baseline{peak, steady});
+
+    std::fclose(file);
+  }
+
+  std::FILE *const record{h.opts().footprint_record != nullptr ? std::fopen(h.opts().footprint_record, "w") : nullptr};
+  bool             passed{true};
+
+  if (h.opts().footprint_record != nullptr && record == nullptr)
+  {
+    std::fprintf(stderr, "error: cannot open %s\n", h.opts().footprint_record);
+    return false;
+  }
+
+  std::printf("\n%-52s %10s %14s %14s %10s\n", "case (bytes)", "entities", "peak", "steady", "status");
+
+  auto const report{[&](std::string const &name, footprint::result const &res)
+  {
+    char const *status{"-"};
+
+    if (auto const it{baselines.find(name)}; it != baselines.end())
+    {
+      double const limit{1. + h.opts().footprint_tolerance};
+
+      bool const regressed
+      =  static_cast<double>(res.peak)   > static_cast<double>(it->second.peak)   * limit
+      || static_cast<double>(res.steady) > static_cast<double>(it->second.steady) * limit;
+
+      status = regressed ? "REGRESSED" : "ok";
+      passed = passed && !regressed;
+    }
+
+    std::printf("%-52s %10zu %14zu %14zu %10s\n", name.c_str(), res.entities, res.peak, res.steady, status);
+
+    if (record != nullptr)
+      std::fprintf(record, "%s,%zu,%zu\n", name.c_str(), res.peak, res.steady);
+  }};
+
+  for (std::string_view const dist : {"dense", "sparse", "fragmented"})
+  {
+    for (std::size_t const n : {std::size_t{1} << 10, std::size_t{1} << 16})
+    {
+      std::string const suffix{std::string{dist} + "/" + std::to_string(n)};
+
+      using footprint::component;
+
+      report("footprint/few/"  + suffix, footprint::measure<component<0>>(dist, n));
+      report("footprint/many/" + suffix, footprint::measure<
+          component<0>, component<1>, component<2>, component<3>,
+          component<4>, component<5>, component<6>, component<7>>(dist, n));
+    }
+  }
+
+  if (record != nullptr)
+    std::fclose(record);
+
+  return passed;
+}
+
+} // namespace heim::benchmark
+
+#endif // HEIM_BENCHMARK_FOOTPRINT_HPP
@@ -0,0 +1,269 @@
+#ifndef HEIM_BENCHMARK_HARNESS_HPP
+#define HEIM_BENCHMARK_HARNESS_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "perf_counters.hpp"
+
+namespace heim::benchmark
+{
+/*!
+ * \brief
+ *   Prevents the compiler from optimizing away the computation of the specified value.
+ */
+template<typename T>
+inline
+void
+do_not_optimize(T const &value)
+noexcept
+{ asm volatile("" : : "r,m"(value) : "memory"); }
+
+
+struct options
+{
+  bool             perf               {false};
+  std::string_view filter             {};
+  std::size_t      repetitions        {10};
+  char const      *csv                {nullptr};
+  char const      *footprint_baseline {nullptr};
+  char const      *footprint_record   {nullptr};
+  double           footprint_tolerance{0.};
+
+  [[nodiscard]] static
+  options
+  parse(int const argc, char ** const argv)
+  {
+    options opts{};
+
+    for (int i{1}; i < argc; ++i)
+    {
+      std::string_view const arg{argv[i]};
+
+      if (arg == "--perf")
+        opts.perf = true;
+      else if (arg == "--filter" && i + 1 < argc)
+        opts.filter = argv[++i];
+      else if (arg == "--csv" && i + 1 < argc)
+        opts.csv = argv[++i];
+      else if (arg == "--repetitions" && i + 1 < argc)
+        opts.repetitions = std::max<std::size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+      else if (arg == "--footprint-baseline" && i + 1 < argc)
+        opts.footprint_baseline = argv[++i];
+      else if (arg == "--footprint-record" && i + 1 < argc)
+        opts.footprint_record = argv[++i];
+      else if (arg == "--footprint-tolerance" && i + 1 < argc)
+        opts.footprint_tolerance = std::max(0., std::strtod(argv[++i], nullptr));
+      else
+      {
+        std::fprintf(
+            stderr,
+            "usage: %s [--perf] [--filter substring] [--repetitions n] [--csv path]"
+            " [--footprint-baseline path] [--footprint-record path] [--footprint-tolerance ratio]\n",
+            argv[0]);
+        std::exit(EXIT_FAILURE);
+      }
+    }
+    return opts;
+  }
+};
+
+
+/*!
+ * \brief
+ *   The median time of the repetitions of a benchmark case, and their mean hardware events.
+ */
+struct measurement
+{
+  double                                              nanoseconds;
+  std::array<std::optional<double>, perf_event_count> events;
+};
+
+
+/*!
+ * \brief
+ *   Runs benchmark cases and prints their results normalized per entity.
+ *
+ * \details
+ *   Each case is measured over several repetitions, each on a freshly set up state. The reported
+ *   time is the median of the repetitions, and the reported hardware events (when enabled with
+ *   \c --perf ) are their mean over the repetitions that counted them, or n/a if none did.
+ */
+class harness
+{
+private:
+  using clock_type = std::chrono::steady_clock;
+
+private:
+  options       m_options;
+  perf_counters m_counters;
+
+private:
+  static
+  void
+  s_print_header(bool const perf)
+  {
+    std::printf("%-52s %10s %12s", "case", "entities", "ns/entity");
+
+    if (perf)
+    {
+      for (std::string_view const name : perf_event_names)
+        std::printf(" %14.*s", static_cast<int>(name.size()), name.data());
+    }
+    std::printf("\n");
+  }
+
+public:
+  explicit
+  harness(options const &opts)
+    : m_options {opts}
+    , m_counters{}
+  {
+    if (m_options.perf && !m_counters.available())
+      std::fprintf(stderr, "warning: hardware performance counters are unavailable on this system\n");
+
+    s_print_header(m_options.perf);
+  }
+
+  [[nodiscard]]
+  options const &
+  opts() const
+  noexcept
+  { return m_options; }
+
+  [[nodiscard]]
+  bool
+  selected(std::string_view const name) const
+  noexcept
+  { return name.find(m_options.filter) != std::string_view::npos; }
+
+
+  /*!
+   * \brief
+   *   Prints the median, tail percentiles and maximum of the specified latencies, in nanoseconds.
+   */
+  void
+  report_latencies(std::string_view const name, std::vector<double> &latencies) const
+  {
+    if (latencies.empty())
+      return;
+
+    std::ranges::sort(latencies);
+
+    auto const percentile{[&latencies](double const p)
+    { return latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))]; }};
+
+    std::printf(
+        "%-52.*s %10zu %10.0f %10.0f %10.0f %10.0f\n",
+        static_cast<int>(name.size()), name.data(),
+        latencies.size(),
+        percentile(0.5), percentile(0.99), percentile(0.999), latencies.back());
+  }
+
+  static
+  void
+  print_latency_header()
+  { std::printf("\n%-52s %10s %10s %10s %10s %10s\n", "case (ns per operation)", "operations", "p50", "p99", "p99.9", "max"); }
+
+  /*!
+   * \brief
+   *   Measures the specified body on the states returned by the specified setup, over the configured
+   *   number of repetitions.
+   */
+  template<
+      typename Setup,
+      typename Body>
+  [[nodiscard]]
+  measurement
+  measure(Setup &&setup, Body &&body)
+  {
+    measurement                               result {};
+    std::vector<double>                       times;
+    std::array<std::size_t, perf_event_count> counted{};
+
+    times.reserve(m_options.repetitions);
+    for (std::size_t rep{}; rep < m_options.repetitions; ++rep)
+    {
+      auto state{setup()};
+
+      if (m_options.perf)
+        m_counters.start();
+
+      auto const begin{clock_type::now()};
+      body(state);
+      auto const end  {clock_type::now()};
+
+      if (m_options.perf)
+      {
+        perf_values const values{m_counters.stop()};
+
+        for (std::size_t i{}; i < perf_event_count; ++i)
+        {
+          if (!values[i])
+            continue;
+
+          result.events[i] = result.events[i].value_or(0.) + static_cast<double>(*values[i]);
+          ++counted[i];
+        }
+      }
+
+      times.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+      do_not_optimize(state);
+    }
+
+    // the mean of each event is taken over the repetitions that counted it
+    for (std::size_t i{}; i < perf_event_count; ++i)
+    {
+      if (result.events[i])
+        *result.events[i] /= static_cast<double>(counted[i]);
+    }
+
+    std::ranges::nth_element(times, times.begin() + static_cast<std::ptrdiff_t>(times.size() / 2));
+
+    result.nanoseconds = times[times.size() / 2];
+    return result;
+  }
+
+  /*!
+   * \brief
+   *   Measures the specified body on the states returned by the specified setup, and prints the
+   *   results normalized by the specified number of entities.
+   */
+  template<
+      typename Setup,
+      typename Body>
+  void
+  run(std::string_view const name, std::size_t const entities, Setup &&setup, Body &&body)
+  {
+    if (!selected(name))
+      return;
+
+    measurement const result    {measure(setup, body)};
+    double      const per_entity{static_cast<double>(std::max<std::size_t>(entities, 1))};
+
+    std::printf("%-52.*s %10zu %12.3f", static_cast<int>(name.size()), name.data(), entities, result.nanoseconds / per_entity);
+
+    if (m_options.perf)
+    {
+      for (std::optional<double> const &events : result.events)
+      {
+        if (events)
+          std::printf(" %14.3f", *events / per_entity);
+        else
+          std::printf(" %14s", "n/a");
+      }
+    }
+    std::printf("\n");
+  }
+};
+
+} // namespace heim::benchmark
+
+#endif // HEIM_BENCHMARK_HARNESS_HPP
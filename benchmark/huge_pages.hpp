@@ -0,0 +1,128 @@
+#ifndef HEIM_BENCHMARK_HUGE_PAGES_HPP
+#define HEIM_BENCHMARK_HUGE_PAGES_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <heim/registry.hpp>
+#include <heim/lib/huge_page_allocator.hpp>
+#include "harness.hpp"
+
+namespace heim::benchmark
+{
+namespace huge_pages
+{
+struct position { float x, y, z; };
+struct velocity { float x, y, z; };
+
+template<
+    typename    Allocator,
+    std::size_t PageSize>
+using registry
+= typename heim::sparse::generic_static_registry<std::uint64_t, Allocator>
+    ::template with<position, PageSize>
+    ::template with<velocity, PageSize>;
+
+
+template<typename Registry>
+struct state
+{
+  Registry                                         reg;
+  std::vector<typename Registry::identifier_type> ids;
+};
+
+// every entity has both components, and the identifiers are returned in random order
+template<typename Registry>
+[[nodiscard]]
+std::unique_ptr<state<Registry>>
+make_state(std::size_t const n)
+{
+  auto            st {std::make_unique<state<Registry>>()};
+  std::mt19937_64 rng{n};
+
+  st->ids.reserve(n);
+  for (std::size_t i{}; i < n; ++i)
+  {
+    auto e{st->reg.entity()};
+
+    e.template emplace<position>(static_cast<float>(i), 0.f, 0.f);
+    e.template emplace<velocity>(1.f, 0.f, 0.f);
+    st->ids.push_back(e.identifier());
+  }
+
+  std::ranges::shuffle(st->ids, rng);
+  return st;
+}
+
+
+template<
+    typename    Allocator,
+    std::size_t PageSize>
+void
+run_configuration(harness &h, std::string const &name, std::size_t const n)
+{
+  using registry_type = registry<Allocator, PageSize>;
+  using state_type    = state<registry_type>;
+
+  std::string const prefix{"huge-pages/" + name + "/page-" + std::to_string(PageSize) + "/"};
+  std::string const suffix{"/" + std::to_string(n)};
+
+  if (!h.selected(prefix + "lookup" + suffix) && !h.selected(prefix + "iterate" + suffix))
+    return;
+
+  // the state is built once and shared by the repetitions, which do not change its structure
+  std::unique_ptr<state_type> const st{make_state<registry_type>(n)};
+
+  h.run(prefix + "lookup" + suffix, n,
+      [&st] { return st.get(); },
+      [](state_type *s)
+      {
+        float sum{};
+
+        for (auto const id : s->ids)
+          sum += s->reg.template get<position>(id).x;
+        do_not_optimize(sum);
+      });
+
+  h.run(prefix + "iterate" + suffix, n,
+      [&st] { return st.get(); },
+      [](state_type *s)
+      {
+        for (auto e : s->reg.template query<heim::conjunction<position, velocity>>())
+          e.template get<position>().x += e.template get<velocity>().x;
+      });
+}
+
+} // namespace huge_pages
+
+
+/*!
+ * \brief
+ *   Measures random lookups and iterations of registries of millions of entities, with their storage
+ *   allocated by \c std::allocator and by \c heim::huge_page_allocator .
+ *
+ * \details
+ *   The reduction of TLB misses shows in the \c dtlb-misses column with \c --perf . Registries with a
+ *   page size of zero have flat sparse arrays, which are then backed by huge pages as well, while the
+ *   sparse pages of the others are too small to be.
+ */
+inline
+void
+run_huge_pages(harness &h)
+{
+  std::size_t const n{std::size_t{1} << 22};
+
+  huge_pages::run_configuration<std::allocator           <std::uint64_t>, 1024>(h, "std" , n);
+  huge_pages::run_configuration<heim::huge_page_allocator<std::uint64_t>, 1024>(h, "huge", n);
+  huge_pages::run_configuration<std::allocator           <std::uint64_t>, 0   >(h, "std" , n);
+  huge_pages::run_configuration<heim::huge_page_allocator<std::uint64_t>, 0   >(h, "huge", n);
+}
+
+} // namespace heim::benchmark
+
+#endif // HEIM_BENCHMARK_HUGE_PAGES_HPP
@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <heim/registry.hpp>
+#include "churn.hpp"
+#include "footprint.hpp"
+#include "harness.hpp"
+#if __has_include(<sys/mman.h>)
+  #include "huge_pages.hpp"
+#endif
+#include "sweep.hpp"
+
+namespace
+{
+struct position { float x, y, z; };
+struct velocity { float x, y, z; };
+struct tag      { };
+struct health   { int   value; };
+struct sprite   { std::uint64_t handle; float u, v, w, h; };
+
+} // namespace
+
+
+// the components of floating-point members are hashed member by member
+template<>
+struct heim::sparse::component_hash<position>
+{
+  [[nodiscard]]
+  std::uint64_t
+  operator()(position const &p, std::uint64_t const seed) const
+  noexcept
+  { return heim::hash_values(seed, p.x, p.y, p.z); }
+};
+
+template<>
+struct heim::sparse::component_hash<velocity>
+{
+  [[nodiscard]]
+  std::uint64_t
+  operator()(velocity const &v, std::uint64_t const seed) const
+  noexcept
+  { return heim::hash_values(seed, v.x, v.y, v.z); }
+};
+
+
+namespace
+{
+using registry
+= heim::sparse::static_registry::with_all<position, velocity, tag>;
+
+using identifier
+= registry::identifier_type;
+
+
+// every entity has a position, every other one a velocity and every fourth one a tag
+registry
+make_registry(std::size_t const n)
+{
+  registry reg{};
+
+  for (std::size_t i{}; i < n; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(static_cast<float>(i), 0.f, 0.f);
+    if (i % 2 == 0)
+      e.emplace<velocity>(1.f, 0.f, 0.f);
+    if (i % 4 == 0)
+      e.emplace<tag>();
+  }
+  return reg;
+}
+
+std::vector<identifier>
+identifiers_of(registry &reg)
+{
+  std::vector<identifier> ids;
+
+  for (auto e : reg)
+    ids.push_back(e.identifier());
+  return ids;
+}
+
+
+void
+run_core(heim::benchmark::harness &h, std::size_t const n)
+{
+  std::string const suffix{"/" + std::to_string(n)};
+
+  h.run("create" + suffix, n,
+      [] { return registry{}; },
+      [n](registry &reg)
+      {
+        for (std::size_t i{}; i < n; ++i)
+          heim::benchmark::do_not_optimize(reg.entity().identifier());
+      });
+
+  h.run("emplace<position>" + suffix, n,
+      [n]
+      {
+        registry reg{};
+
+        for (std::size_t i{}; i < n; ++i)
+          static_cast<void>(reg.entity());
+        return reg;
+      },
+      [](registry &reg)
+      {
+        for (auto e : reg)
+          e.emplace<position>(0.f, 0.f, 0.f);
+      });
+
+  h.run("query<position>" + suffix, n,
+      [n] { return make_registry(n); },
+      [](registry &reg)
+      {
+        for (auto e : reg.query<position>())
+          e.get<position>().x += 1.f;
+      });
+
+  h.run("query<conjunction<position, velocity>>" + suffix, n,
+      [n] { return make_registry(n); },
+      [](registry &reg)
+      {
+        for (auto e : reg.query<heim::conjunction<position, velocity>>())
+          e.get<position>().x += e.get<velocity>().x;
+      });
+
+  h.run("each_chunk<position>" + suffix, n,
+      [n] { return make_registry(n); },
+      [](registry &reg)
+      {
+        reg.query<position>().each_chunk<position>([](std::span<identifier const>, std::span<position> const p)
+        {
+          for (position &pos : p)
+            pos.x += 1.f;
+        });
+      });
+
+  h.run("each_chunk<conjunction<position, velocity>>" + suffix, n,
+      [n] { return make_registry(n); },
+      [](registry &reg)
+      {
+        reg.query<heim::conjunction<position, velocity>>().each_chunk<position, velocity const>(
+            [](std::span<identifier const>, std::span<position> const p, std::span<velocity const> const v)
+            {
+              for (std::size_t i{}; i < p.size(); ++i)
+                p[i].x += v[i].x;
+            });
+      });
+
+  h.run("query<conjunction<pos, vel, negation<tag>>>" + suffix, n,
+      [n] { return make_registry(n); },
+      [](registry &reg)
+      {
+        for (auto e : reg.query<heim::conjunction<position, velocity, heim::negation<tag>>>())
+          e.get<position>().x += e.get<velocity>().x;
+      });
+
+  auto const shuffled{[n]
+  {
+    registry reg{make_registry(n)};
+    auto     ids{identifiers_of(reg)};
+
+    std::ranges::shuffle(ids, std::mt19937_64{n});
+    return std::tuple{std::move(reg), std::move(ids), std::vector<position>(ids.size())};
+  }};
+
+  h.run("get<position> (shuffled ids)" + suffix, n,
+      shuffled,
+      [](auto &state)
+      {
+        auto &[reg, ids, buffer]{state};
+
+        for (std::size_t i{}; i < ids.size(); ++i)
+          buffer[i] = reg.template get<position>(ids[i]);
+        heim::benchmark::do_not_optimize(buffer.data());
+      });
+
+  h.run("gather<position> (shuffled ids)" + suffix, n,
+      shuffled,
+      [](auto &state)
+      {
+        auto &[reg, ids, buffer]{state};
+
+        reg.template container<position>().gather(ids, buffer);
+        heim::benchmark::do_not_optimize(buffer.data());
+      });
+
+  h.run("scatter<position> (shuffled ids)" + suffix, n,
+      shuffled,
+      [](auto &state)
+      {
+        auto &[reg, ids, buffer]{state};
+
+        reg.template container<position>().scatter(ids, buffer);
+      });
+
+  h.run("hash" + suffix, n,
+      [n] { return make_registry(n); },
+      [](registry &reg) { heim::benchmark::do_not_optimize(reg.hash()); });
+
+  h.run("destroy" + suffix, n,
+      [n]
+      {
+        registry reg{make_registry(n)};
+        auto     ids{identifiers_of(reg)};
+
+        return std::pair{std::move(reg), std::move(ids)};
+      },
+      [](auto &state)
+      {
+        auto &[reg, ids]{state};
+
+        for (identifier const id : ids)
+          reg.destroy(id);
+      });
+}
+
+} // namespace
+
+
+int main(int const argc, char ** const argv)
+{
+  heim::benchmark::harness h{heim::benchmark::options::parse(argc, argv)};
+
+  for (std::size_t const n : {std::size_t{1} << 10, std::size_t{1} << 16, std::size_t{1} << 20})
+    run_core(h, n);
+
+  heim::benchmark::harness::print_latency_header();
+  for (std::size_t const n : {std::size_t{1} << 10, std::size_t{1} << 16, std::size_t{1} << 20})
+  {
+    heim::benchmark::run_churn<
+        heim::sparse::static_registry::with_all<position, velocity, health, sprite, tag>,
+        position, velocity, health, sprite, tag>(h, n, std::size_t{1} << 20);
+  }
+
+  heim::benchmark::run_sweep(h);
+#if __has_include(<sys/mman.h>)
+  heim::benchmark::run_huge_pages(h);
+#endif
+
+  return heim::benchmark::run_footprint(h) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
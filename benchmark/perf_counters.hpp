@@ -0,0 +1,225 @@
+#ifndef HEIM_BENCHMARK_PERF_COUNTERS_HPP
+#define HEIM_BENCHMARK_PERF_COUNTERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace heim::benchmark
+{
+/*!
+ * \brief
+ *   The hardware events counted around each benchmark case.
+ */
+enum class perf_event
+  : std::size_t
+{
+  cycles,
+  instructions,
+  cache_misses,
+  branch_misses,
+  dtlb_misses,
+  count
+};
+
+inline constexpr
+std::size_t
+perf_event_count
+= static_cast<std::size_t>(perf_event::count);
+
+inline constexpr
+std::array<std::string_view, perf_event_count>
+perf_event_names
+{
+  "cycles",
+  "instructions",
+  "llc-misses",
+  "branch-misses",
+  "dtlb-misses"
+};
+
+
+/*!
+ * \brief
+ *   The values of the hardware events counted during a measurement, or nothing for the events that
+ *   could not be counted or whose group was never scheduled.
+ */
+using perf_values
+= std::array<std::optional<std::uint64_t>, perf_event_count>;
+
+
+/*!
+ * \brief
+ *   A group of Linux hardware performance counters, scheduled together on the calling thread.
+ *
+ * \details
+ *   Counters are opened with \c perf_event_open and only count user-space events. Events that the
+ *   kernel refuses to count (e.g. because of \c perf_event_paranoid or of a virtualized CPU) are
+ *   reported as missing, and the group is unavailable altogether on other systems. \n
+ *   When the group has more events than the hardware has counters, the kernel multiplexes it with
+ *   the other groups: its values are then scaled by the ratio of the time it was enabled to the time
+ *   it was counting, and all are reported as missing if it never was scheduled.
+ */
+class perf_counters
+{
+private:
+  std::array<int, perf_event_count> m_fds;
+  std::size_t                       m_opened;
+
+private:
+#if defined(__linux__)
+  struct event_config
+  {
+    std::uint32_t type;
+    std::uint64_t config;
+  };
+
+  static constexpr
+  std::array<event_config, perf_event_count>
+  s_configs
+  {{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)}
+  }};
+
+  [[nodiscard]]
+  int
+  m_leader() const
+  noexcept
+  {
+    for (int const fd : m_fds)
+    {
+      if (fd != -1)
+        return fd;
+    }
+    return -1;
+  }
+#endif
+
+public:
+  perf_counters()
+  noexcept
+    : m_fds   {}
+    , m_opened{}
+  {
+    m_fds.fill(-1);
+
+#if defined(__linux__)
+    for (std::size_t i{}; i < perf_event_count; ++i)
+    {
+      perf_event_attr attr{};
+
+      attr.type           = s_configs[i].type;
+      attr.size           = sizeof(perf_event_attr);
+      attr.config         = s_configs[i].config;
+      attr.disabled       = m_opened == 0 ? 1 : 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      m_fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, m_leader(), 0));
+
+      if (m_fds[i] != -1)
+        ++m_opened;
+    }
+#endif
+  }
+
+  perf_counters(perf_counters const &)
+  = delete;
+
+  ~perf_counters()
+  {
+#if defined(__linux__)
+    for (int const fd : m_fds)
+    {
+      if (fd != -1)
+        ::close(fd);
+    }
+#endif
+  }
+
+  perf_counters &
+  operator=(perf_counters const &)
+  = delete;
+
+  [[nodiscard]]
+  bool
+  available() const
+  noexcept
+  { return m_opened != 0; }
+
+
+  void
+  start()
+  noexcept
+  {
+#if defined(__linux__)
+    if (!available())
+      return;
+
+    ::ioctl(m_leader(), PERF_EVENT_IOC_RESET , PERF_IOC_FLAG_GROUP);
+    ::ioctl(m_leader(), PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+  }
+
+  [[nodiscard]]
+  perf_values
+  stop()
+  noexcept
+  {
+    perf_values values{};
+
+#if defined(__linux__)
+    if (!available())
+      return values;
+
+    ::ioctl(m_leader(), PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // the group is read as its number of events, the times it was enabled and running, then the
+    // values of its events in opening order
+    std::array<std::uint64_t, perf_event_count + 3> buffer{};
+
+    if (::read(m_leader(), buffer.data(), sizeof(buffer)) < static_cast<::ssize_t>(3 * sizeof(std::uint64_t)))
+      return values;
+
+    std::uint64_t const enabled{buffer[1]};
+    std::uint64_t const running{buffer[2]};
+
+    if (running == 0)
+      return values;
+
+    double const scale{static_cast<double>(enabled) / static_cast<double>(running)};
+
+    for (std::size_t i{}, read{}; i < perf_event_count && read < buffer[0]; ++i)
+    {
+      if (m_fds[i] == -1)
+        continue;
+
+      std::uint64_t const value{buffer[3 + read++]};
+
+      values[i] = running < enabled
+          ? static_cast<std::uint64_t>(static_cast<double>(value) * scale)
+          : value;
+    }
+#endif
+
+    return values;
+  }
+};
+
+} // namespace heim::benchmark
+
+#endif // HEIM_BENCHMARK_PERF_COUNTERS_HPP
@@ -0,0 +1,231 @@
+#ifndef HEIM_BENCHMARK_SWEEP_HPP
+#define HEIM_BENCHMARK_SWEEP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+#include <heim/registry.hpp>
+#include "harness.hpp"
+
+namespace heim::benchmark
+{
+namespace sweep
+{
+struct position { float x, y, z; };
+struct velocity { float x, y, z; };
+
+template<
+    typename    Identifier,
+    std::size_t PageSize>
+using registry
+= typename heim::sparse::generic_static_registry<Identifier, std::allocator<Identifier>>
+    ::template with<position, PageSize>
+    ::template with<velocity, PageSize>;
+
+
+/*!
+ * \brief
+ *   The distribution of the identifiers possessing components among all the created identifiers.
+ */
+enum class distribution
+{
+  dense,   // every identifier
+  strided, // one identifier out of spread
+  random   // a random subset of one identifier out of spread, emplaced in random order
+};
+
+inline constexpr
+std::size_t
+spread
+= 8;
+
+[[nodiscard]] inline constexpr
+std::string_view
+name_of(distribution const dist)
+noexcept
+{
+  switch (dist)
+  {
+  case distribution::dense  : return "dense";
+  case distribution::strided: return "strided";
+  case distribution::random : return "random";
+  }
+  return "";
+}
+
+
+template<typename Registry>
+struct state
+{
+  Registry                                         reg;
+  std::vector<typename Registry::identifier_type> ids;
+};
+
+// creates the identifiers of the distribution and emplaces components on n of them, whose
+// identifiers are returned in random order
+template<typename Registry>
+[[nodiscard]]
+state<Registry>
+make_state(distribution const dist, std::size_t const n)
+{
+  using identifier = typename Registry::identifier_type;
+
+  state<Registry>         st{};
+  std::vector<identifier> created;
+  std::mt19937_64         rng{n};
+
+  std::size_t const total{dist == distribution::dense ? n : n * spread};
+
+  created.reserve(total);
+  for (std::size_t i{}; i < total; ++i)
+    created.push_back(st.reg.entity().identifier());
+
+  switch (dist)
+  {
+  case distribution::dense:
+    st.ids = created;
+    break;
+  case distribution::strided:
+    for (std::size_t i{}; i < total; i += spread)
+      st.ids.push_back(created[i]);
+    break;
+  case distribution::random:
+    std::ranges::shuffle(created, rng);
+    st.ids.assign(created.begin(), created.begin() + static_cast<std::ptrdiff_t>(n));
+    break;
+  }
+
+  for (identifier const id : st.ids)
+  {
+    st.reg.template emplace<position>(id, 1.f, 0.f, 0.f);
+    st.reg.template emplace<velocity>(id, 1.f, 0.f, 0.f);
+  }
+
+  std::ranges::shuffle(st.ids, rng);
+  return st;
+}
+
+
+template<
+    typename    Identifier,
+    std::size_t PageSize>
+void
+run_configuration(harness &h, std::FILE * const csv, distribution const dist, std::size_t const n)
+{
+  using registry_type = registry<Identifier, PageSize>;
+  using state_type    = state<registry_type>;
+
+  // the index half of the identifier must be able to address every created identifier
+  std::size_t const total{dist == distribution::dense ? n : n * spread};
+
+  if (total >= std::size_t{std::numeric_limits<typename heim::identifier_traits<Identifier>::index_type>::max()})
+    return;
+
+  auto const setup{[dist, n] { return make_state<registry_type>(dist, n); }};
+
+  auto const report{[&](std::string_view const scenario, measurement const &result)
+  {
+    std::fprintf(
+        csv, "%.*s,%zu,%d,%.*s,%zu,%.3f\n",
+        static_cast<int>(scenario.size()), scenario.data(),
+        PageSize,
+        std::numeric_limits<Identifier>::digits,
+        static_cast<int>(name_of(dist).size()), name_of(dist).data(),
+        n,
+        result.nanoseconds / static_cast<double>(n));
+  }};
+
+  report("lookup", h.measure(setup, [](state_type &st)
+  {
+    float sum{};
+
+    for (Identifier const id : st.ids)
+      sum += st.reg.template get<position>(id).x;
+    do_not_optimize(sum);
+  }));
+
+  report("iterate", h.measure(setup, [](state_type &st)
+  {
+    for (auto e : st.reg.template query<heim::conjunction<position, velocity>>())
+      e.template get<position>().x += e.template get<velocity>().x;
+  }));
+
+  report("churn", h.measure(setup, [](state_type &st)
+  {
+    for (Identifier const id : st.ids)
+    {
+      st.reg.template erase  <velocity>(id);
+      st.reg.template emplace<velocity>(id, 0.f, 1.f, 0.f);
+    }
+  }));
+}
+
+template<typename Identifier>
+void
+run_identifier(harness &h, std::FILE * const csv, distribution const dist, std::size_t const n)
+{
+  run_configuration<Identifier, 0   >(h, csv, dist, n);
+  run_configuration<Identifier, 256 >(h, csv, dist, n);
+  run_configuration<Identifier, 1024>(h, csv, dist, n);
+  run_configuration<Identifier, 4096>(h, csv, dist, n);
+#if __has_include(<sys/mman.h>)
+  run_configuration<Identifier, heim::sparse::reserved_page_size_v<>>(h, csv, dist, n);
+#endif
+}
+
+} // namespace sweep
+
+
+/*!
+ * \brief
+ *   Measures lookup, iteration and churn across page sizes, identifier widths, identifier
+ *   distributions and entity counts, and writes the results as CSV in nanoseconds per entity.
+ *
+ * \details
+ *   The CSV is written to the path given with \c --csv , or to the standard output otherwise.
+ *   Configurations whose identifiers do not fit in the index half of the identifier type are
+ *   skipped. Registries whose sparse containers are reserved in virtual memory report the page size
+ *   \c reserved_page_size_v , the largest \c std::size_t .
+ */
+inline
+void
+run_sweep(harness &h)
+{
+  if (!h.selected("sweep"))
+    return;
+
+  std::FILE *const csv{h.opts().csv != nullptr ? std::fopen(h.opts().csv, "w") : stdout};
+
+  if (csv == nullptr)
+  {
+    std::fprintf(stderr, "error: cannot open %s\n", h.opts().csv);
+    return;
+  }
+
+  if (csv == stdout)
+    std::printf("\n");
+
+  std::fprintf(csv, "scenario,page_size,identifier_bits,distribution,entities,ns_per_entity\n");
+
+  for (sweep::distribution const dist : {sweep::distribution::dense, sweep::distribution::strided, sweep::distribution::random})
+  {
+    for (std::size_t const n : {std::size_t{1} << 10, std::size_t{1} << 13, std::size_t{1} << 16})
+    {
+      sweep::run_identifier<std::uint32_t>(h, csv, dist, n);
+      sweep::run_identifier<std::uint64_t>(h, csv, dist, n);
+    }
+  }
+
+  if (csv != stdout)
+    std::fclose(csv);
+}
+
+} // namespace heim::benchmark
+
+#endif // HEIM_BENCHMARK_SWEEP_HPP
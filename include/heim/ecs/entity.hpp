@@ -119,6 +119,12 @@ public:
   noexcept
   { return m_registry->template matches<Expression>(m_identifier); }
 
+  [[nodiscard]] constexpr
+  bool
+  enabled() const
+  noexcept
+  { return m_registry->enabled(m_identifier); }
+
   template<typename Component>
   [[nodiscard]] constexpr
   Component &
@@ -204,11 +210,36 @@ public:
   requires (!std::is_const_v<registry_type>)
   { m_registry->clear(m_identifier); }
 
+  constexpr
+  void
+  enable()
+  requires (!std::is_const_v<registry_type>)
+  { m_registry->enable(m_identifier); }
+
+  constexpr
+  void
+  disable()
+  requires (!std::is_const_v<registry_type>)
+  { m_registry->disable(m_identifier); }
+
   constexpr
   void
   destroy()
   requires (!std::is_const_v<registry_type>)
   { m_registry->destroy(m_identifier); }
+
+  template<typename Component>
+  requires (!std::is_const_v<registry_type>)
+  constexpr
+  void
+  expire_after(typename registry_type::tick_type const ticks)
+  { m_registry->template expire_after<Component>(m_identifier, ticks); }
+
+  constexpr
+  void
+  destroy_after(typename registry_type::tick_type const ticks)
+  requires (!std::is_const_v<registry_type>)
+  { m_registry->destroy_after(m_identifier, ticks); }
 };
 
 } // namespace heim
@@ -0,0 +1,329 @@
+#ifndef HEIM_ECS_EVENT_CHANNEL_HPP
+#define HEIM_ECS_EVENT_CHANNEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include "heim/lib/trace.hpp"
+#include "heim/lib/utility.hpp"
+
+namespace heim
+{
+/*!
+ * \brief
+ *   Determines the default number of events stored in each chunk of an event channel.
+ */
+template<typename = void>
+struct default_event_chunk_size
+  : std::integral_constant<std::size_t, 4096>
+{ };
+
+template<typename = void>
+inline constexpr
+std::size_t
+default_event_chunk_size_v
+= default_event_chunk_size<>::value;
+
+
+template<typename T>
+struct is_event
+  : std::bool_constant<
+         std ::is_object_v<T>
+     && !heim::is_qualified_v<T>
+     &&  std ::is_nothrow_destructible_v<T>>
+{ };
+
+template<typename T>
+inline constexpr
+bool
+is_event_v
+= is_event<T>::value;
+
+template<typename T>
+concept event
+= is_event_v<T>;
+
+
+/*!
+ * \brief
+ *   An append-only channel of transient events of the specializing type, fed by any number of
+ *   producer threads and drained by a single consumer.
+ *
+ * \details
+ *   Events are stored in a linked list of fixed-size chunks. Emitting an event reserves a slot with
+ *   a single atomic increment on the current chunk, and a producer overflowing the current chunk links
+ *   the next one with a compare-and-swap, hence producers never lock. \n
+ *   Draining hands each chunk to the consumer as a contiguous span of events. Clearing the channel
+ *   keeps its chunks for the next tick and only resets their cursors: it never touches trivially
+ *   destructible events, and its cost depends on the number of chunks used, not on the number of
+ *   events.
+ *
+ * \note
+ *   Emitting is thread-safe. Draining, clearing and iterating are not, and must happen-after every
+ *   emission they are meant to observe (e.g. after the producing threads were joined or reached a
+ *   barrier).
+ */
+template<
+    typename    Event,
+    std::size_t ChunkSize = default_event_chunk_size_v<>,
+    typename    Allocator = std::allocator<Event>>
+requires (
+    event        <Event>
+ && allocator_for<Allocator, Event>
+ && ChunkSize > 0)
+class event_channel
+{
+public:
+  using event_type     = Event;
+  using allocator_type = Allocator;
+
+  static constexpr std::size_t chunk_size
+  = ChunkSize;
+
+private:
+  struct chunk
+  {
+    std::atomic<std::size_t> cursor;
+    std::atomic<chunk *>     next;
+
+    alignas(event_type)
+    std::byte storage[chunk_size * sizeof(event_type)];
+
+    chunk()
+    noexcept
+      : cursor {0}
+      , next   {nullptr}
+    { }
+
+    [[nodiscard]]
+    event_type *
+    data()
+    noexcept
+    { return std::launder(reinterpret_cast<event_type *>(storage)); }
+
+    [[nodiscard]]
+    std::size_t
+    size() const
+    noexcept
+    { return std::min(cursor.load(std::memory_order_relaxed), chunk_size); }
+  };
+
+  using chunk_allocator    = typename std::allocator_traits<allocator_type>::template rebind_alloc <chunk>;
+  using chunk_alloc_traits = typename std::allocator_traits<allocator_type>::template rebind_traits<chunk>;
+
+private:
+  [[no_unique_address]]
+  chunk_allocator m_allocator;
+
+  chunk               *m_first;
+  std::atomic<chunk *> m_current;
+
+private:
+  [[nodiscard]]
+  chunk *
+  m_allocate()
+  {
+    auto *const ptr{std::to_address(chunk_alloc_traits::allocate(m_allocator, 1))};
+
+    chunk_alloc_traits::construct(m_allocator, ptr);
+    return ptr;
+  }
+
+  void
+  m_deallocate(chunk *const ptr)
+  noexcept
+  {
+    chunk_alloc_traits::destroy   (m_allocator, ptr);
+    chunk_alloc_traits::deallocate(m_allocator, ptr, 1);
+  }
+
+  [[nodiscard]]
+  chunk *
+  m_advance(chunk *curr)
+  {
+    chunk *next{curr->next.load(std::memory_order_acquire)};
+
+    if (next == nullptr)
+    {
+      chunk *const fresh{m_allocate()};
+
+      if (curr->next.compare_exchange_strong(next, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+        next = fresh;
+      else
+        m_deallocate(fresh);
+    }
+
+    // failing only means another producer already advanced the current chunk
+    m_current.compare_exchange_strong(curr, next, std::memory_order_acq_rel, std::memory_order_relaxed);
+    return next;
+  }
+
+  void
+  m_destroy_events()
+  noexcept
+  {
+    for (chunk *curr{m_first}; curr != nullptr; curr = curr->next.load(std::memory_order_relaxed))
+    {
+      std::size_t const size{curr->size()};
+
+      if (size == 0)
+        break;
+
+      if constexpr (!std::is_trivially_destructible_v<event_type>)
+        std::destroy_n(curr->data(), size);
+
+      curr->cursor.store(0, std::memory_order_relaxed);
+    }
+  }
+
+public:
+  explicit
+  event_channel(allocator_type const &alloc = allocator_type{})
+    : m_allocator{alloc}
+    , m_first    {m_allocate()}
+    , m_current  {m_first}
+  { }
+
+  event_channel(event_channel const &)
+  = delete;
+
+  event_channel(event_channel &&)
+  = delete;
+
+  ~event_channel()
+  {
+    m_destroy_events();
+
+    for (chunk *curr{m_first}; curr != nullptr; )
+    {
+      chunk *const next{curr->next.load(std::memory_order_relaxed)};
+
+      m_deallocate(curr);
+      curr = next;
+    }
+  }
+
+  event_channel &
+  operator=(event_channel const &)
+  = delete;
+
+  event_channel &
+  operator=(event_channel &&)
+  = delete;
+
+  [[nodiscard]]
+  allocator_type
+  get_allocator() const
+  noexcept
+  { return allocator_type{m_allocator}; }
+
+
+  /*!
+   * \brief
+   *   Constructs an event in place at the end of the channel.
+   *
+   * \note
+   *   Is safe to call concurrently from any number of threads.
+   */
+  template<typename ...Args>
+  requires std::is_nothrow_constructible_v<event_type, Args &&...>
+  event_type &
+  emit(Args &&...args)
+  {
+    chunk *curr{m_current.load(std::memory_order_acquire)};
+
+    for (;;)
+    {
+      if (std::size_t const idx{curr->cursor.fetch_add(1, std::memory_order_relaxed)};
+          idx < chunk_size)
+      {
+        return *std::construct_at(curr->data() + idx, std::forward<Args>(args)...);
+      }
+
+      curr = m_advance(curr);
+    }
+  }
+
+
+  [[nodiscard]]
+  std::size_t
+  size() const
+  noexcept
+  {
+    std::size_t size{};
+
+    for (chunk const *curr{m_first}; curr != nullptr; curr = curr->next.load(std::memory_order_relaxed))
+    {
+      std::size_t const count{curr->size()};
+
+      if (count == 0)
+        break;
+
+      size += count;
+    }
+    return size;
+  }
+
+  [[nodiscard]]
+  bool
+  empty() const
+  noexcept
+  { return m_first->size() == 0; }
+
+  /*!
+   * \brief
+   *   Invokes the specified function with each contiguous span of events, in chunk order.
+   */
+  template<typename F>
+  requires std::invocable<F &, std::span<event_type>>
+  void
+  for_each_span(F &&f)
+  {
+    for (chunk *curr{m_first}; curr != nullptr; curr = curr->next.load(std::memory_order_relaxed))
+    {
+      std::size_t const size{curr->size()};
+
+      if (size == 0)
+        break;
+
+      f(std::span<event_type>{curr->data(), size});
+    }
+  }
+
+  /*!
+   * \brief
+   *   Invokes the specified function with each contiguous span of events, then clears the channel.
+   */
+  template<typename F>
+  requires std::invocable<F &, std::span<event_type>>
+  void
+  drain(F &&f)
+  {
+    HEIM_TRACE_ZONE("heim::event_channel::drain");
+
+    for_each_span(f);
+    clear();
+  }
+
+  /*!
+   * \brief
+   *   Removes all the events of the channel, keeping its chunks for reuse.
+   */
+  void
+  clear()
+  noexcept
+  {
+    m_destroy_events();
+    m_current.store(m_first, std::memory_order_release);
+  }
+};
+
+} // namespace heim
+
+#endif // HEIM_ECS_EVENT_CHANNEL_HPP
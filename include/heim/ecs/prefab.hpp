@@ -0,0 +1,80 @@
+#ifndef HEIM_ECS_PREFAB_HPP
+#define HEIM_ECS_PREFAB_HPP
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "heim/lib/type_sequence.hpp"
+#include "heim/lib/utility.hpp"
+
+namespace heim
+{
+/*!
+ * \brief
+ *   A set of component values to instantiate entities from.
+ *
+ * \details
+ *   Instantiating a prefab into a registry creates all of its entities at once and appends a copy of
+ *   each of its components to each corresponding container in a single pass, instead of emplacing
+ *   each component of each entity separately.
+ */
+template<typename ...Components>
+requires (
+    (std::is_object_v<Components> && ...)
+ && !(heim::is_qualified_v<Components> || ...)
+ && type_sequence<Components ...>::is_unique)
+class prefab
+{
+public:
+  using component_sequence = type_sequence<Components ...>;
+
+private:
+  std::tuple<Components ...> m_components;
+
+public:
+  constexpr
+  prefab()
+  = default;
+
+  explicit constexpr
+  prefab(Components const &...cs)
+  requires (sizeof...(Components) > 0)
+    : m_components{cs...}
+  { }
+
+  explicit constexpr
+  prefab(Components &&...cs)
+  requires (sizeof...(Components) > 0)
+    : m_components{std::move(cs)...}
+  { }
+
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(prefab const &, prefab const &)
+  = default;
+
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]] constexpr
+  Component &
+  get()
+  noexcept
+  { return std::get<Component>(m_components); }
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]] constexpr
+  Component const &
+  get() const
+  noexcept
+  { return std::get<Component>(m_components); }
+};
+
+template<typename ...Components>
+prefab(Components ...)
+-> prefab<Components ...>;
+
+} // namespace heim
+
+#endif // HEIM_ECS_PREFAB_HPP
@@ -0,0 +1,414 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_COLUMNAR_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_COLUMNAR_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "heim/lib/trace.hpp"
+#include "heim/lib/type_sequence.hpp"
+
+namespace heim::sparse
+{
+/*!
+ * \brief
+ *   A member of a component type, exported as its own column by \c pool_columns .
+ */
+template<
+    typename Component,
+    typename Member>
+struct columnar_member
+{
+  char const        *name;
+  Member Component::*pointer;
+};
+
+
+/*!
+ * \brief
+ *   Describes the members of the specializing component type that \c pool_columns splits into
+ *   columns of their own.
+ *
+ * \details
+ *   Users opt in by specializing this type with a static constexpr tuple of \c columnar_member
+ *   named \c members , e.g. \c std::tuple{columnar_member{"x", &position::x}, ...} . The components
+ *   of other types are exported as a single column.
+ */
+template<typename T>
+struct columnar_layout
+{ };
+
+template<typename T>
+concept split_component
+= requires { std::tuple_size<std::remove_cvref_t<decltype(columnar_layout<T>::members)>>::value; };
+
+
+/*!
+ * \brief
+ *   A column of values of a single type, laid out as the data buffer of an Arrow array without
+ *   nulls.
+ *
+ * \details
+ *   The format is the one of the Arrow C data interface: a primitive format for arithmetic types
+ *   (e.g. \c "f" for \c float ), and a fixed-size binary format (e.g. \c "w:12" ) for other types.
+ */
+struct column
+{
+  std::string                name;
+  std::string                format;
+  std::size_t                length;
+  std::span<std::byte const> data;
+};
+
+
+namespace detail
+{
+template<typename T>
+[[nodiscard]] inline
+std::string
+arrow_format()
+{
+  if constexpr (std::is_floating_point_v<T> && sizeof(T) == 4)
+    return "f";
+  else if constexpr (std::is_floating_point_v<T> && sizeof(T) == 8)
+    return "g";
+  else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8)
+  {
+    constexpr std::array<char, 4> signed_formats  {'c', 's', 'i', 'l'};
+    constexpr std::array<char, 4> unsigned_formats{'C', 'S', 'I', 'L'};
+    constexpr std::size_t         idx{std::bit_width(sizeof(T)) - 1};
+
+    return std::string(1, std::is_signed_v<T> ? signed_formats[idx] : unsigned_formats[idx]);
+  }
+  else
+    return "w:" + std::to_string(sizeof(T));
+}
+
+// the type of the tuple of members of a component type, which is empty if it is not split
+template<typename T>
+struct columnar_members
+  : std::type_identity<std::tuple<>>
+{ };
+
+template<split_component T>
+struct columnar_members<T>
+  : std::type_identity<std::remove_cvref_t<decltype(columnar_layout<T>::members)>>
+{ };
+
+
+template<typename Members>
+struct columnar_buffers;
+
+template<
+    typename ...Components,
+    typename ...Members>
+struct columnar_buffers<std::tuple<columnar_member<Components, Members> ...>>
+  : std::type_identity<std::tuple<std::vector<Members> ...>>
+{ };
+
+
+inline constexpr std::uint64_t columnar_magic     = 0x314c4f434d494548; // "HEIMCOL1"
+inline constexpr std::size_t   columnar_alignment = 64;
+
+[[nodiscard]] constexpr
+std::uint64_t
+columnar_align(std::uint64_t const n)
+noexcept
+{ return (n + columnar_alignment - 1) / columnar_alignment * columnar_alignment; }
+
+// writes the specified columns to a file of the specified path, see registry_columns::write
+inline
+void
+write_columns(char const * const path, std::span<column const * const> const columns)
+{
+  std::uint64_t table_size{2 * sizeof(std::uint64_t)};
+  for (column const *col : columns)
+    table_size += 3 * sizeof(std::uint64_t) + 2 * sizeof(std::uint32_t) + col->name.size() + col->format.size();
+
+  std::FILE *const file{std::fopen(path, "wb")};
+
+  if (file == nullptr)
+    throw std::system_error{errno, std::generic_category(), "heim::sparse::write_columns: fopen"};
+
+  int           error {};
+  std::uint64_t offset{columnar_align(table_size)};
+
+  // keeps the error of the first failing write, read right after it as later calls may change errno
+  auto const write{[&](void const * const data, std::size_t const size)
+  {
+    if (error != 0 || size == 0)
+      return;
+
+    errno = 0;
+    if (std::fwrite(data, 1, size, file) != size)
+      error = errno != 0 ? errno : EIO;
+  }};
+
+  auto const write_u64{[&](std::uint64_t const value) { write(&value, sizeof(value)); }};
+  auto const write_u32{[&](std::uint32_t const value) { write(&value, sizeof(value)); }};
+
+  write_u64(columnar_magic);
+  write_u64(columns.size());
+  for (column const *col : columns)
+  {
+    write_u64(col->length);
+    write_u64(offset);
+    write_u64(col->data.size());
+    write_u32(static_cast<std::uint32_t>(col->name.size()));
+    write_u32(static_cast<std::uint32_t>(col->format.size()));
+    write(col->name.data()  , col->name.size());
+    write(col->format.data(), col->format.size());
+
+    offset += columnar_align(col->data.size());
+  }
+
+  constexpr std::array<std::byte, columnar_alignment> padding{};
+
+  write(padding.data(), columnar_align(table_size) - table_size);
+  for (column const *col : columns)
+  {
+    write(col->data.data(), col->data.size());
+    write(padding.data()  , columnar_align(col->data.size()) - col->data.size());
+  }
+
+  errno = 0;
+  if (std::fclose(file) != 0 && error == 0)
+    error = errno != 0 ? errno : EIO;
+
+  if (error != 0)
+    throw std::system_error{error, std::generic_category(), "heim::sparse::write_columns: fwrite"};
+}
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   The columns of a pool, that is a column of its identifiers and the columns of its components.
+ *
+ * \details
+ *   The column of identifiers and the column of components which are not split (see
+ *   \c columnar_layout ) are views of the dense arrays of the pool, which are not copied. The
+ *   components which are split are copied member by member into buffers owned by the columns, which
+ *   are reused by later updates. \n
+ *   The columns are named after the name given to the constructor, with an \c ".id" suffix for the
+ *   identifiers and the names of the members as suffixes for split components. Their values follow
+ *   the dense order of the pool, hence the first ones are those of its disabled identifiers.
+ *
+ * \note
+ *   The columns are only valid until the pool is modified, or until the next update.
+ */
+template<typename Pool>
+class pool_columns
+{
+public:
+  using pool_type       = Pool;
+  using component_type  = typename pool_type::component_type;
+  using identifier_type = typename pool_type::identifier_type;
+
+private:
+  static constexpr bool s_has_components
+  = !std::is_empty_v<component_type>;
+
+  static constexpr bool s_is_split
+  = split_component<component_type>;
+
+  static_assert(
+      std::is_trivially_copyable_v<component_type>,
+      "heim::sparse::pool_columns: std::is_trivially_copyable_v<component_type>;");
+
+  using members_type = typename detail::columnar_members<component_type>::type;
+
+  using buffer_tuple = typename detail::columnar_buffers<members_type>::type;
+
+  static constexpr std::size_t s_column_count
+  = 1 + (s_is_split ? std::tuple_size_v<members_type> : s_has_components);
+
+private:
+  std::array<column, s_column_count> m_columns;
+  buffer_tuple                       m_buffers;
+  std::size_t                        m_enabled_size;
+
+public:
+  explicit
+  pool_columns(std::string const &name)
+    : m_columns     {}
+    , m_buffers     {}
+    , m_enabled_size{}
+  {
+    m_columns[0].name   = name + ".id";
+    m_columns[0].format = detail::arrow_format<identifier_type>();
+
+    if constexpr (s_is_split)
+    {
+      [&]<std::size_t ...Is>(std::index_sequence<Is ...>)
+      {
+        ((m_columns[1 + Is].name   = name + "." + std::get<Is>(columnar_layout<component_type>::members).name,
+          m_columns[1 + Is].format = detail::arrow_format<typename std::tuple_element_t<Is, buffer_tuple>::value_type>()), ...);
+      }(std::make_index_sequence<std::tuple_size_v<members_type>>{});
+    }
+    else if constexpr (s_has_components)
+    {
+      m_columns[1].name   = name;
+      m_columns[1].format = detail::arrow_format<component_type>();
+    }
+  }
+
+
+  [[nodiscard]]
+  std::span<column const>
+  columns() const
+  noexcept
+  { return m_columns; }
+
+  /*!
+   * \brief
+   *   Returns the number of enabled identifiers of the pool at the last update, which are the last
+   *   values of the columns.
+   */
+  [[nodiscard]]
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return m_enabled_size; }
+
+
+  /*!
+   * \brief
+   *   Points the columns to the dense arrays of the specified pool, copying the members of its
+   *   components if they are split.
+   */
+  void
+  update(pool_type const &pool)
+  {
+    HEIM_TRACE_ZONE("heim::pool_columns::update");
+
+    auto const ids{pool.identifiers()};
+
+    for (column &col : m_columns)
+      col.length = ids.size();
+
+    m_columns[0].data = std::as_bytes(std::span<identifier_type const>{ids.data(), ids.size()});
+    m_enabled_size    = pool.enabled_size();
+
+    if constexpr (s_is_split)
+    {
+      auto const comps{pool.components()};
+
+      [&]<std::size_t ...Is>(std::index_sequence<Is ...>)
+      {
+        (([&]
+        {
+          auto       &buffer {std::get<Is>(m_buffers)};
+          auto const  pointer{std::get<Is>(columnar_layout<component_type>::members).pointer};
+
+          buffer.resize(comps.size());
+          for (std::size_t i{}; i < comps.size(); ++i)
+            buffer[i] = comps[i].*pointer;
+
+          m_columns[1 + Is].data = std::as_bytes(std::span{buffer});
+        }()), ...);
+      }(std::make_index_sequence<std::tuple_size_v<members_type>>{});
+    }
+    else if constexpr (s_has_components)
+    {
+      auto const comps{pool.components()};
+      m_columns[1].data = std::as_bytes(std::span<component_type const>{comps.data(), comps.size()});
+    }
+  }
+};
+
+
+/*!
+ * \brief
+ *   The columns of the pools of the specializing component types of a registry.
+ *
+ * \details
+ *   See \c pool_columns . The columns of each pool are named after its component type as given to
+ *   the constructor, in the order of the specializing component types.
+ */
+template<
+    typename    Registry,
+    typename ...Components>
+requires (
+    sizeof...(Components) > 0
+ && type_sequence<Components ...>::is_unique)
+class registry_columns
+{
+public:
+  using registry_type = Registry;
+
+  template<typename Component>
+  using columns_for
+  = pool_columns<typename registry_type::template container_for<Component>>;
+
+private:
+  using component_sequence = type_sequence<Components ...>;
+
+private:
+  std::tuple<columns_for<Components> ...> m_columns;
+
+public:
+  explicit
+  registry_columns(std::array<std::string, sizeof...(Components)> const &names)
+    : m_columns{[&]<std::size_t ...Is>(std::index_sequence<Is ...>)
+      {
+        return std::tuple<columns_for<Components> ...>{columns_for<Components>{names[Is]} ...};
+      }(std::index_sequence_for<Components ...>{})}
+  { }
+
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]]
+  columns_for<Component> const &
+  get() const
+  noexcept
+  { return std::get<component_sequence::template index<Component>>(m_columns); }
+
+  void
+  update(registry_type const &registry)
+  { (std::get<columns_for<Components>>(m_columns).update(registry.template container<Components>()), ...); }
+
+  /*!
+   * \brief
+   *   Writes the columns to a file of the specified path, replacing it.
+   *
+   * \details
+   *   The file starts with a table describing each column (its length, the offset and size of its
+   *   data, its name and its format), followed by the data of the columns, each aligned and padded
+   *   to 64 bytes as Arrow buffers are, so that a mapping of the file can be read as Arrow arrays
+   *   without copying. \n
+   *   Throws \c std::system_error if the file cannot be written.
+   */
+  void
+  write(char const * const path) const
+  {
+    HEIM_TRACE_ZONE("heim::registry_columns::write");
+
+    std::vector<column const *> columns;
+
+    std::apply([&](auto const &...pools)
+    {
+      ((std::ranges::for_each(pools.columns(), [&](column const &col) { columns.push_back(&col); })), ...);
+    }, m_columns);
+
+    detail::write_columns(path, columns);
+  }
+};
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_COLUMNAR_HPP
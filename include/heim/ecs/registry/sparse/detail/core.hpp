@@ -1,14 +1,19 @@
 #ifndef HEIM_ECS_REGISTRY_SPARSE_DETAIL_CORE_HPP
 #define HEIM_ECS_REGISTRY_SPARSE_DETAIL_CORE_HPP
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <memory>
 #include <ranges>
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include "heim/ecs/identifier.hpp"
+#include "heim/lib/hash.hpp"
 #include "heim/lib/utility.hpp"
 
 namespace heim::sparse::detail
@@ -40,6 +45,8 @@ private:
   container_type m_dense;
   container_type m_sparse;
   std::size_t    m_begin;
+  std::size_t    m_enabled;
+  std::uint64_t  m_structure;
 
 private:
   static constexpr
@@ -58,19 +65,63 @@ private:
   noexcept
   { return std::is_nothrow_swappable_v<container_type>; }
 
+  [[nodiscard]] constexpr
+  std::size_t
+  m_position(identifier_type const id) const
+  noexcept
+  { return static_cast<std::size_t>(id_traits::index(m_sparse[static_cast<std::size_t>(id_traits::index(id))])); }
+
+  constexpr
+  void
+  m_swap(std::size_t const lhs, std::size_t const rhs)
+  noexcept
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+
+    if (lhs == rhs)
+      return;
+
+    std::swap(m_dense[lhs], m_dense[rhs]);
+
+    for (std::size_t const pos : {lhs, rhs})
+    {
+      identifier_type const id{m_dense[pos]};
+      m_sparse[static_cast<std::size_t>(id_traits::index(id))] = id_traits::from(static_cast<index_type>(pos), id_traits::generation(id));
+    }
+  }
+
+  // swaps the specified number of recycled identifiers at the end of the dead partition with the
+  // last disabled ones, which is its own inverse
+  constexpr
+  void
+  m_swap_recycled(std::size_t const n)
+  noexcept
+  {
+    std::size_t const count{std::min(n, m_enabled - m_begin)};
+
+    for (std::size_t i{}; i < count; ++i)
+      m_swap(m_begin - n + i, m_enabled - count + i);
+  }
+
 public:
   explicit constexpr
   registry_core(allocator_type const &alloc)
-    : m_dense {alloc}
-    , m_sparse{alloc}
-    , m_begin {}
+    : m_dense    {alloc}
+    , m_sparse   {alloc}
+    , m_begin    {}
+    , m_enabled  {}
+    , m_structure{}
   { }
 
   constexpr
   registry_core(registry_core const &other, allocator_type const &alloc)
-    : m_dense {other.m_dense , alloc}
-    , m_sparse{other.m_sparse, alloc}
-    , m_begin {other.m_begin}
+    : m_dense    {other.m_dense , alloc}
+    , m_sparse   {other.m_sparse, alloc}
+    , m_begin    {other.m_begin}
+    , m_enabled  {other.m_enabled}
+    , m_structure{other.m_structure}
   { }
 
   constexpr
@@ -80,9 +131,11 @@ public:
   constexpr
   registry_core(registry_core &&other, allocator_type const &alloc)
   noexcept(s_noexcept_move_alloc_construct())
-    : m_dense {std::move(other.m_dense ), alloc}
-    , m_sparse{std::move(other.m_sparse), alloc}
-    , m_begin {other.m_begin}
+    : m_dense    {std::move(other.m_dense ), alloc}
+    , m_sparse   {std::move(other.m_sparse), alloc}
+    , m_begin    {other.m_begin}
+    , m_enabled  {other.m_enabled}
+    , m_structure{other.m_structure}
   { }
 
   constexpr
@@ -108,15 +161,24 @@ public:
   swap(registry_core &other)
   noexcept(s_noexcept_swap())
   {
-    std::swap(m_dense , other.m_dense);
-    std::swap(m_sparse, other.m_sparse);
-    std::swap(m_begin , other.m_begin);
+    std::swap(m_dense    , other.m_dense);
+    std::swap(m_sparse   , other.m_sparse);
+    std::swap(m_begin    , other.m_begin);
+    std::swap(m_enabled  , other.m_enabled);
+    std::swap(m_structure, other.m_structure);
   }
 
+  // the structural versions are not part of the state of the cores
   [[nodiscard]] friend constexpr
   bool
-  operator==(registry_core const &, registry_core const &)
-  = default;
+  operator==(registry_core const &lhs, registry_core const &rhs)
+  noexcept
+  {
+    return lhs.m_dense   == rhs.m_dense
+        && lhs.m_sparse  == rhs.m_sparse
+        && lhs.m_begin   == rhs.m_begin
+        && lhs.m_enabled == rhs.m_enabled;
+  }
 
   [[nodiscard]] constexpr
   allocator_type
@@ -161,12 +223,63 @@ public:
   noexcept
   { return std::make_reverse_iterator(m_dense.cbegin() + static_cast<std::ptrdiff_t>(m_begin)); }
 
+  /*!
+   * \brief
+   *   Returns the end of the range of enabled identifiers, which starts at \c begin() and precedes the
+   *   range of disabled identifiers.
+   */
+  [[nodiscard]] constexpr
+  const_iterator
+  enabled_end() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.cbegin() + static_cast<std::ptrdiff_t>(m_enabled)); }
+
   [[nodiscard]] constexpr
   std::size_t
   size() const
   noexcept
   { return m_dense.size() - m_begin; }
 
+  /*!
+   * \brief
+   *   Returns the number of identifiers that can be created without allocating, including the
+   *   identifiers already created.
+   */
+  [[nodiscard]] constexpr
+  std::size_t
+  capacity() const
+  noexcept
+  { return std::min(m_dense.capacity(), m_sparse.capacity()); }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return m_dense.size() - m_enabled; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  disabled_size() const
+  noexcept
+  { return m_enabled - m_begin; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  destroyed_size() const
+  noexcept
+  { return m_begin; }
+
+  /*!
+   * \brief
+   *   Returns the dense array of identifiers, which holds the destroyed identifiers (with the
+   *   generation of their next creation), then the disabled ones, then the enabled ones.
+   */
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return std::span<identifier_type const>{m_dense.data(), m_dense.size()}; }
+
   [[nodiscard]] constexpr
   bool
   empty() const
@@ -190,6 +303,46 @@ public:
         || id_traits::generation(pos) != id_traits::generation(id);
   }
 
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return m_position(id) >= m_enabled; }
+
+  /*!
+   * \brief
+   *   Returns the version of the order of the identifiers, which changes on every creation,
+   *   destruction, enabling or disabling of identifiers.
+   */
+  [[nodiscard]] constexpr
+  std::uint64_t
+  structural_version() const
+  noexcept
+  { return m_structure; }
+
+
+  // a digest of the alive identifiers and of whether they are enabled, which does not depend on their
+  // order
+  [[nodiscard]] constexpr
+  std::uint64_t
+  hash() const
+  noexcept
+  {
+    std::uint64_t hash{};
+
+    for (std::size_t pos{m_begin}; pos < m_dense.size(); ++pos)
+      hash += hash_mix(static_cast<std::uint64_t>(m_dense[pos]) ^ (pos < m_enabled ? 0x9e3779b97f4a7c15 : 0));
+    return hash;
+  }
+
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    m_dense .reserve(n);
+    m_sparse.reserve(n);
+  }
+
 
   [[nodiscard]] constexpr
   identifier_type
@@ -200,7 +353,12 @@ public:
 
 
     if (m_begin != 0)
-      return m_dense[--m_begin];
+    {
+      m_swap_recycled(1);
+      --m_begin;
+      ++m_structure;
+      return m_dense[--m_enabled];
+    }
 
     identifier_type const id{id_traits::from(static_cast<index_type>(m_dense.size()), 0)};
 
@@ -211,9 +369,71 @@ public:
     catch (...)
     { m_dense.pop_back(); throw; }
 
+    ++m_structure;
     return id;
   }
 
+  /*!
+   * \brief
+   *   Creates the specified number of identifiers at once, and returns them as the two contiguous
+   *   ranges of recycled and new identifiers.
+   *
+   * \details
+   *   The returned ranges stay valid until the next modification of the core. Either all or none of
+   *   the identifiers are created.
+   */
+  [[nodiscard]] constexpr
+  std::array<std::span<identifier_type const>, 2>
+  create(std::size_t const n)
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+
+    std::size_t const recycled{std::min(n, m_begin)};
+    std::size_t const first   {m_dense.size()};
+
+    if (n != recycled)
+    {
+      m_dense .reserve(first + (n - recycled));
+      m_sparse.reserve(first + (n - recycled));
+
+      for (std::size_t idx{first}; idx < first + (n - recycled); ++idx)
+      {
+        identifier_type const id{id_traits::from(static_cast<index_type>(idx), 0)};
+
+        m_dense .emplace_back(id);
+        m_sparse.emplace_back(id);
+      }
+    }
+
+    m_swap_recycled(recycled);
+    m_begin   -= recycled;
+    m_enabled -= recycled;
+    ++m_structure;
+    return {
+        std::span<identifier_type const>{m_dense.data() + m_enabled, recycled},
+        std::span<identifier_type const>{m_dense.data() + first  , n - recycled}};
+  }
+
+  /*!
+   * \brief
+   *   Reverts the creation of the specified identifiers, which must be the result of the last
+   *   modification of the core.
+   */
+  constexpr
+  void
+  revert_create(std::array<std::span<identifier_type const>, 2> const &created)
+  noexcept
+  {
+    m_dense .resize(m_dense .size() - created[1].size());
+    m_sparse.resize(m_sparse.size() - created[1].size());
+    m_begin   += created[0].size();
+    m_enabled += created[0].size();
+    m_swap_recycled(created[0].size());
+    ++m_structure;
+  }
+
   constexpr
   void
   destroy(identifier_type const id)
@@ -223,22 +443,89 @@ public:
     = typename id_traits::index_type;
 
 
-    identifier_type &pos    {m_sparse[static_cast<std::size_t>(id_traits::index(id))]};
-    auto const       pos_idx{id_traits::index(pos)};
+    disable(id);
+    m_swap(m_position(id), m_begin);
 
     identifier_type &dense_begin{m_dense[m_begin]};
-    identifier_type &dense_id   {m_dense[static_cast<std::size_t>(pos_idx)]};
-    auto const       begin_idx  {static_cast<std::size_t>(id_traits::index(dense_begin))};
-    auto const       begin      {static_cast<index_type>(m_begin)};
-
-    std::swap(dense_begin, dense_id);
-
-    if (pos_idx != begin)
-      m_sparse[begin_idx] = id_traits::from(pos_idx, id_traits::generation(dense_id));
 
     dense_begin = id_traits::next(dense_begin);
-    pos         = id_traits::from(begin, id_traits::generation(dense_begin));
+    m_sparse[static_cast<std::size_t>(id_traits::index(id))] = id_traits::from(static_cast<index_type>(m_begin), id_traits::generation(dense_begin));
     ++m_begin;
+    ++m_structure;
+  }
+
+  /*!
+   * \brief
+   *   Moves the specified identifier to the range of enabled identifiers.
+   */
+  constexpr
+  void
+  enable(identifier_type const id)
+  noexcept
+  {
+    if (enabled(id))
+      return;
+
+    m_swap(m_position(id), --m_enabled);
+    ++m_structure;
+  }
+
+  /*!
+   * \brief
+   *   Moves the specified identifier to the range of disabled identifiers.
+   */
+  constexpr
+  void
+  disable(identifier_type const id)
+  noexcept
+  {
+    if (!enabled(id))
+      return;
+
+    m_swap(m_position(id), m_enabled++);
+    ++m_structure;
+  }
+
+  /*!
+   * \brief
+   *   Replaces the identifiers with the specified dense array, as returned by \c identifiers , whose
+   *   specified numbers of first identifiers are destroyed and disabled, and returns whether it was
+   *   valid, the core being left unchanged otherwise.
+   *
+   * \details
+   *   The array is valid if its identifiers have distinct indices, all lower than its size.
+   */
+  constexpr
+  bool
+  assign(std::span<identifier_type const> const ids, std::size_t const destroyed, std::size_t const disabled)
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+
+    if (destroyed > ids.size() || disabled > ids.size() - destroyed)
+      return false;
+
+    // positions equal to the size denote the indices not seen yet
+    container_type dense {ids.begin(), ids.end(), m_dense.get_allocator()};
+    container_type sparse(ids.size(), id_traits::from(static_cast<index_type>(ids.size()), 0), m_sparse.get_allocator());
+
+    for (std::size_t pos{}; pos < dense.size(); ++pos)
+    {
+      auto const idx{static_cast<std::size_t>(id_traits::index(dense[pos]))};
+
+      if (idx >= sparse.size() || static_cast<std::size_t>(id_traits::index(sparse[idx])) != sparse.size())
+        return false;
+
+      sparse[idx] = id_traits::from(static_cast<index_type>(pos), id_traits::generation(dense[pos]));
+    }
+
+    m_dense   = std::move(dense);
+    m_sparse  = std::move(sparse);
+    m_begin   = destroyed;
+    m_enabled = destroyed + disabled;
+    ++m_structure;
+    return true;
   }
 
   constexpr
@@ -257,7 +544,9 @@ public:
       pos = id_traits::next(pos);
     }
 
-    m_begin = m_dense.size();
+    m_begin   = m_dense.size();
+    m_enabled = m_dense.size();
+    ++m_structure;
   }
 };
 
@@ -0,0 +1,308 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_DETAIL_FIXED_CORE_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_DETAIL_FIXED_CORE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include "heim/ecs/identifier.hpp"
+
+namespace heim::sparse::detail
+{
+/*!
+ * \brief
+ *   The identifiers of a fixed registry, stored in inline arrays of the specified capacity.
+ *
+ * \details
+ *   Behaves as \c registry_core , of which it keeps the layout of the dense array (the dead
+ *   identifiers, then the disabled ones, then the enabled ones), the sparse array being indexed
+ *   directly by the indexes of the identifiers.
+ */
+template<
+    typename    Identifier,
+    std::size_t Capacity>
+requires identifier<Identifier>
+class fixed_registry_core
+{
+public:
+  using identifier_type = Identifier;
+
+private:
+  using id_traits = identifier_traits<identifier_type>;
+
+  static_assert(
+      Capacity <= static_cast<std::size_t>(id_traits::index_mask),
+      "heim::sparse::detail::fixed_registry_core: Capacity <= id_traits::index_mask;");
+
+  using container_type
+  = std::array<identifier_type, Capacity>;
+
+public:
+  using iterator       = std::reverse_iterator<identifier_type const *>;
+  using const_iterator = std::reverse_iterator<identifier_type const *>;
+
+private:
+  container_type m_dense;
+  container_type m_sparse;
+  std::size_t    m_size;
+  std::size_t    m_begin;
+  std::size_t    m_enabled;
+  std::uint64_t  m_structure;
+
+private:
+  [[nodiscard]] constexpr
+  std::size_t
+  m_position(identifier_type const id) const
+  noexcept
+  { return static_cast<std::size_t>(id_traits::index(m_sparse[static_cast<std::size_t>(id_traits::index(id))])); }
+
+  constexpr
+  void
+  m_swap(std::size_t const lhs, std::size_t const rhs)
+  noexcept
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+
+    if (lhs == rhs)
+      return;
+
+    std::swap(m_dense[lhs], m_dense[rhs]);
+
+    for (std::size_t const pos : {lhs, rhs})
+    {
+      identifier_type const id{m_dense[pos]};
+      m_sparse[static_cast<std::size_t>(id_traits::index(id))] = id_traits::from(static_cast<index_type>(pos), id_traits::generation(id));
+    }
+  }
+
+public:
+  constexpr
+  fixed_registry_core()
+  noexcept
+    : m_dense    {}
+    , m_sparse   {}
+    , m_size     {}
+    , m_begin    {}
+    , m_enabled  {}
+    , m_structure{}
+  { }
+
+  constexpr
+  fixed_registry_core(fixed_registry_core const &)
+  = default;
+
+  constexpr
+  fixed_registry_core(fixed_registry_core &&)
+  = default;
+
+  constexpr
+  ~fixed_registry_core()
+  = default;
+
+  constexpr
+  fixed_registry_core &
+  operator=(fixed_registry_core const &)
+  = default;
+
+  constexpr
+  fixed_registry_core &
+  operator=(fixed_registry_core &&)
+  = default;
+
+
+  [[nodiscard]] constexpr
+  const_iterator
+  begin() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.data() + m_size); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  end() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.data() + m_begin); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  cbegin() const
+  noexcept
+  { return begin(); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  cend() const
+  noexcept
+  { return end(); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  enabled_end() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.data() + m_enabled); }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  size() const
+  noexcept
+  { return m_size - m_begin; }
+
+  [[nodiscard]] static constexpr
+  std::size_t
+  capacity()
+  noexcept
+  { return Capacity; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return m_size - m_enabled; }
+
+  [[nodiscard]] constexpr
+  bool
+  empty() const
+  noexcept
+  { return size() == 0; }
+
+  [[nodiscard]] constexpr
+  bool
+  full() const
+  noexcept
+  { return size() == Capacity; }
+
+
+  [[nodiscard]] constexpr
+  bool
+  expired(identifier_type const id) const
+  noexcept
+  {
+    auto const idx{static_cast<std::size_t>(id_traits::index(id))};
+
+    if (idx >= m_size)
+      return true;
+
+    identifier_type const pos{m_sparse[idx]};
+
+    return id_traits::index     (pos) < m_begin
+        || id_traits::generation(pos) != id_traits::generation(id);
+  }
+
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return m_position(id) >= m_enabled; }
+
+  [[nodiscard]] constexpr
+  std::uint64_t
+  structural_version() const
+  noexcept
+  { return m_structure; }
+
+
+  /*!
+   * \brief
+   *   Creates an identifier, recycling a dead one if any, and returns it, or returns the null
+   *   identifier if the core is full.
+   */
+  [[nodiscard]] constexpr
+  identifier_type
+  create()
+  noexcept
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+
+    if (m_begin != 0)
+    {
+      // moves the last dead identifier to the front of the disabled ones, then enables it
+      m_swap(m_begin - 1, m_enabled - 1);
+      --m_begin;
+      ++m_structure;
+      return m_dense[--m_enabled];
+    }
+
+    if (m_size == Capacity)
+      return id_traits::null;
+
+    identifier_type const id{id_traits::from(static_cast<index_type>(m_size), 0)};
+
+    m_dense [m_size] = id;
+    m_sparse[m_size] = id;
+    ++m_size;
+    ++m_structure;
+    return id;
+  }
+
+  constexpr
+  void
+  destroy(identifier_type const id)
+  noexcept
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+
+    disable(id);
+    m_swap(m_position(id), m_begin);
+
+    identifier_type &dense_begin{m_dense[m_begin]};
+
+    dense_begin = id_traits::next(dense_begin);
+    m_sparse[static_cast<std::size_t>(id_traits::index(id))] = id_traits::from(static_cast<index_type>(m_begin), id_traits::generation(dense_begin));
+    ++m_begin;
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  enable(identifier_type const id)
+  noexcept
+  {
+    if (enabled(id))
+      return;
+
+    m_swap(m_position(id), --m_enabled);
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  disable(identifier_type const id)
+  noexcept
+  {
+    if (!enabled(id))
+      return;
+
+    m_swap(m_position(id), m_enabled++);
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  clear()
+  noexcept
+  {
+    for (std::size_t pos{m_begin}; pos < m_size; ++pos)
+    {
+      identifier_type &id {m_dense[pos]};
+      identifier_type &idx{m_sparse[static_cast<std::size_t>(id_traits::index(id))]};
+
+      id  = id_traits::next(id);
+      idx = id_traits::next(idx);
+    }
+
+    m_begin   = m_size;
+    m_enabled = m_size;
+    ++m_structure;
+  }
+};
+
+} // namespace heim::sparse::detail
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_DETAIL_FIXED_CORE_HPP
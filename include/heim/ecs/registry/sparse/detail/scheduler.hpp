@@ -0,0 +1,290 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_DETAIL_SCHEDULER_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_DETAIL_SCHEDULER_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "heim/ecs/identifier.hpp"
+#include "heim/lib/utility.hpp"
+
+namespace heim::sparse::detail
+{
+/*!
+ * \brief
+ *   A hierarchical timing wheel of deferred actions on identifiers, keyed by tick.
+ *
+ * \details
+ *   The wheel has a fixed number of levels of 64 slots each, level \c l covering ticks in steps of
+ *   \c 64^l . An action is stored in the slot of the level of the highest bit in which its due tick
+ *   differs from the current tick, and is cascaded to a lower level when the current tick reaches its
+ *   slot. Actions further away than the range of the wheel wait in an overflow container which is
+ *   redistributed each time the whole wheel wraps. \n
+ *   Scheduling and advancing are therefore constant-time per action, regardless of the number of
+ *   pending actions.
+ */
+template<
+    typename Identifier = default_identifier_t<>,
+    typename Allocator  = std::allocator<Identifier>>
+requires (
+    identifier   <Identifier>
+ && allocator_for<Allocator, Identifier>)
+class registry_scheduler
+{
+public:
+  using identifier_type = Identifier;
+  using allocator_type  = Allocator;
+  using tick_type       = std::uint64_t;
+
+  struct entry
+  {
+    identifier_type id;
+    std::uint32_t   action;
+    tick_type       due;
+
+    [[nodiscard]] friend constexpr
+    bool
+    operator==(entry const &, entry const &)
+    = default;
+  };
+
+private:
+  static constexpr int         s_slot_digits = 6;
+  static constexpr std::size_t s_slot_count  = std::size_t{1} << s_slot_digits;
+  static constexpr std::size_t s_level_count = 4;
+
+  using alloc_traits = std::allocator_traits<allocator_type>;
+
+  using entry_allocator = typename alloc_traits::template rebind_alloc<entry>;
+  using entry_container = std::vector<entry, entry_allocator>;
+
+  using slot_allocator = typename alloc_traits::template rebind_alloc<entry_container>;
+  using slot_container = std::vector<entry_container, slot_allocator>;
+
+private:
+  slot_container  m_slots;
+  entry_container m_overflow;
+  entry_container m_due;
+  tick_type       m_tick;
+
+private:
+  static constexpr
+  tick_type
+  s_level_mask(std::size_t const level)
+  noexcept
+  { return (tick_type{1} << (s_slot_digits * level)) - 1; }
+
+  constexpr
+  void
+  m_initialize()
+  {
+    if (!m_slots.empty())
+      return;
+
+    m_slots.reserve(s_slot_count * s_level_count);
+    for (std::size_t i{}; i < s_slot_count * s_level_count; ++i)
+      m_slots.emplace_back(entry_allocator{m_overflow.get_allocator()});
+  }
+
+  constexpr
+  void
+  m_insert(entry const &e)
+  {
+    auto const diff {e.due ^ m_tick};
+    auto const level{diff == 0 ? 0 : static_cast<std::size_t>((std::bit_width(diff) - 1) / s_slot_digits)};
+
+    if (level >= s_level_count)
+    {
+      m_overflow.emplace_back(e);
+      return;
+    }
+
+    auto const slot{static_cast<std::size_t>((e.due >> (s_slot_digits * level)) & (s_slot_count - 1))};
+    m_slots[level * s_slot_count + slot].emplace_back(e);
+  }
+
+  constexpr
+  void
+  m_redistribute(entry_container &entries)
+  {
+    // the due container is empty while cascading, and lends its capacity to the redistributed slot
+    m_due.swap(entries);
+
+    for (entry const &e : m_due)
+      m_insert(e);
+
+    m_due.clear();
+  }
+
+  constexpr
+  void
+  m_cascade()
+  {
+    for (std::size_t level{1}; level < s_level_count; ++level)
+    {
+      if ((m_tick & s_level_mask(level)) != 0)
+        return;
+
+      auto const slot{static_cast<std::size_t>((m_tick >> (s_slot_digits * level)) & (s_slot_count - 1))};
+      m_redistribute(m_slots[level * s_slot_count + slot]);
+    }
+
+    if ((m_tick & s_level_mask(s_level_count)) == 0)
+      m_redistribute(m_overflow);
+  }
+
+  static constexpr
+  bool
+  s_noexcept_move_alloc_construct()
+  noexcept
+  {
+    return std::is_nothrow_constructible_v<
+        entry_container,
+        entry_container &&, entry_allocator const &>;
+  }
+
+  static constexpr
+  bool
+  s_noexcept_swap()
+  noexcept
+  { return std::is_nothrow_swappable_v<entry_container>; }
+
+public:
+  explicit constexpr
+  registry_scheduler(allocator_type const &alloc)
+  noexcept
+    : m_slots   {slot_allocator {alloc}}
+    , m_overflow{entry_allocator{alloc}}
+    , m_due     {entry_allocator{alloc}}
+    , m_tick    {}
+  { }
+
+  constexpr
+  registry_scheduler(registry_scheduler const &other, allocator_type const &alloc)
+    : m_slots   {slot_allocator {alloc}}
+    , m_overflow{other.m_overflow, entry_allocator{alloc}}
+    , m_due     {entry_allocator{alloc}}
+    , m_tick    {other.m_tick}
+  {
+    if (other.m_slots.empty())
+      return;
+
+    m_slots.reserve(other.m_slots.size());
+    for (entry_container const &slot : other.m_slots)
+      m_slots.emplace_back(slot, entry_allocator{alloc});
+  }
+
+  constexpr
+  registry_scheduler(registry_scheduler const &)
+  = default;
+
+  constexpr
+  registry_scheduler(registry_scheduler &&other, allocator_type const &alloc)
+  noexcept(s_noexcept_move_alloc_construct())
+    : m_slots   {std::move(other.m_slots)   , slot_allocator {alloc}}
+    , m_overflow{std::move(other.m_overflow), entry_allocator{alloc}}
+    , m_due     {entry_allocator{alloc}}
+    , m_tick    {other.m_tick}
+  { }
+
+  constexpr
+  registry_scheduler(registry_scheduler &&)
+  = default;
+
+  constexpr
+  ~registry_scheduler()
+  = default;
+
+  constexpr
+  registry_scheduler &
+  operator=(registry_scheduler const &)
+  = default;
+
+  constexpr
+  registry_scheduler &
+  operator=(registry_scheduler &&)
+  = default;
+
+  constexpr
+  void
+  swap(registry_scheduler &other)
+  noexcept(s_noexcept_swap())
+  {
+    using std::swap;
+
+    m_slots   .swap(other.m_slots);
+    m_overflow.swap(other.m_overflow);
+    m_due     .swap(other.m_due);
+    swap(m_tick, other.m_tick);
+  }
+
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(registry_scheduler const &lhs, registry_scheduler const &rhs)
+  noexcept
+  {
+    return lhs.m_tick     == rhs.m_tick
+        && lhs.m_slots    == rhs.m_slots
+        && lhs.m_overflow == rhs.m_overflow;
+  }
+
+
+  [[nodiscard]] constexpr
+  tick_type
+  current_tick() const
+  noexcept
+  { return m_tick; }
+
+  /*!
+   * \brief
+   *   Schedules the specified action on the specified identifier for when the specified number of
+   *   ticks will have elapsed. A number of ticks of zero is treated as one.
+   */
+  constexpr
+  void
+  schedule(identifier_type const id, std::uint32_t const action, tick_type const ticks)
+  {
+    m_initialize();
+    m_insert(entry{id, action, m_tick + std::max(ticks, tick_type{1})});
+  }
+
+  /*!
+   * \brief
+   *   Advances the wheel by one tick and returns the actions that became due, which stay valid until
+   *   the next call.
+   */
+  [[nodiscard]] constexpr
+  entry_container &
+  advance()
+  {
+    ++m_tick;
+    m_due.clear();
+
+    if (m_slots.empty())
+      return m_due;
+
+    m_cascade();
+    m_due.swap(m_slots[static_cast<std::size_t>(m_tick & (s_slot_count - 1))]);
+    return m_due;
+  }
+
+  constexpr
+  void
+  clear()
+  noexcept
+  {
+    for (entry_container &slot : m_slots)
+      slot.clear();
+
+    m_overflow.clear();
+    m_due     .clear();
+  }
+};
+
+} // namespace heim::sparse::detail
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_DETAIL_SCHEDULER_HPP
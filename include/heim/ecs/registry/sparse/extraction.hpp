@@ -0,0 +1,514 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_EXTRACTION_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_EXTRACTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "heim/lib/trace.hpp"
+#include "heim/lib/triple_buffer.hpp"
+#include "heim/lib/type_sequence.hpp"
+
+namespace heim::sparse
+{
+namespace detail
+{
+template<typename T>
+void
+copy_dense(T const * const first, std::size_t const n, T * const dest)
+{
+  if constexpr (std::is_trivially_copyable_v<T>)
+  {
+    if (n != 0)
+      std::memcpy(dest, first, n * sizeof(T));
+  }
+  else
+    std::copy_n(first, n, dest);
+}
+
+// writes or reads the specified number of objects, and returns whether all of them were
+inline
+bool
+write_objects(std::FILE * const file, void const * const data, std::size_t const size, std::size_t const n)
+{ return n == 0 || std::fwrite(data, size, n, file) == n; }
+
+inline
+bool
+read_objects(std::FILE * const file, void * const data, std::size_t const size, std::size_t const n)
+{ return n == 0 || std::fread(data, size, n, file) == n; }
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   A copy of the dense arrays of a pool, that is its identifiers and components.
+ *
+ * \details
+ *   Updating the copy from its pool only copies the dense pages whose version changed since the last
+ *   update, and appends or truncates the tail of the arrays when the size of the pool changed. \n
+ *   Components are copied with \c std::memcpy when they are trivially copyable. Pools of components
+ *   that are not tracked (see \c is_tracked_component ) only version their structural changes, hence
+ *   their components are copied entirely on each update, and their identifiers after any structural
+ *   change. \n
+ *   The copy also records the number of enabled identifiers of the pool, its disabled identifiers
+ *   being at the front of its arrays.
+ *
+ * \note
+ *   A pool snapshot is meant to be updated from a single pool during its whole lifetime.
+ */
+template<typename Pool>
+class pool_snapshot
+{
+public:
+  using pool_type       = Pool;
+  using component_type  = typename pool_type::component_type;
+  using identifier_type = typename pool_type::identifier_type;
+  using allocator_type  = typename pool_type::allocator_type;
+  using version_type    = typename pool_type::version_type;
+
+  static constexpr std::size_t dense_page_size
+  = pool_type::dense_page_size;
+
+private:
+  static constexpr bool s_has_components
+  = !std::is_empty_v<component_type>;
+
+  using alloc_traits = std::allocator_traits<allocator_type>;
+
+  using identifier_container = std::vector<identifier_type, typename alloc_traits::template rebind_alloc<identifier_type>>;
+  using component_container  = std::vector<component_type , typename alloc_traits::template rebind_alloc<component_type>>;
+
+private:
+  identifier_container m_identifiers;
+  component_container  m_components;
+  std::size_t          m_enabled_size;
+  version_type         m_version;
+
+private:
+  void
+  m_copy_range(pool_type const &pool, std::size_t const first, std::size_t const last)
+  {
+    detail::copy_dense(pool.identifiers().data() + first, last - first, m_identifiers.data() + first);
+
+    if constexpr (s_has_components && pool_type::tracks_modifications)
+      detail::copy_dense(pool.components().data() + first, last - first, m_components.data() + first);
+  }
+
+public:
+  explicit
+  pool_snapshot(allocator_type const &alloc = allocator_type{})
+    : m_identifiers {alloc}
+    , m_components  {alloc}
+    , m_enabled_size{}
+    , m_version     {}
+  { }
+
+
+  [[nodiscard]]
+  std::size_t
+  size() const
+  noexcept
+  { return m_identifiers.size(); }
+
+  [[nodiscard]]
+  bool
+  empty() const
+  noexcept
+  { return m_identifiers.empty(); }
+
+  [[nodiscard]]
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return m_enabled_size; }
+
+  /*!
+   * \brief
+   *   Returns the version of the pool observed by the last update.
+   */
+  [[nodiscard]]
+  version_type
+  version() const
+  noexcept
+  { return m_version; }
+
+  [[nodiscard]]
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return std::span<identifier_type const>{m_identifiers.data(), m_identifiers.size()}; }
+
+  [[nodiscard]]
+  std::span<component_type const>
+  components() const
+  noexcept
+  requires s_has_components
+  { return std::span<component_type const>{m_components.data(), m_components.size()}; }
+
+
+  /*!
+   * \brief
+   *   Brings the copy up to date with the specified pool.
+   */
+  void
+  update(pool_type const &pool)
+  {
+    auto const        ids {pool.identifiers()};
+    std::size_t const size{ids.size()};
+    std::size_t const kept{std::min(m_identifiers.size(), size)};
+
+    m_identifiers.erase(m_identifiers.begin() + static_cast<std::ptrdiff_t>(kept), m_identifiers.end());
+    m_identifiers.insert(m_identifiers.end(), ids.begin() + static_cast<std::ptrdiff_t>(kept), ids.end());
+
+    if constexpr (s_has_components)
+    {
+      auto const comps{pool.components()};
+
+      m_components.erase(m_components.begin() + static_cast<std::ptrdiff_t>(kept), m_components.end());
+      m_components.insert(m_components.end(), comps.begin() + static_cast<std::ptrdiff_t>(kept), comps.end());
+
+      if constexpr (!pool_type::tracks_modifications)
+        detail::copy_dense(comps.data(), kept, m_components.data());
+    }
+
+    for (std::size_t pg_idx{}; pg_idx * dense_page_size < kept; ++pg_idx)
+    {
+      if (pool.page_version(pg_idx) <= m_version)
+        continue;
+
+      std::size_t const first{pg_idx * dense_page_size};
+      m_copy_range(pool, first, std::min(first + dense_page_size, kept));
+    }
+
+    m_enabled_size = pool.enabled_size();
+    m_version      = pool.version();
+  }
+
+
+  /*!
+   * \brief
+   *   Writes the copy to the specified binary file, and returns whether it succeeded.
+   *
+   * \details
+   *   Writes the size of the components, the number of identifiers and of enabled identifiers, then
+   *   the identifiers and the components as raw bytes.
+   */
+  bool
+  write(std::FILE * const file) const
+  requires std::is_trivially_copyable_v<component_type>
+  {
+    std::uint64_t const header[3]{s_has_components ? sizeof(component_type) : 0, size(), m_enabled_size};
+
+    if (!detail::write_objects(file, header, sizeof(std::uint64_t), 3)
+     || !detail::write_objects(file, m_identifiers.data(), sizeof(identifier_type), size()))
+      return false;
+
+    if constexpr (s_has_components)
+      return detail::write_objects(file, m_components.data(), sizeof(component_type), size());
+    else
+      return true;
+  }
+
+  /*!
+   * \brief
+   *   Replaces the copy with the one read from the specified binary file, as written by \c write ,
+   *   and returns whether it succeeded.
+   *
+   * \details
+   *   The next update of the copy copies its pool entirely.
+   */
+  bool
+  read(std::FILE * const file)
+  requires std::is_trivially_copyable_v<component_type>
+  {
+    std::uint64_t header[3];
+
+    if (!detail::read_objects(file, header, sizeof(std::uint64_t), 3)
+     || header[0] != (s_has_components ? sizeof(component_type) : 0)
+     || header[2] > header[1])
+      return false;
+
+    m_identifiers.resize(header[1]);
+    m_enabled_size = header[2];
+    m_version      = version_type{};
+
+    if (!detail::read_objects(file, m_identifiers.data(), sizeof(identifier_type), size()))
+      return false;
+
+    if constexpr (s_has_components)
+    {
+      m_components.resize(header[1]);
+      return detail::read_objects(file, m_components.data(), sizeof(component_type), size());
+    }
+    else
+      return true;
+  }
+};
+
+
+/*!
+ * \brief
+ *   A copy of the identifiers of a registry and of the dense arrays of the pools of the specializing
+ *   component types.
+ *
+ * \details
+ *   The identifiers are copied whole, destroyed ones included, whenever the structure of the registry
+ *   changed since the last update. \c restore brings a registry back to the state of the copy, except
+ *   for the components of the other types and for the scheduled actions, which it clears.
+ */
+template<
+    typename    Registry,
+    typename ...Components>
+requires (
+    sizeof...(Components) > 0
+ && type_sequence<Components ...>::is_unique)
+class registry_snapshot
+{
+public:
+  using registry_type = Registry;
+
+  template<typename Component>
+  using snapshot_for
+  = pool_snapshot<typename registry_type::template container_for<Component>>;
+
+private:
+  using component_sequence = type_sequence<Components ...>;
+  using snapshot_tuple     = std::tuple<snapshot_for<Components> ...>;
+
+private:
+  using identifier_type      = typename registry_type::identifier_type;
+  using identifier_container = std::vector<identifier_type, typename registry_type::allocator_type>;
+
+private:
+  snapshot_tuple               m_snapshots;
+  identifier_container         m_identifiers;
+  std::size_t                  m_destroyed_size;
+  std::size_t                  m_disabled_size;
+  std::optional<std::uint64_t> m_structure;
+  std::uint64_t                m_sequence;
+
+private:
+  // emplaces the copied components of the specified type on their identifiers, and returns whether
+  // all of them were alive and distinct
+  template<typename Component>
+  bool
+  m_restore(registry_type &registry) const
+  {
+    auto const &snapshot{get<Component>()};
+    auto const  ids     {snapshot.identifiers()};
+
+    registry.template container<Component>().reserve(ids.size());
+
+    for (std::size_t i{}; i < ids.size(); ++i)
+    {
+      if (registry.expired(ids[i]) || registry.template container<Component>().contains(ids[i]))
+        return false;
+
+      if constexpr (std::is_empty_v<Component>)
+        registry.template emplace<Component>(ids[i]);
+      else
+        registry.template emplace<Component>(ids[i], snapshot.components()[i]);
+    }
+    return true;
+  }
+
+public:
+  registry_snapshot()
+    : m_snapshots     {}
+    , m_identifiers   {}
+    , m_destroyed_size{}
+    , m_disabled_size {}
+    , m_structure     {}
+    , m_sequence      {}
+  { }
+
+
+  /*!
+   * \brief
+   *   Returns the number of the extraction this snapshot was last updated by, starting at one. A
+   *   sequence number of zero denotes a snapshot that was never updated.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  sequence() const
+  noexcept
+  { return m_sequence; }
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]]
+  snapshot_for<Component> const &
+  get() const
+  noexcept
+  { return std::get<component_sequence::template index<Component>>(m_snapshots); }
+
+  /*!
+   * \brief
+   *   Returns the copy of the dense array of identifiers of the registry, as returned by its
+   *   \c identifiers .
+   */
+  [[nodiscard]]
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return std::span<identifier_type const>{m_identifiers.data(), m_identifiers.size()}; }
+
+  [[nodiscard]]
+  std::size_t
+  destroyed_size() const
+  noexcept
+  { return m_destroyed_size; }
+
+  [[nodiscard]]
+  std::size_t
+  disabled_size() const
+  noexcept
+  { return m_disabled_size; }
+
+
+  void
+  update(registry_type const &registry, std::uint64_t const sequence)
+  {
+    if (m_structure != registry.structural_version())
+    {
+      auto const ids{registry.identifiers()};
+
+      m_identifiers.assign(ids.begin(), ids.end());
+      m_destroyed_size = registry.destroyed_size();
+      m_disabled_size  = registry.disabled_size();
+      m_structure      = registry.structural_version();
+    }
+
+    (std::get<snapshot_for<Components>>(m_snapshots).update(registry.template container<Components>()), ...);
+    m_sequence = sequence;
+  }
+
+  /*!
+   * \brief
+   *   Restores the identifiers of the specified registry and its components of the specializing
+   *   types from the copy, and returns whether the copy was consistent.
+   *
+   * \details
+   *   The other components and the scheduled actions of the registry are cleared. An inconsistent
+   *   copy (e.g. read from a corrupted file) leaves the registry unchanged if its identifiers are
+   *   invalid, and with only part of the components otherwise.
+   */
+  bool
+  restore(registry_type &registry) const
+  {
+    if (!registry.restore_identifiers(identifiers(), m_destroyed_size, m_disabled_size))
+      return false;
+
+    return (m_restore<Components>(registry) && ...);
+  }
+
+  /*!
+   * \brief
+   *   Writes the copies of the identifiers and of the pools to the specified binary file, preceded by
+   *   the sequence number of the snapshot, and returns whether it succeeded.
+   */
+  bool
+  write(std::FILE * const file) const
+  requires (std::is_trivially_copyable_v<Components> && ...)
+  {
+    std::uint64_t const header[3]{m_identifiers.size(), m_destroyed_size, m_disabled_size};
+
+    return detail::write_objects(file, &m_sequence, sizeof(m_sequence), 1)
+        && detail::write_objects(file, header, sizeof(std::uint64_t), 3)
+        && detail::write_objects(file, m_identifiers.data(), sizeof(identifier_type), m_identifiers.size())
+        && (std::get<snapshot_for<Components>>(m_snapshots).write(file) && ...);
+  }
+
+  /*!
+   * \brief
+   *   Replaces the copies of the identifiers and of the pools with the ones read from the specified
+   *   binary file, as written by \c write , and returns whether it succeeded.
+   *
+   * \details
+   *   The next update of the copy copies its registry entirely.
+   */
+  bool
+  read(std::FILE * const file)
+  requires (std::is_trivially_copyable_v<Components> && ...)
+  {
+    std::uint64_t header[3];
+
+    if (!detail::read_objects(file, &m_sequence, sizeof(m_sequence), 1)
+     || !detail::read_objects(file, header, sizeof(std::uint64_t), 3)
+     || header[1] > header[0]
+     || header[2] > header[0] - header[1])
+      return false;
+
+    m_identifiers.resize(header[0]);
+    m_destroyed_size = header[1];
+    m_disabled_size  = header[2];
+    m_structure.reset();
+
+    return detail::read_objects(file, m_identifiers.data(), sizeof(identifier_type), m_identifiers.size())
+        && (std::get<snapshot_for<Components>>(m_snapshots).read(file) && ...);
+  }
+};
+
+
+/*!
+ * \brief
+ *   Extracts copies of the pools of the specializing component types of a registry into a triple
+ *   buffer, so that a consumer thread can read a consistent view of them without locks while the
+ *   registry keeps being modified.
+ *
+ * \details
+ *   Each buffer remembers the versions of the pools it last copied, so that extracting into it
+ *   only copies the dense pages that changed since, even though that buffer may be several
+ *   extractions behind.
+ *
+ * \note
+ *   \c extract must be called by a single producer thread, which must also be the only one
+ *   modifying the registry during the call. \c acquire must be called by a single consumer thread.
+ */
+template<
+    typename    Registry,
+    typename ...Components>
+class snapshot_extractor
+{
+public:
+  using registry_type = Registry;
+  using snapshot_type = registry_snapshot<Registry, Components ...>;
+
+private:
+  triple_buffer<snapshot_type> m_buffer;
+  std::uint64_t                m_sequence;
+
+public:
+  snapshot_extractor()
+    : m_buffer  {}
+    , m_sequence{}
+  { }
+
+
+  void
+  extract(registry_type const &registry)
+  {
+    HEIM_TRACE_ZONE("heim::snapshot_extractor::extract");
+
+    m_buffer.back().update(registry, ++m_sequence);
+    m_buffer.publish();
+  }
+
+  [[nodiscard]]
+  snapshot_type const &
+  acquire()
+  noexcept
+  { return m_buffer.acquire(); }
+};
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_EXTRACTION_HPP
@@ -0,0 +1,409 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_FIXED_POOL_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_FIXED_POOL_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "heim/ecs/identifier.hpp"
+
+namespace heim::sparse
+{
+/*!
+ * \brief
+ *   A container of components of the specializing type mapped to identifiers, stored in inline arrays
+ *   of the specified capacity.
+ *
+ * \details
+ *   Keeps the layout of \c pool (the disabled identifiers at the front of the dense arrays, iterated
+ *   last) without any page: the sparse array is indexed directly by the indexes of the identifiers,
+ *   which must be lower than the capacity, hence the pool never allocates and is never full once each
+ *   of its identifiers is distinct. \n
+ *   The slots of the component array past the size of the pool hold default-constructed components,
+ *   and erasing a component assigns such a component to the slot it vacates.
+ */
+template<
+    typename    Component,
+    typename    Identifier,
+    std::size_t Capacity>
+requires (
+    identifier<Identifier>
+ && (std::is_empty_v<Component> || (std::default_initializable<Component> && std::movable<Component>)))
+class fixed_pool
+{
+public:
+  using component_type  = Component;
+  using identifier_type = Identifier;
+
+  using iterator       = std::reverse_iterator<identifier_type const *>;
+  using const_iterator = std::reverse_iterator<identifier_type const *>;
+
+  static constexpr std::size_t capacity
+  = Capacity;
+
+  // the pool is contiguous, hence chunked iterations see a single page
+  static constexpr std::size_t dense_page_size
+  = Capacity;
+
+private:
+  using id_traits     = identifier_traits<identifier_type>;
+  using position_type = typename id_traits::index_type;
+
+  static constexpr bool s_has_components
+  = !std::is_empty_v<component_type>;
+
+private:
+  std::array<identifier_type, Capacity>                        m_dense;
+  std::array<component_type , s_has_components ? Capacity : 0> m_components;
+  std::array<position_type  , Capacity>                        m_sparse;
+  std::size_t                                                  m_size;
+  std::size_t                                                  m_disabled;
+  std::uint64_t                                                m_structure;
+
+private:
+  [[nodiscard]] constexpr
+  std::size_t
+  m_position(identifier_type const id) const
+  noexcept
+  { return static_cast<std::size_t>(m_sparse[static_cast<std::size_t>(id_traits::index(id))]); }
+
+  constexpr
+  void
+  m_swap(std::size_t const lhs, std::size_t const rhs)
+  noexcept(std::is_nothrow_swappable_v<component_type>)
+  {
+    if (lhs == rhs)
+      return;
+
+    std::swap(m_dense[lhs], m_dense[rhs]);
+    if constexpr (s_has_components)
+      std::ranges::swap(m_components[lhs], m_components[rhs]);
+
+    m_sparse[static_cast<std::size_t>(id_traits::index(m_dense[lhs]))] = static_cast<position_type>(lhs);
+    m_sparse[static_cast<std::size_t>(id_traits::index(m_dense[rhs]))] = static_cast<position_type>(rhs);
+  }
+
+public:
+  constexpr
+  fixed_pool()
+  noexcept(std::is_nothrow_default_constructible_v<component_type>)
+    : m_dense     {}
+    , m_components{}
+    , m_sparse    {}
+    , m_size      {}
+    , m_disabled  {}
+    , m_structure {}
+  { }
+
+  constexpr
+  fixed_pool(fixed_pool const &)
+  = default;
+
+  constexpr
+  fixed_pool(fixed_pool &&)
+  = default;
+
+  constexpr
+  ~fixed_pool()
+  = default;
+
+  constexpr
+  fixed_pool &
+  operator=(fixed_pool const &)
+  = default;
+
+  constexpr
+  fixed_pool &
+  operator=(fixed_pool &&)
+  = default;
+
+
+  [[nodiscard]] constexpr
+  const_iterator
+  begin() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.data() + m_size); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  end() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.data()); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  cbegin() const
+  noexcept
+  { return begin(); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  cend() const
+  noexcept
+  { return end(); }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  enabled_end() const
+  noexcept
+  { return std::make_reverse_iterator(m_dense.data() + m_disabled); }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  size() const
+  noexcept
+  { return m_size; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return m_size - m_disabled; }
+
+  [[nodiscard]] constexpr
+  bool
+  empty() const
+  noexcept
+  { return m_size == 0; }
+
+  [[nodiscard]] constexpr
+  bool
+  contains(identifier_type const id) const
+  noexcept
+  {
+    auto const idx{static_cast<std::size_t>(id_traits::index(id))};
+
+    if (idx >= Capacity)
+      return false;
+
+    std::size_t const pos{m_sparse[idx]};
+    return pos < m_size && m_dense[pos] == id;
+  }
+
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return m_position(id) >= m_disabled; }
+
+  [[nodiscard]] constexpr
+  std::uint64_t
+  structural_version() const
+  noexcept
+  { return m_structure; }
+
+  /*!
+   * \brief
+   *   Returns the identifiers of the pool in their dense order, which is the reverse of the iteration
+   *   order.
+   */
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return {m_dense.data(), m_size}; }
+
+  [[nodiscard]] constexpr
+  std::span<component_type>
+  components()
+  noexcept
+  requires s_has_components
+  { return {m_components.data(), m_size}; }
+
+  [[nodiscard]] constexpr
+  std::span<component_type const>
+  components() const
+  noexcept
+  requires s_has_components
+  { return {m_components.data(), m_size}; }
+
+  [[nodiscard]] constexpr
+  component_type &
+  operator[](identifier_type const id)
+  noexcept
+  requires s_has_components
+  { return m_components[m_position(id)]; }
+
+  [[nodiscard]] constexpr
+  component_type const &
+  operator[](identifier_type const id) const
+  noexcept
+  requires s_has_components
+  { return m_components[m_position(id)]; }
+
+  /*!
+   * \brief
+   *   Copies the components of the specified identifiers, which must all be contained, to the
+   *   specified buffer in the same order, or throws \c std::out_of_range , copying nothing, if the
+   *   buffer is smaller than the identifiers.
+   */
+  constexpr
+  void
+  gather(std::span<identifier_type const> const ids, std::span<component_type> const out) const
+  requires s_has_components
+  {
+    if (out.size() < ids.size())
+      throw std::out_of_range{"heim::sparse::fixed_pool::gather: the buffer is smaller than the identifiers"};
+
+    for (std::size_t i{}; i < ids.size(); ++i)
+      out[i] = (*this)[ids[i]];
+  }
+
+  constexpr
+  void
+  scatter(std::span<identifier_type const> const ids, std::span<component_type const> const in)
+  requires s_has_components
+  {
+    if (in.size() < ids.size())
+      throw std::out_of_range{"heim::sparse::fixed_pool::scatter: the buffer is smaller than the identifiers"};
+
+    for (std::size_t i{}; i < ids.size(); ++i)
+      (*this)[ids[i]] = in[i];
+  }
+
+
+  /*!
+   * \brief
+   *   Inserts the specified identifier, which must not already be contained, with a component
+   *   constructed from the specified arguments.
+   */
+  template<typename ...Args>
+  constexpr
+  void
+  emplace(identifier_type const id, [[maybe_unused]] Args &&...args)
+  {
+    if constexpr (s_has_components)
+      m_components[m_size] = component_type(std::forward<Args>(args)...);
+
+    m_dense[m_size] = id;
+    m_sparse[static_cast<std::size_t>(id_traits::index(id))] = static_cast<position_type>(m_size);
+    ++m_size;
+    ++m_structure;
+  }
+
+  template<typename ...Args>
+  constexpr
+  bool
+  try_emplace(identifier_type const id, Args &&...args)
+  {
+    if (contains(id))
+      return false;
+
+    emplace(id, std::forward<Args>(args)...);
+    return true;
+  }
+
+  constexpr
+  bool
+  insert(identifier_type const id, component_type const &c)
+  { return try_emplace(id, c); }
+
+  constexpr
+  bool
+  insert(identifier_type const id, component_type &&c)
+  { return try_emplace(id, std::move(c)); }
+
+  constexpr
+  bool
+  insert_or_assign(identifier_type const id, component_type const &c)
+  {
+    if (!contains(id))
+    { emplace(id, c); return true; }
+
+    if constexpr (s_has_components)
+      (*this)[id] = c;
+    return false;
+  }
+
+  constexpr
+  bool
+  insert_or_assign(identifier_type const id, component_type &&c)
+  {
+    if (!contains(id))
+    { emplace(id, std::move(c)); return true; }
+
+    if constexpr (s_has_components)
+      (*this)[id] = std::move(c);
+    return false;
+  }
+
+  constexpr
+  void
+  enable(identifier_type const id)
+  {
+    if (enabled(id))
+      return;
+
+    m_swap(m_position(id), --m_disabled);
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  disable(identifier_type const id)
+  {
+    if (!enabled(id))
+      return;
+
+    m_swap(m_position(id), m_disabled++);
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  erase(identifier_type const id)
+  {
+    enable(id);
+
+    std::size_t const pos {m_position(id)};
+    std::size_t const back{--m_size};
+
+    if (pos != back)
+    {
+      m_dense[pos] = m_dense[back];
+      m_sparse[static_cast<std::size_t>(id_traits::index(m_dense[pos]))] = static_cast<position_type>(pos);
+
+      if constexpr (s_has_components)
+        m_components[pos] = std::move(m_components[back]);
+    }
+
+    if constexpr (s_has_components)
+      m_components[back] = component_type{};
+    ++m_structure;
+  }
+
+  constexpr
+  bool
+  try_erase(identifier_type const id)
+  {
+    if (!contains(id))
+      return false;
+
+    erase(id);
+    return true;
+  }
+
+  constexpr
+  void
+  clear()
+  {
+    if constexpr (s_has_components)
+    {
+      for (std::size_t pos{}; pos < m_size; ++pos)
+        m_components[pos] = component_type{};
+    }
+
+    m_size     = 0;
+    m_disabled = 0;
+    ++m_structure;
+  }
+};
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_FIXED_POOL_HPP
@@ -0,0 +1,442 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_FIXED_REGISTRY_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_FIXED_REGISTRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "heim/ecs/entity.hpp"
+#include "heim/ecs/expression.hpp"
+#include "heim/ecs/identifier.hpp"
+#include "heim/lib/type_sequence.hpp"
+#include "detail/fixed_core.hpp"
+#include "detail/iterator.hpp"
+#include "fixed_pool.hpp"
+#include "static_registry.hpp"
+
+namespace heim::sparse
+{
+/*!
+ * \brief
+ *   The registry of at most the specified number of entities and of their components, whose
+ *   component types are known at compile time, stored in inline arrays.
+ *
+ * \details
+ *   Is designed for loops that must never allocate: the identifiers and each pool are stored in arrays
+ *   of the capacity of the registry, indexed directly without any page, so that the registry never
+ *   allocates nor follows a pointer to its storage. Only the creation of entities can exceed the
+ *   capacity, which \c entity reports by returning no handle. \n
+ *   The registry shares the entity handles, the expressions and the queries of
+ *   \c generic_static_registry , but neither schedules actions nor hashes its state. Components must be
+ *   default constructible and movable, see \c fixed_pool .
+ *
+ * \note
+ *   The registry holds all of its storage, hence large capacities are better served by registries of
+ *   static storage duration than by registries on the stack.
+ */
+template<
+    typename       Identifier,
+    std::size_t    Capacity,
+    typename    ...Components>
+requires (
+    identifier<Identifier>
+ && type_sequence<Components ...>::is_unique)
+class generic_fixed_registry
+  : protected detail::fixed_registry_core<Identifier, Capacity>
+{
+  using core_type = detail::fixed_registry_core<Identifier, Capacity>;
+
+  template<typename>           friend class detail::registry_iterator;
+  template<typename, typename> friend class detail::generic_static_registry_query_driver;
+  template<typename, typename> friend class detail::generic_static_registry_query_iterator;
+  template<typename, typename> friend class detail::generic_static_registry_query;
+
+public:
+  using identifier_type    = Identifier;
+  using component_sequence = type_sequence<Components ...>;
+  // the type of the ticks of entity handles, although the registry does not schedule actions
+  using tick_type          = std::uint64_t;
+
+  using iterator       = detail::registry_iterator<generic_fixed_registry>;
+  using const_iterator = detail::registry_iterator<generic_fixed_registry const>;
+
+  template<typename Component>
+  using container_for
+  = fixed_pool<Component, Identifier, Capacity>;
+
+  template<typename Component>
+  static constexpr std::size_t component_index
+  = component_sequence::template index<Component>;
+
+private:
+  std::tuple<container_for<Components> ...> m_containers;
+
+private:
+  template<typename Component>
+  constexpr
+  void
+  m_match_enabled(identifier_type const id)
+  {
+    if (!core_type::enabled(id))
+      container<std::remove_cvref_t<Component>>().disable(id);
+  }
+
+  template<typename ...Expressions>
+  [[nodiscard]] constexpr
+  bool
+  m_matches_conjunction(identifier_type const id, conjunction<Expressions ...>) const
+  noexcept
+  { return (matches<Expressions>(id) && ...); }
+
+  template<typename ...Expressions>
+  [[nodiscard]] constexpr
+  bool
+  m_matches_disjunction(identifier_type const id, disjunction<Expressions ...>) const
+  noexcept
+  { return (matches<Expressions>(id) || ...); }
+
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  bool
+  m_matches_negation(identifier_type const id, negation<Expression>) const
+  noexcept
+  { return !matches<Expression>(id); }
+
+public:
+  constexpr
+  generic_fixed_registry()
+  = default;
+
+  constexpr
+  generic_fixed_registry(generic_fixed_registry const &)
+  = default;
+
+  constexpr
+  generic_fixed_registry(generic_fixed_registry &&)
+  = default;
+
+  constexpr
+  ~generic_fixed_registry()
+  = default;
+
+  constexpr
+  generic_fixed_registry &
+  operator=(generic_fixed_registry const &)
+  = default;
+
+  constexpr
+  generic_fixed_registry &
+  operator=(generic_fixed_registry &&)
+  = default;
+
+
+  [[nodiscard]] constexpr
+  iterator
+  begin()
+  noexcept
+  { return iterator{*this, core_type::begin()}; }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  begin() const
+  noexcept
+  { return const_iterator{*this, core_type::begin()}; }
+
+  [[nodiscard]] constexpr
+  iterator
+  end()
+  noexcept
+  { return iterator{*this, core_type::end()}; }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  end() const
+  noexcept
+  { return const_iterator{*this, core_type::end()}; }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  cbegin() const
+  noexcept
+  { return const_iterator{*this, core_type::cbegin()}; }
+
+  [[nodiscard]] constexpr
+  const_iterator
+  cend() const
+  noexcept
+  { return const_iterator{*this, core_type::cend()}; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  size() const
+  noexcept
+  { return core_type::size(); }
+
+  [[nodiscard]] constexpr
+  bool
+  empty() const
+  noexcept
+  { return core_type::empty(); }
+
+  /*!
+   * \brief
+   *   Returns whether the registry holds as many entities as its capacity, in which case no entity can
+   *   be created before one is destroyed.
+   */
+  [[nodiscard]] constexpr
+  bool
+  full() const
+  noexcept
+  { return core_type::full(); }
+
+  [[nodiscard]] static constexpr
+  std::size_t
+  capacity()
+  noexcept
+  { return Capacity; }
+
+  [[nodiscard]] constexpr
+  std::uint64_t
+  structural_version() const
+  noexcept
+  { return core_type::structural_version() + (std::uint64_t{} + ... + container<Components>().structural_version()); }
+
+
+  [[nodiscard]] constexpr
+  bool
+  expired(identifier_type const id) const
+  noexcept
+  { return core_type::expired(id); }
+
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  bool
+  matches(identifier_type const id, Expression const = Expression{}) const
+  noexcept
+  {
+    if      constexpr (is_specialization_of_conjunction_v<Expression>)
+      return m_matches_conjunction(id, Expression{});
+    else if constexpr (is_specialization_of_disjunction_v<Expression>)
+      return m_matches_disjunction(id, Expression{});
+    else if constexpr (is_specialization_of_negation_v   <Expression>)
+      return m_matches_negation   (id, Expression{});
+    else
+      return container<Expression>().contains(id);
+  }
+
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return core_type::enabled(id); }
+
+  constexpr
+  void
+  enable(identifier_type const id)
+  {
+    if (core_type::enabled(id))
+      return;
+
+    ((container<Components>().contains(id) ? container<Components>().enable(id) : void()), ...);
+    core_type::enable(id);
+  }
+
+  constexpr
+  void
+  disable(identifier_type const id)
+  {
+    if (!core_type::enabled(id))
+      return;
+
+    ((container<Components>().contains(id) ? container<Components>().disable(id) : void()), ...);
+    core_type::disable(id);
+  }
+
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]] constexpr
+  container_for<Component> &
+  container()
+  noexcept
+  { return std::get<component_index<Component>>(m_containers); }
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]] constexpr
+  container_for<Component> const &
+  container() const
+  noexcept
+  { return std::get<component_index<Component>>(m_containers); }
+
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  auto
+  query()
+  noexcept
+  {
+    return detail::generic_static_registry_query<
+        Expression,
+        generic_fixed_registry>
+        {*this};
+  }
+
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  auto
+  query() const
+  noexcept
+  {
+    return detail::generic_static_registry_query<
+        Expression,
+        generic_fixed_registry const>
+        {*this};
+  }
+
+  template<typename Component>
+  requires (!std::is_empty_v<Component>)
+  [[nodiscard]] constexpr
+  Component &
+  get(identifier_type const id)
+  noexcept
+  { return container<Component>()[id]; }
+
+  template<typename Component>
+  requires (!std::is_empty_v<Component>)
+  [[nodiscard]] constexpr
+  Component const &
+  get(identifier_type const id) const
+  noexcept
+  { return container<Component>()[id]; }
+
+  template<typename Component>
+  [[nodiscard]] constexpr
+  Component *
+  get_if(identifier_type const id)
+  noexcept
+  {
+    if (matches<Component>(id))
+      return std::addressof(get<Component>(id));
+    return nullptr;
+  }
+
+  template<typename Component>
+  [[nodiscard]] constexpr
+  Component const *
+  get_if(identifier_type const id) const
+  noexcept
+  {
+    if (matches<Component>(id))
+      return std::addressof(get<Component>(id));
+    return nullptr;
+  }
+
+
+  /*!
+   * \brief
+   *   Creates an entity and returns its handle, or returns no handle if the registry is full.
+   */
+  [[nodiscard]] constexpr
+  std::optional<heim::entity<generic_fixed_registry>>
+  entity()
+  noexcept
+  {
+    identifier_type const id{core_type::create()};
+
+    if (id == identifier_traits<identifier_type>::null)
+      return std::nullopt;
+    return heim::entity<generic_fixed_registry>{*this, id};
+  }
+
+  template<typename Component, typename ...Args>
+  constexpr
+  void
+  emplace(identifier_type const id, Args &&...args)
+  {
+    container<Component>().emplace(id, std::forward<Args>(args)...);
+    m_match_enabled<Component>(id);
+  }
+
+  template<typename Component, typename ...Args>
+  constexpr
+  bool
+  try_emplace(identifier_type const id, Args &&...args)
+  {
+    bool const inserted{container<Component>().try_emplace(id, std::forward<Args>(args)...)};
+
+    m_match_enabled<Component>(id);
+    return inserted;
+  }
+
+  template<typename Component>
+  constexpr
+  bool
+  insert(identifier_type const id, Component &&c)
+  {
+    bool const inserted{container<std::remove_cvref_t<Component>>().insert(id, std::forward<Component>(c))};
+
+    m_match_enabled<Component>(id);
+    return inserted;
+  }
+
+  template<typename Component>
+  constexpr
+  bool
+  insert_or_assign(identifier_type const id, Component &&c)
+  {
+    bool const inserted{container<std::remove_cvref_t<Component>>().insert_or_assign(id, std::forward<Component>(c))};
+
+    m_match_enabled<Component>(id);
+    return inserted;
+  }
+
+  template<typename Component>
+  constexpr
+  void
+  erase(identifier_type const id)
+  { container<Component>().erase(id); }
+
+  template<typename Component>
+  constexpr
+  bool
+  try_erase(identifier_type const id)
+  { return container<Component>().try_erase(id); }
+
+  constexpr
+  void
+  clear(identifier_type const id)
+  { (container<Components>().try_erase(id), ...); }
+
+  constexpr
+  void
+  clear()
+  {
+    (container<Components>().clear(), ...);
+    core_type::clear();
+  }
+
+  constexpr
+  bool
+  destroy(identifier_type const id)
+  {
+    if (expired(id))
+      return false;
+
+    clear(id);
+    core_type::destroy(id);
+    return true;
+  }
+};
+
+template<
+    std::size_t    Capacity,
+    typename    ...Components>
+using fixed_registry
+= generic_fixed_registry<default_identifier_t<>, Capacity, Components ...>;
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_FIXED_REGISTRY_HPP
@@ -0,0 +1,574 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_FROZEN_REGISTRY_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_FROZEN_REGISTRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include "heim/ecs/entity.hpp"
+#include "heim/ecs/expression.hpp"
+#include "heim/ecs/identifier.hpp"
+#include "heim/lib/type_sequence.hpp"
+#include "static_registry.hpp"
+
+namespace heim::sparse
+{
+/*!
+ * \brief
+ *   The sizes of a frozen registry, which determine the sizes of its arrays.
+ */
+template<std::size_t ComponentCount>
+struct frozen_registry_extents
+{
+  std::size_t                             entities;
+  std::size_t                             enabled;
+  std::size_t                             entity_index_bound;
+  std::array<std::size_t, ComponentCount> sizes;
+  std::array<std::size_t, ComponentCount> enabled_sizes;
+  std::array<std::size_t, ComponentCount> index_bounds;
+};
+
+
+namespace detail
+{
+// the identifiers and components of a pool, in the iteration order of the pool, and the position of
+// each of its identifiers indexed by their index
+template<
+    typename    Identifier,
+    typename    Component,
+    std::size_t Size,
+    std::size_t IndexBound>
+struct frozen_pool
+{
+  using identifier_type = Identifier;
+  using component_type  = Component;
+  using position_type   = std::conditional_t<(Size < std::numeric_limits<std::uint32_t>::max()), std::uint32_t, std::size_t>;
+
+  static constexpr position_type npos
+  = std::numeric_limits<position_type>::max();
+
+  std::array<identifier_type, Size>                                           identifiers;
+  std::array<component_type , std::is_empty_v<component_type> ? 0 : Size>    components;
+  std::array<position_type  , IndexBound>                                     positions;
+
+  [[nodiscard]] constexpr
+  position_type
+  find(identifier_type const id) const
+  noexcept
+  {
+    auto const idx{identifier_traits<identifier_type>::index(id)};
+
+    if (idx >= IndexBound)
+      return npos;
+
+    position_type const pos{positions[idx]};
+    return pos != npos && identifiers[pos] == id ? pos : npos;
+  }
+};
+
+
+template<
+    typename,
+    typename,
+    auto>
+struct frozen_pool_tuple;
+
+template<
+    typename       Identifier,
+    typename    ...Components,
+    auto           Extents>
+struct frozen_pool_tuple<Identifier, type_sequence<Components ...>, Extents>
+{
+  using type
+  = decltype([]<std::size_t ...Is>(std::index_sequence<Is ...>)
+    {
+      return std::tuple<frozen_pool<Identifier, Components, Extents.sizes[Is], Extents.index_bounds[Is]> ...>{};
+    }(std::index_sequence_for<Components ...>{}));
+};
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   A read-only form of a registry with fixed-size arrays instead of paged containers, meant to be
+ *   built by \c freeze in a constant expression and embedded in the binary.
+ *
+ * \details
+ *   Holds the live identifiers of the registry and, for each component type, the identifiers and the
+ *   components of its pool in their iteration order, enabled identifiers first, along with a flat
+ *   array of their positions indexed by the index of their identifiers. The live identifiers are indexed
+ *   the same way, so that \c contains , \c expired and \c enabled take constant time. \n
+ *   It is queried as the registry is, through \c query with the same expressions, and its entities are
+ *   designated by handles of \c entity of a constant frozen registry.
+ */
+template<
+    typename Registry,
+    auto     Extents>
+class frozen_registry
+{
+  template<auto Build>
+  requires std::invocable<decltype(Build)>
+  friend consteval auto freeze();
+
+public:
+  using registry_type      = Registry;
+  using identifier_type    = typename registry_type::identifier_type;
+  using component_sequence = typename registry_type::component_sequence;
+  using tick_type          = typename registry_type::tick_type;
+
+  using entity_type = heim::entity<frozen_registry const>;
+
+private:
+  using pool_tuple    = typename detail::frozen_pool_tuple<identifier_type, component_sequence, Extents>::type;
+  using position_type = std::conditional_t<(Extents.entities < std::numeric_limits<std::uint32_t>::max()), std::uint32_t, std::size_t>;
+
+  static constexpr position_type s_npos
+  = std::numeric_limits<position_type>::max();
+
+  template<typename Component>
+  static constexpr
+  std::size_t
+  s_component_index
+  = component_sequence::template index<Component>;
+
+private:
+  std::array<identifier_type, Extents.entities>           m_entities;
+  std::array<position_type  , Extents.entity_index_bound> m_positions;
+  pool_tuple                                              m_pools;
+
+private:
+  template<typename Component>
+  [[nodiscard]] constexpr
+  auto const &
+  m_pool() const
+  noexcept
+  { return std::get<s_component_index<Component>>(m_pools); }
+
+  // the position of the specified identifier in the live identifiers, or s_npos if it is not live
+  [[nodiscard]] constexpr
+  position_type
+  m_find(identifier_type const id) const
+  noexcept
+  {
+    auto const idx{identifier_traits<identifier_type>::index(id)};
+
+    if (idx >= Extents.entity_index_bound)
+      return s_npos;
+
+    position_type const pos{m_positions[idx]};
+    return pos != s_npos && m_entities[pos] == id ? pos : s_npos;
+  }
+
+  // the enabled identifiers the query of the specified expression iterates, which are those of the
+  // smallest pool of the components guaranteed by the expression, or all enabled identifiers if none is
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  m_query_range() const
+  noexcept
+  {
+    std::span<identifier_type const> range{m_entities.data(), Extents.enabled};
+
+    [&]<typename ...Components>(type_sequence<Components ...>)
+    {
+      ((Extents.enabled_sizes[s_component_index<Components>] < range.size()
+          ? void(range = std::span<identifier_type const>{
+                m_pool<Components>().identifiers.data(),
+                Extents.enabled_sizes[s_component_index<Components>]})
+          : void()), ...);
+    }(guaranteed_t<Expression>{});
+
+    return range;
+  }
+
+  // builds the frozen form of the specified registry, whose sizes must be the extents
+  template<typename Component>
+  constexpr
+  void
+  m_freeze_pool(registry_type const &registry)
+  {
+    auto       &frozen{std::get<s_component_index<Component>>(m_pools)};
+    auto const &pool  {registry.template container<Component>()};
+    auto const  ids   {pool.identifiers()};
+
+    std::ranges::fill(frozen.positions, frozen.npos);
+
+    for (std::size_t pos{}; pos < ids.size(); ++pos)
+    {
+      std::size_t const dense{ids.size() - 1 - pos};
+
+      frozen.identifiers[pos] = ids[dense];
+      frozen.positions[identifier_traits<identifier_type>::index(ids[dense])]
+          = static_cast<typename std::remove_cvref_t<decltype(frozen)>::position_type>(pos);
+
+      if constexpr (!std::is_empty_v<Component>)
+        frozen.components[pos] = pool.components()[dense];
+    }
+  }
+
+  constexpr
+  void
+  m_freeze(registry_type const &registry)
+  {
+    std::ranges::transform(registry, m_entities.begin(), [](auto const e) { return e.identifier(); });
+
+    std::ranges::fill(m_positions, s_npos);
+    for (std::size_t pos{}; pos < m_entities.size(); ++pos)
+      m_positions[identifier_traits<identifier_type>::index(m_entities[pos])] = static_cast<position_type>(pos);
+
+    [&]<typename ...Components>(type_sequence<Components ...>)
+    {
+      (m_freeze_pool<Components>(registry), ...);
+    }(component_sequence{});
+  }
+
+public:
+  [[nodiscard]] constexpr
+  std::size_t
+  size() const
+  noexcept
+  { return Extents.entities; }
+
+  [[nodiscard]] constexpr
+  bool
+  empty() const
+  noexcept
+  { return Extents.entities == 0; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return Extents.enabled; }
+
+  /*!
+   * \brief
+   *   Returns the live identifiers of the registry, enabled identifiers first.
+   */
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return m_entities; }
+
+  template<typename Component>
+  requires component_sequence::template contains<Component>
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return m_pool<Component>().identifiers; }
+
+  template<typename Component>
+  requires (
+      component_sequence::template contains<Component>
+   && !std::is_empty_v<Component>)
+  [[nodiscard]] constexpr
+  std::span<Component const>
+  components() const
+  noexcept
+  { return m_pool<Component>().components; }
+
+
+  [[nodiscard]] constexpr
+  bool
+  contains(identifier_type const id) const
+  noexcept
+  { return m_find(id) != s_npos; }
+
+  [[nodiscard]] constexpr
+  bool
+  expired(identifier_type const id) const
+  noexcept
+  { return !contains(id); }
+
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return m_find(id) < Extents.enabled; }
+
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  bool
+  matches(identifier_type const id, Expression const = Expression{}) const
+  noexcept
+  {
+    if constexpr (specialization_of_conjunction<Expression>)
+    {
+      return []<typename ...Expressions>(frozen_registry const &self, identifier_type const id, conjunction<Expressions ...>)
+      { return (self.template matches<Expressions>(id) && ...); }(*this, id, Expression{});
+    }
+    else if constexpr (specialization_of_disjunction<Expression>)
+    {
+      return []<typename ...Expressions>(frozen_registry const &self, identifier_type const id, disjunction<Expressions ...>)
+      { return (self.template matches<Expressions>(id) || ...); }(*this, id, Expression{});
+    }
+    else if constexpr (specialization_of_negation<Expression>)
+    {
+      return []<typename Sub>(frozen_registry const &self, identifier_type const id, negation<Sub>)
+      { return !self.template matches<Sub>(id); }(*this, id, Expression{});
+    }
+    else
+      return m_pool<Expression>().find(id) != m_pool<Expression>().npos;
+  }
+
+  template<typename Component>
+  requires (
+      component_sequence::template contains<Component>
+   && !std::is_empty_v<Component>)
+  [[nodiscard]] constexpr
+  Component const &
+  get(identifier_type const id) const
+  noexcept
+  { return m_pool<Component>().components[m_pool<Component>().find(id)]; }
+
+  template<typename Component>
+  requires (
+      component_sequence::template contains<Component>
+   && !std::is_empty_v<Component>)
+  [[nodiscard]] constexpr
+  Component const *
+  get_if(identifier_type const id) const
+  noexcept
+  {
+    auto const pos{m_pool<Component>().find(id)};
+    return pos != m_pool<Component>().npos ? &m_pool<Component>().components[pos] : nullptr;
+  }
+
+  [[nodiscard]] constexpr
+  entity_type
+  entity(identifier_type const id) const
+  noexcept
+  { return entity_type{*this, id}; }
+
+
+  /*!
+   * \brief
+   *   Returns a range of the handles of the enabled entities matching the specializing expression.
+   */
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  auto
+  query() const
+  noexcept;
+};
+
+
+namespace detail
+{
+// iterates the identifiers of a range that match an expression, as entity handles
+template<
+    typename Frozen,
+    typename Expression>
+class frozen_registry_query_iterator
+{
+public:
+  using value_type        = typename Frozen::entity_type;
+  using difference_type   = std::ptrdiff_t;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  using identifier_type = typename Frozen::identifier_type;
+
+private:
+  Frozen const          *m_registry;
+  identifier_type const *m_current;
+  identifier_type const *m_end;
+
+private:
+  constexpr
+  void
+  m_skip()
+  noexcept
+  {
+    while (m_current != m_end && !m_registry->template matches<Expression>(*m_current))
+      ++m_current;
+  }
+
+public:
+  constexpr
+  frozen_registry_query_iterator()
+  noexcept
+    : m_registry{}
+    , m_current {}
+    , m_end     {}
+  { }
+
+  constexpr
+  frozen_registry_query_iterator(Frozen const &registry, identifier_type const * const current, identifier_type const * const end)
+  noexcept
+    : m_registry{&registry}
+    , m_current {current}
+    , m_end     {end}
+  { m_skip(); }
+
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(frozen_registry_query_iterator const &lhs, frozen_registry_query_iterator const &rhs)
+  noexcept
+  { return lhs.m_current == rhs.m_current; }
+
+  [[nodiscard]] constexpr
+  value_type
+  operator*() const
+  noexcept
+  { return value_type{*m_registry, *m_current}; }
+
+  constexpr
+  frozen_registry_query_iterator &
+  operator++()
+  noexcept
+  {
+    ++m_current;
+    m_skip();
+    return *this;
+  }
+
+  constexpr
+  frozen_registry_query_iterator
+  operator++(int)
+  noexcept
+  {
+    frozen_registry_query_iterator tmp{*this};
+    ++*this;
+    return tmp;
+  }
+};
+
+
+template<
+    typename Frozen,
+    typename Expression>
+class frozen_registry_query
+{
+public:
+  using iterator = frozen_registry_query_iterator<Frozen, Expression>;
+
+private:
+  iterator m_begin;
+  iterator m_end;
+
+public:
+  constexpr
+  frozen_registry_query(Frozen const &registry, std::span<typename Frozen::identifier_type const> const range)
+  noexcept
+    : m_begin{registry, range.data()               , range.data() + range.size()}
+    , m_end  {registry, range.data() + range.size(), range.data() + range.size()}
+  { }
+
+  [[nodiscard]] constexpr
+  iterator
+  begin() const
+  noexcept
+  { return m_begin; }
+
+  [[nodiscard]] constexpr
+  iterator
+  end() const
+  noexcept
+  { return m_end; }
+
+  /*!
+   * \brief
+   *   Invokes the specified function on the handle of each matched entity.
+   */
+  template<std::invocable<typename Frozen::entity_type> F>
+  constexpr
+  void
+  each(F &&f) const
+  {
+    for (auto const e : *this)
+      f(e);
+  }
+};
+
+} // namespace detail
+
+
+template<
+    typename Registry,
+    auto     Extents>
+template<typename Expression>
+constexpr
+auto
+frozen_registry<Registry, Extents>::query() const
+noexcept
+{ return detail::frozen_registry_query<frozen_registry, Expression>{*this, m_query_range<Expression>()}; }
+
+
+namespace detail
+{
+template<typename Registry>
+[[nodiscard]] constexpr
+auto
+frozen_registry_extents_of(Registry const &registry)
+{
+  using component_sequence = typename Registry::component_sequence;
+
+  frozen_registry_extents<component_sequence::size> extents{};
+
+  for (auto const e : registry)
+  {
+    extents.enabled           += e.enabled();
+    extents.entity_index_bound = std::max<std::size_t>(
+        extents.entity_index_bound,
+        identifier_traits<typename Registry::identifier_type>::index(e.identifier()) + std::size_t{1});
+  }
+  extents.entities = registry.size();
+
+  [&]<typename ...Components>(type_sequence<Components ...>)
+  {
+    ((extents.sizes        [component_sequence::template index<Components>] = registry.template container<Components>().size(),
+      extents.enabled_sizes[component_sequence::template index<Components>] = registry.template container<Components>().enabled_size()), ...);
+
+    (std::ranges::for_each(registry.template container<Components>().identifiers(), [&](auto const id)
+    {
+      std::size_t &bound{extents.index_bounds[component_sequence::template index<Components>]};
+      bound = std::max<std::size_t>(bound, identifier_traits<typename Registry::identifier_type>::index(id) + std::size_t{1});
+    }), ...);
+  }(component_sequence{});
+
+  return extents;
+}
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   Freezes the registry returned by the specializing function, which is invoked in a constant
+ *   expression, into a \c frozen_registry .
+ *
+ * \details
+ *   The function is invoked twice: once to size the arrays of the frozen registry, then once to fill
+ *   them. Components must be literal types, default constructible and copy assignable. The result is
+ *   meant to initialize a \c constexpr variable, e.g.
+ *   \c inline constexpr auto catalog{heim::sparse::freeze<[]{ registry reg; ...; return reg; }>()}; ,
+ *   which is then constant-initialized without running any code at startup.
+ */
+template<auto Build>
+requires std::invocable<decltype(Build)>
+[[nodiscard]] consteval
+auto
+freeze()
+{
+  using registry_type = std::remove_cvref_t<std::invoke_result_t<decltype(Build)>>;
+
+  constexpr auto extents{detail::frozen_registry_extents_of(Build())};
+
+  frozen_registry<registry_type, extents> frozen{};
+  frozen.m_freeze(Build());
+  return frozen;
+}
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_FROZEN_REGISTRY_HPP
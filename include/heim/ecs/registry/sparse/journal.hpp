@@ -0,0 +1,510 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_JOURNAL_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_JOURNAL_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "heim/ecs/prefab.hpp"
+#include "heim/lib/spsc_ring.hpp"
+#include "heim/lib/type_sequence.hpp"
+#include "static_registry.hpp"
+
+namespace heim::sparse
+{
+/*!
+ * \brief
+ *   The structural operations recorded by a \c registry_journal .
+ */
+enum class journal_operation : std::uint8_t
+{
+  create,  // u32 count
+  destroy, // identifier
+  emplace, // u16 component, identifier, component bytes unless empty
+  erase,   // u16 component, identifier
+  assign,  // u16 component, identifier, component bytes
+  enable,  // identifier
+  disable  // identifier
+};
+
+
+namespace detail
+{
+inline constexpr std::uint64_t journal_magic = 0x314e524a4d494548; // "HEIMJRN1"
+
+// the header of a journal file, which must match the registry it is replayed on
+struct journal_header
+{
+  std::uint64_t magic;
+  std::uint32_t identifier_size;
+  std::uint32_t component_count;
+};
+
+// invokes the specified function specialized on the component of the specified index
+template<
+    typename ...Components,
+    typename    F>
+constexpr
+bool
+visit_journal_component(type_sequence<Components ...>, std::size_t const idx, F &&f)
+{
+  std::size_t i{};
+  return ((i++ == idx && (f.template operator()<Components>(), true)) || ...);
+}
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   A write-ahead journal of the structural operations made on a registry, recorded as a compact
+ *   binary log appended to a file.
+ *
+ * \details
+ *   Operations are made through the journal, which applies them to the registry then records them
+ *   into a lock-free ring. A background thread drains the ring into the file in batches, flushing it
+ *   every flush interval. The bytes of emplaced and assigned components are recorded, hence they must
+ *   be trivially copyable; other components and non-structural modifications are made on the registry
+ *   directly and are not recorded, nor are the actions of its scheduler. \n
+ *   The journal is meant to be replayed with \c replay_journal on a registry in the state the
+ *   journaled registry was in when the journal was opened (e.g. empty, or restored from the snapshot
+ *   taken then), which recreates the same identifiers. The calling thread waits for the background
+ *   thread when the ring is full.
+ */
+template<typename Registry>
+class registry_journal
+{
+public:
+  using registry_type   = Registry;
+  using identifier_type = typename registry_type::identifier_type;
+
+private:
+  using component_sequence = typename registry_type::component_sequence;
+
+  static constexpr std::size_t s_batch_size = 1 << 16;
+
+private:
+  registry_type            &m_registry;
+  std::FILE                *m_file;
+  spsc_ring                 m_ring;
+  std::atomic<std::size_t>  m_durable;
+  std::atomic<int>          m_error;
+  std::jthread              m_flusher;
+
+private:
+  template<typename Component>
+  static constexpr
+  auto
+  s_component_index
+  = static_cast<std::uint16_t>(component_sequence::template index<Component>);
+
+  void
+  m_write(std::span<std::byte const> bytes)
+  {
+    while (!bytes.empty())
+    {
+      std::size_t const n{m_ring.write_some(bytes)};
+
+      bytes = bytes.subspan(n);
+      if (n == 0)
+        std::this_thread::yield();
+    }
+  }
+
+  template<typename ...Fields>
+  void
+  m_record(journal_operation const op, Fields const &...fields)
+  {
+    std::array<std::byte, (sizeof(journal_operation) + ... + sizeof(Fields))> record;
+    std::size_t                                                                offset{};
+
+    std::memcpy(record.data(), &op, sizeof(op));
+    offset += sizeof(op);
+    ((std::memcpy(record.data() + offset, &fields, sizeof(Fields)), offset += sizeof(Fields)), ...);
+
+    m_write(record);
+  }
+
+  // drains the ring into the file until stopped, then drains it a last time
+  void
+  m_flush_loop(std::stop_token const stop, std::chrono::microseconds const interval)
+  {
+    std::vector<std::byte> batch(s_batch_size);
+
+    for (;;)
+    {
+      bool const stopping{stop.stop_requested()};
+
+      for (std::size_t n; (n = m_ring.read_some(batch)) != 0; )
+      {
+        if (std::fwrite(batch.data(), 1, n, m_file) != n)
+          m_error.store(errno != 0 ? errno : EIO, std::memory_order_relaxed);
+      }
+
+      std::size_t const read{m_ring.read()};
+
+      if (m_durable.load(std::memory_order_relaxed) != read)
+      {
+        if (std::fflush(m_file) != 0)
+          m_error.store(errno != 0 ? errno : EIO, std::memory_order_relaxed);
+
+        m_durable.store(read, std::memory_order_release);
+      }
+
+      if (stopping)
+        return;
+
+      std::this_thread::sleep_for(interval);
+    }
+  }
+
+public:
+  /*!
+   * \brief
+   *   Opens the journal of the specified registry in the file of the specified path, which is created
+   *   or truncated.
+   *
+   * \details
+   *   Throws \c std::system_error if the file cannot be opened.
+   */
+  registry_journal(
+      registry_type                  &registry,
+      char const * const              path,
+      std::size_t const               ring_capacity  = std::size_t{1} << 20,
+      std::chrono::microseconds const flush_interval = std::chrono::milliseconds{1})
+    : m_registry{registry}
+    , m_file    {std::fopen(path, "wb")}
+    , m_ring    {ring_capacity}
+    , m_durable {0}
+    , m_error   {0}
+    , m_flusher {}
+  {
+    if (m_file == nullptr)
+      throw std::system_error{errno, std::generic_category(), "heim::sparse::registry_journal: fopen"};
+
+    detail::journal_header const header{
+        detail::journal_magic,
+        sizeof(identifier_type),
+        static_cast<std::uint32_t>(component_sequence::size)};
+
+    m_write(std::as_bytes(std::span{&header, 1}));
+    m_flusher = std::jthread{[this, flush_interval](std::stop_token const stop) { m_flush_loop(stop, flush_interval); }};
+  }
+
+  registry_journal(registry_journal const &)
+  = delete;
+
+  registry_journal(registry_journal &&)
+  = delete;
+
+  ~registry_journal()
+  {
+    m_flusher.request_stop();
+    m_flusher.join();
+    std::fclose(m_file);
+  }
+
+  registry_journal &
+  operator=(registry_journal const &)
+  = delete;
+
+  registry_journal &
+  operator=(registry_journal &&)
+  = delete;
+
+  [[nodiscard]]
+  registry_type &
+  registry()
+  noexcept
+  { return m_registry; }
+
+  /*!
+   * \brief
+   *   Waits until every operation recorded so far is written to the file and flushed to the operating
+   *   system, hence survives a crash of the process.
+   *
+   * \details
+   *   Throws \c std::system_error if writing the file failed.
+   */
+  void
+  flush()
+  {
+    std::size_t const written{m_ring.written()};
+
+    while (m_durable.load(std::memory_order_acquire) < written)
+      std::this_thread::yield();
+
+    if (int const error{m_error.load(std::memory_order_relaxed)}; error != 0)
+      throw std::system_error{error, std::generic_category(), "heim::sparse::registry_journal: write"};
+  }
+
+
+  [[nodiscard]]
+  identifier_type
+  create()
+  {
+    identifier_type const id{m_registry.entity().identifier()};
+
+    m_record(journal_operation::create, std::uint32_t{1});
+    return id;
+  }
+
+  /*!
+   * \brief
+   *   Creates the specified number of identifiers at once, writes them to the specified output
+   *   iterator, and records them as a single operation.
+   */
+  template<std::weakly_incrementable Out>
+  requires std::indirectly_writable<Out, identifier_type const &>
+  Out
+  create(std::uint32_t const n, Out out)
+  {
+    out = m_registry.instantiate(prefab<>{}, n, std::move(out));
+
+    m_record(journal_operation::create, n);
+    return out;
+  }
+
+  bool
+  destroy(identifier_type const id)
+  {
+    if (!m_registry.destroy(id))
+      return false;
+
+    m_record(journal_operation::destroy, id);
+    return true;
+  }
+
+  template<
+      typename    Component,
+      typename ...Args>
+  requires std::is_trivially_copyable_v<Component>
+  void
+  emplace(identifier_type const id, Args &&...args)
+  {
+    m_registry.template emplace<Component>(id, std::forward<Args>(args)...);
+
+    if constexpr (std::is_empty_v<Component>)
+      m_record(journal_operation::emplace, s_component_index<Component>, id);
+    else
+      m_record(journal_operation::emplace, s_component_index<Component>, id, std::as_const(m_registry).template get<Component>(id));
+  }
+
+  template<typename Component>
+  void
+  erase(identifier_type const id)
+  {
+    m_registry.template erase<Component>(id);
+    m_record(journal_operation::erase, s_component_index<Component>, id);
+  }
+
+  /*!
+   * \brief
+   *   Assigns the specified value to the component of the specializing type of the specified
+   *   identifier, which must possess it.
+   */
+  template<typename Component>
+  requires (
+      std::is_trivially_copyable_v<Component>
+   && !std::is_empty_v<Component>)
+  void
+  assign(identifier_type const id, Component const &c)
+  {
+    m_registry.template get<Component>(id) = c;
+    m_record(journal_operation::assign, s_component_index<Component>, id, c);
+  }
+
+  void
+  enable(identifier_type const id)
+  {
+    m_registry.enable(id);
+    m_record(journal_operation::enable, id);
+  }
+
+  void
+  disable(identifier_type const id)
+  {
+    m_registry.disable(id);
+    m_record(journal_operation::disable, id);
+  }
+};
+
+
+/*!
+ * \brief
+ *   Replays the journal of the specified path on the specified registry, and returns the number of
+ *   operations replayed.
+ *
+ * \details
+ *   Consecutive creations are replayed at once through the bulk creation of the registry. A truncated
+ *   operation at the end of the journal, left by a crash while it was written, is ignored. \n
+ *   Throws \c std::system_error if the file cannot be read, and \c std::runtime_error if it is not a
+ *   journal of a registry of the same identifier type and number of components.
+ */
+template<typename Registry>
+std::size_t
+replay_journal(Registry &registry, char const * const path)
+{
+  using identifier_type    = typename Registry::identifier_type;
+  using component_sequence = typename Registry::component_sequence;
+
+  std::FILE *const file{std::fopen(path, "rb")};
+
+  if (file == nullptr)
+    throw std::system_error{errno, std::generic_category(), "heim::sparse::replay_journal: fopen"};
+
+  std::vector<std::byte> log;
+
+  for (std::array<std::byte, 1 << 16> chunk; ; )
+  {
+    std::size_t const n{std::fread(chunk.data(), 1, chunk.size(), file)};
+
+    log.insert(log.end(), chunk.begin(), chunk.begin() + static_cast<std::ptrdiff_t>(n));
+    if (n < chunk.size())
+      break;
+  }
+
+  bool const failed{std::ferror(file) != 0};
+
+  std::fclose(file);
+  if (failed)
+    throw std::system_error{EIO, std::generic_category(), "heim::sparse::replay_journal: fread"};
+
+  detail::journal_header header{};
+
+  if (log.size() < sizeof(header))
+    throw std::runtime_error{"heim::sparse::replay_journal: truncated header"};
+
+  std::memcpy(&header, log.data(), sizeof(header));
+
+  if (header.magic           != detail::journal_magic
+   || header.identifier_size != sizeof(identifier_type)
+   || header.component_count != component_sequence::size)
+    throw std::runtime_error{"heim::sparse::replay_journal: incompatible journal"};
+
+  std::size_t pos  {sizeof(header)};
+  std::size_t count{};
+
+  auto const read{[&log, &pos]<typename T>(T &value)
+  {
+    if (log.size() - pos < sizeof(T))
+      return false;
+
+    std::memcpy(&value, log.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+  }};
+
+  std::uint32_t                pending{};
+  std::vector<identifier_type> created;
+
+  // replays the pending creations at once
+  auto const create_pending{[&registry, &pending, &created]
+  {
+    if (pending == 0)
+      return;
+
+    created.clear();
+    registry.instantiate(prefab<>{}, pending, std::back_inserter(created));
+    pending = 0;
+  }};
+
+  for (journal_operation op; read(op); ++count)
+  {
+    if (op == journal_operation::create)
+    {
+      std::uint32_t n;
+
+      if (!read(n))
+        break;
+
+      pending += n;
+      continue;
+    }
+
+    create_pending();
+
+    std::uint16_t   component{};
+    identifier_type id;
+
+    bool const has_component{
+        op == journal_operation::emplace
+     || op == journal_operation::erase
+     || op == journal_operation::assign};
+
+    if ((has_component && !read(component)) || !read(id))
+      break;
+
+    if (has_component)
+    {
+      bool complete{true};
+
+      bool const known{detail::visit_journal_component(component_sequence{}, component, [&]<typename Component>()
+      {
+        if (op == journal_operation::erase)
+        {
+          registry.template erase<Component>(id);
+          return;
+        }
+
+        if constexpr (std::is_empty_v<Component>)
+        {
+          if (op == journal_operation::emplace)
+            registry.template emplace<Component>(id);
+        }
+        else if constexpr (std::is_trivially_copyable_v<Component>)
+        {
+          std::array<std::byte, sizeof(Component)> bytes;
+
+          if (!(complete = read(bytes)))
+            return;
+
+          auto const c{std::bit_cast<Component>(bytes)};
+
+          if (op == journal_operation::emplace)
+            registry.template emplace<Component>(id, c);
+          else
+            registry.template get<Component>(id) = c;
+        }
+      })};
+
+      if (!known)
+        throw std::runtime_error{"heim::sparse::replay_journal: unknown component"};
+
+      if (!complete)
+        break;
+
+      continue;
+    }
+
+    switch (op)
+    {
+    case journal_operation::destroy: registry.destroy(id); break;
+    case journal_operation::enable : registry.enable (id); break;
+    case journal_operation::disable: registry.disable(id); break;
+    default:
+      throw std::runtime_error{"heim::sparse::replay_journal: unknown operation"};
+    }
+  }
+
+  create_pending();
+  return count;
+}
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_JOURNAL_HPP
@@ -1,13 +1,19 @@
 #ifndef HEIM_ECS_REGISTRY_SPARSE_POOL_HPP
 #define HEIM_ECS_REGISTRY_SPARSE_POOL_HPP
 
+#include <algorithm>
+#include <array>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include "heim/ecs/identifier.hpp"
+#include "heim/lib/hash.hpp"
 #include "heim/lib/utility.hpp"
 #include "set.hpp"
 
@@ -32,6 +38,61 @@ concept component
 = is_component_v<T>;
 
 
+/*!
+ * \brief
+ *   Determines whether the modifications of the specializing component type are tracked by its pool.
+ *
+ * \details
+ *   Pools of tracked components version each of their dense pages, stamping the pages affected by
+ *   structural changes (insertions, removals and swaps) and the page of every component accessed
+ *   through a mutable reference, so that consumers of the dense arrays can safely skip the pages whose
+ *   version did not change. Pools of other components pay for no stamping: all their pages report
+ *   the structural version of the pool. \n
+ *   Users opt in by specializing this type for their component types.
+ */
+template<typename T>
+struct is_tracked_component
+  : std::false_type
+{ };
+
+template<typename T>
+inline constexpr
+bool
+is_tracked_component_v
+= is_tracked_component<T>::value;
+
+template<typename T>
+concept tracked_component
+= component<T> && is_tracked_component_v<T>;
+
+
+/*!
+ * \brief
+ *   The hash function applied by pools to their components, seeded with the digest of the identifier
+ *   possessing each component.
+ *
+ * \details
+ *   Hashes the object representation of components without padding bytes and of floating-point
+ *   components, see \c bytewise_hashable , since the padding bytes of equal components may differ
+ *   between peers. Users specialize this type for any other component type, typically hashing its
+ *   members with \c hash_values .
+ */
+template<typename T>
+struct component_hash
+{
+  [[nodiscard]]
+  std::uint64_t
+  operator()(T const &c, std::uint64_t const seed) const
+  noexcept
+  requires bytewise_hashable<T>
+  { return hash_bytes(std::addressof(c), sizeof(T), seed); }
+};
+
+template<typename T>
+concept hashable_component
+= component<T> && std::invocable<component_hash<T> const &, T const &, std::uint64_t>;
+
+
 /*!
  * \brief
  *   The main underlying container for identifiers and a specific component type.
@@ -75,11 +136,11 @@ template<
     typename    Allocator>
 requires (component<Component> && std::is_empty_v<Component>)
 class pool<Component, Identifier, PageSize, Allocator>
-  : public set<Identifier, PageSize, Allocator>
+  : public set<Identifier, PageSize, Allocator, is_tracked_component_v<Component>>
 {
 protected:
   using set_type
-  = set<Identifier, PageSize, Allocator>;
+  = set<Identifier, PageSize, Allocator, is_tracked_component_v<Component>>;
 
 public:
   using component_type  = Component;
@@ -93,9 +154,38 @@ public:
   static constexpr std::size_t page_size
   = PageSize;
 
+  static constexpr bool tracks_modifications
+  = true;
+
 public:
   using set_type::set_type;
-  using set_type::operator=;
+
+  constexpr
+  pool()
+  = default;
+
+  constexpr
+  pool(pool const &)
+  = default;
+
+  constexpr
+  pool(pool &&)
+  = default;
+
+  // explicitly defined so that it is usable in constant expressions
+  constexpr
+  ~pool() override
+  = default;
+
+  constexpr
+  pool &
+  operator=(pool const &)
+  = default;
+
+  constexpr
+  pool &
+  operator=(pool &&)
+  = default;
 };
 
 
@@ -202,6 +292,29 @@ public:
   noexcept
   { return m_container[idx]; }
 
+  [[nodiscard]] constexpr
+  std::span<component_type>
+  components()
+  noexcept
+  { return std::span<component_type>{m_container.data(), m_container.size()}; }
+
+  [[nodiscard]] constexpr
+  std::span<component_type const>
+  components() const
+  noexcept
+  { return std::span<component_type const>{m_container.data(), m_container.size()}; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  capacity() const
+  noexcept
+  { return m_container.capacity(); }
+
+  constexpr
+  void
+  reserve(std::size_t const n)
+  { m_container.reserve(n); }
+
 
   template<typename ...Args>
   requires std::constructible_from<component_type, Args &&...>
@@ -210,12 +323,23 @@ public:
   emplace_back(Args &&...args)
   { m_container.emplace_back(std::forward<Args>(args)...); }
 
+  constexpr
+  void
+  append(std::size_t const n, component_type const &c)
+  { m_container.insert(m_container.end(), n, c); }
+
   constexpr
   void
   pop_back()
   noexcept
   { m_container.pop_back(); }
 
+  constexpr
+  void
+  pop_back(std::size_t const n)
+  noexcept
+  { m_container.erase(m_container.end() - static_cast<std::ptrdiff_t>(n), m_container.end()); }
+
   constexpr
   void
   overwrite_with_back(std::size_t const idx)
@@ -255,16 +379,17 @@ template<
 requires (component<Component> && !std::is_empty_v<Component>)
 class pool<Component, Identifier, PageSize, Allocator>
   : protected detail::pool_component_container<Component, Allocator>
-  , protected set<Identifier, PageSize, Allocator>
+  , protected set<Identifier, PageSize, Allocator, is_tracked_component_v<Component>>
 {
 protected:
   using component_container = detail::pool_component_container<Component, Allocator>;
-  using set_type            = set<Identifier, PageSize, Allocator>;
+  using set_type            = set<Identifier, PageSize, Allocator, is_tracked_component_v<Component>>;
 
 public:
   using component_type  = Component;
   using identifier_type = Identifier;
   using allocator_type  = Allocator;
+  using version_type    = typename set_type::version_type;
 
   static_assert(
       is_component_v<Component>,
@@ -273,6 +398,12 @@ public:
   static constexpr std::size_t page_size
   = PageSize;
 
+  static constexpr std::size_t dense_page_size
+  = set_type::dense_page_size;
+
+  static constexpr bool tracks_modifications
+  = is_tracked_component_v<Component>;
+
 private:
   using id_traits
   = identifier_traits<identifier_type>;
@@ -313,6 +444,31 @@ private:
   noexcept
   { return noexcept(std::declval<component_container &>().overwrite_with_back(std::declval<std::size_t>())); }
 
+  static constexpr std::size_t s_batch_size
+  = 16;
+
+  // resolves the dense positions of the specified identifiers, at most a batch of them, prefetching
+  // all of their sparse positions before loading any, then all of their components
+  constexpr
+  void
+  m_resolve(std::span<identifier_type const> const ids, std::array<std::size_t, s_batch_size> &idxs) const
+  noexcept
+  {
+    for (identifier_type const id : ids)
+      set_type::sparse_container::prefetch(id);
+
+    for (std::size_t i{}; i < ids.size(); ++i)
+    {
+      idxs[i] = static_cast<std::size_t>(id_traits::index(set_type::sparse_container::position(ids[i])));
+      heim::prefetch(std::addressof(component_container::get(idxs[i])));
+    }
+  }
+
+  [[nodiscard]]
+  std::uint64_t
+  m_digest(std::size_t const idx) const
+  { return component_hash<component_type>{}(component_container::get(idx), set_type::m_identifier_digest(idx)); }
+
 public:
   explicit constexpr
   pool(allocator_type const &alloc)
@@ -420,6 +576,15 @@ public:
   using set_type::contains;
   using set_type::iterator_to;
   using set_type::find;
+  using set_type::identifiers;
+  using set_type::enabled_end;
+  using set_type::enabled_size;
+  using set_type::enabled;
+
+  using set_type::version;
+  using set_type::structural_version;
+  using set_type::page_count;
+  using set_type::page_version;
 
   [[nodiscard]] constexpr
   decltype(auto)
@@ -427,6 +592,10 @@ public:
   noexcept
   {
     auto const idx{static_cast<std::size_t>(id_traits::index(set_type::sparse_container::position(id)))};
+
+    if constexpr (tracks_modifications)
+      set_type::dense_container::touch(idx);
+
     return component_container::get(idx);
   }
 
@@ -439,6 +608,179 @@ public:
     return component_container::get(idx);
   }
 
+  /*!
+   * \brief
+   *   Returns the components of the pool in their dense order, which matches the order of
+   *   \c identifiers() .
+   */
+  [[nodiscard]] constexpr
+  std::span<component_type>
+  components()
+  noexcept
+  {
+    if constexpr (tracks_modifications)
+      set_type::dense_container::touch_all();
+
+    return component_container::components();
+  }
+
+  [[nodiscard]] constexpr
+  std::span<component_type const>
+  components() const
+  noexcept
+  { return component_container::components(); }
+
+  /*!
+   * \brief
+   *   Returns a digest of the identifiers of the pool, of whether they are enabled and of their
+   *   components, which does not depend on their order.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  hash() const
+  requires hashable_component<component_type>
+  { return set_type::m_hash([this](std::size_t const idx) { return m_digest(idx); }, nullptr); }
+
+  /*!
+   * \brief
+   *   Returns the same digest as \c hash() , only rehashing the dense pages that changed since the
+   *   specified cache was last used.
+   *
+   * \note
+   *   Components modified through mutable references only stamp their page for tracked components,
+   *   hence pools of other components, the default, rehash every page, see \c is_tracked_component .
+   */
+  [[nodiscard]]
+  std::uint64_t
+  hash(page_hash_cache &cache) const
+  requires hashable_component<component_type>
+  {
+    if constexpr (tracks_modifications)
+      return set_type::m_hash([this](std::size_t const idx) { return m_digest(idx); }, &cache);
+    else
+      return hash();
+  }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  capacity() const
+  noexcept
+  { return std::min(component_container::capacity(), set_type::capacity()); }
+
+  /*!
+   * \brief
+   *   Reserves storage for the specified number of identifiers and their components.
+   */
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    component_container::reserve(n);
+    set_type           ::reserve(n);
+  }
+
+  using set_type::reserve_sparse;
+
+  /*!
+   * \brief
+   *   Copies the components of the specified identifiers, which must all be contained, into the
+   *   specified buffer in the same order.
+   *
+   * \details
+   *   Identifiers are resolved in batches, whose sparse positions and components are prefetched before
+   *   any of them is loaded, so that the two dependent loads of each component overlap with those of
+   *   the others. Throws \c std::out_of_range , copying nothing, if the buffer is smaller than the
+   *   identifiers.
+   */
+  constexpr
+  void
+  gather(std::span<identifier_type const> const ids, std::span<component_type> const out) const
+  {
+    if (out.size() < ids.size())
+      throw std::out_of_range{"heim::sparse::pool::gather: the buffer is smaller than the identifiers"};
+
+    std::array<std::size_t, s_batch_size> idxs{};
+
+    for (std::size_t first{}; first < ids.size(); first += s_batch_size)
+    {
+      auto const batch{ids.subspan(first, std::min(s_batch_size, ids.size() - first))};
+
+      m_resolve(batch, idxs);
+      for (std::size_t i{}; i < batch.size(); ++i)
+        out[first + i] = component_container::get(idxs[i]);
+    }
+  }
+
+  /*!
+   * \brief
+   *   Copies the components of the specified buffer to the specified identifiers in the same order,
+   *   which must all be contained.
+   *
+   * \details
+   *   Resolves the identifiers in batches as \c gather does. Throws \c std::out_of_range , copying
+   *   nothing, if the buffer is smaller than the identifiers.
+   */
+  constexpr
+  void
+  scatter(std::span<identifier_type const> const ids, std::span<component_type const> const in)
+  {
+    if (in.size() < ids.size())
+      throw std::out_of_range{"heim::sparse::pool::scatter: the buffer is smaller than the identifiers"};
+
+    std::array<std::size_t, s_batch_size> idxs{};
+
+    for (std::size_t first{}; first < ids.size(); first += s_batch_size)
+    {
+      auto const batch{ids.subspan(first, std::min(s_batch_size, ids.size() - first))};
+
+      m_resolve(batch, idxs);
+      for (std::size_t i{}; i < batch.size(); ++i)
+      {
+        component_container::get(idxs[i]) = in[first + i];
+
+        if constexpr (tracks_modifications)
+          set_type::dense_container::touch(idxs[i]);
+      }
+    }
+  }
+
+  /*!
+   * \brief
+   *   Returns the position of the specified identifier, which must be contained, in the dense arrays
+   *   of the pool.
+   */
+  [[nodiscard]] constexpr
+  std::size_t
+  index_of(identifier_type const id) const
+  noexcept
+  { return static_cast<std::size_t>(id_traits::index(set_type::sparse_container::position(id))); }
+
+  /*!
+   * \brief
+   *   Moves the components of the specified buffer to the specified positions in the dense arrays of
+   *   the pool, in the same order.
+   *
+   * \details
+   *   Is the counterpart of \c scatter for callers that already resolved the positions of their
+   *   identifiers, e.g. while iterating them. Throws \c std::out_of_range , moving nothing, if the
+   *   buffer is smaller than the positions.
+   */
+  constexpr
+  void
+  scatter_at(std::span<std::size_t const> const idxs, std::span<component_type> const in)
+  {
+    if (in.size() < idxs.size())
+      throw std::out_of_range{"heim::sparse::pool::scatter_at: the buffer is smaller than the positions"};
+
+    for (std::size_t i{}; i < idxs.size(); ++i)
+    {
+      component_container::get(idxs[i]) = std::move(in[i]);
+
+      if constexpr (tracks_modifications)
+        set_type::dense_container::touch(idxs[i]);
+    }
+  }
+
   template<typename ...Args>
   constexpr
   void
@@ -471,6 +813,34 @@ public:
     return true;
   }
 
+  /*!
+   * \brief
+   *   Inserts the specified identifiers at once, none of which must already be contained, each with a
+   *   copy of the specified component.
+   */
+  constexpr
+  void
+  append(std::span<identifier_type const> const ids, component_type const &c)
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+    for (identifier_type const id : ids)
+      set_type::sparse_container::reserve_for(id);
+
+    auto idx{static_cast<index_type>(size())};
+
+    component_container::append(ids.size(), c);
+    // strong exception safety guarantee
+    try
+    { set_type::dense_container::append(ids); }
+    catch (...)
+    { component_container::pop_back(ids.size()); throw; }
+
+    for (identifier_type const id : ids)
+      set_type::sparse_container::position(id) = id_traits::from(idx++, id_traits::generation(id));
+  }
+
   constexpr
   bool
   insert(identifier_type const id, component_type const &c)
@@ -504,6 +874,36 @@ public:
   }
 
 
+  /*!
+   * \brief
+   *   Moves the specified identifier and its component to the range of enabled identifiers.
+   */
+  constexpr
+  void
+  enable(identifier_type const id)
+  {
+    if (enabled(id))
+      return;
+
+    swap(id, identifiers()[set_type::m_disabled - 1]);
+    --set_type::m_disabled;
+  }
+
+  /*!
+   * \brief
+   *   Moves the specified identifier and its component to the range of disabled identifiers.
+   */
+  constexpr
+  void
+  disable(identifier_type const id)
+  {
+    if (!enabled(id))
+      return;
+
+    swap(id, identifiers()[set_type::m_disabled]);
+    ++set_type::m_disabled;
+  }
+
   constexpr
   void
   erase(identifier_type const id) override
@@ -511,6 +911,8 @@ public:
     using index_type
     = typename id_traits::index_type;
 
+    enable(id);
+
     if (auto const idx{static_cast<std::size_t>(id_traits::index(set_type::sparse_container::position(id)))};
         idx != size() - 1)
     {
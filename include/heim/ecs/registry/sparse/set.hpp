@@ -3,13 +3,24 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <new>
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include "heim/ecs/identifier.hpp"
+#include "heim/lib/hash.hpp"
 #include "heim/lib/unique_allocator_aware_ptr.hpp"
+#include "heim/lib/utility.hpp"
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#endif
 
 namespace heim::sparse
 {
@@ -37,6 +48,75 @@ default_page_size_v
 = default_page_size<>::value;
 
 
+/*!
+ * \brief
+ *   Determines the page size that makes the sparse container of sets and pools a single reservation
+ *   of virtual memory spanning every index of their identifiers.
+ *
+ * \details
+ *   Positions are then found with a single load, without the indirection through a page nor the
+ *   bound check of the other modes, while the kernel only commits the pages of the reservation that
+ *   are written to. Is only available where anonymous mappings are, and reserves, without committing
+ *   it, 32 GiB of address space per container of 64-bit identifiers. \n
+ *   Where that reservation is refused, e.g. under a limit of the address space or with overcommit
+ *   disabled, the container maps the positions of the indices it holds only, maps them anew with
+ *   twice as many positions whenever a higher index is reserved, and checks the indices it looks up
+ *   against them.
+ */
+template<typename = void>
+struct reserved_page_size
+  : std::integral_constant<std::size_t, std::numeric_limits<std::size_t>::max()>
+{ };
+
+template<typename = void>
+inline constexpr
+std::size_t
+reserved_page_size_v
+= reserved_page_size<>::value;
+
+
+/*!
+ * \brief
+ *   Determines the size of the pages in which the dense container of sets and pools is versioned.
+ *
+ * \details
+ *   Each modification of a position of the dense container stamps the page containing that position
+ *   with a new version, so that consumers of the dense arrays (snapshots, digests, ...) can process
+ *   only the pages that changed since they last observed the container.
+ */
+template<typename = void>
+struct default_dense_page_size
+  : std::integral_constant<std::size_t, 1024>
+{ };
+
+template<typename = void>
+inline constexpr
+std::size_t
+default_dense_page_size_v
+= default_dense_page_size<>::value;
+
+
+/*!
+ * \brief
+ *   The digests of the dense pages of a set or pool, reused by its later hashes for the pages that did
+ *   not change in between.
+ *
+ * \note
+ *   A cache must only be used with a single container.
+ */
+struct page_hash_cache
+{
+  struct page_digest
+  {
+    std::uint64_t version;
+    std::size_t   size;
+    std::uint64_t digest;
+  };
+
+  std::vector<page_digest> pages;
+};
+
+
 namespace detail
 {
 template<
@@ -100,6 +180,14 @@ private:
   noexcept
   { return std::is_nothrow_swappable_v<container_type>; }
 
+  // a page pointer owning no page, whose deleter holds the allocator of the container so that
+  // stateful allocators need not be default constructible
+  [[nodiscard]] constexpr
+  page_pointer
+  m_null_page() const
+  noexcept
+  { return page_pointer{nullptr, typename page_pointer::deleter_type{page_allocator(m_container.get_allocator())}}; }
+
   static constexpr
   std::size_t
   s_page_index(std::size_t const idx)
@@ -123,7 +211,7 @@ private:
       if (ptr)
         m_container.emplace_back(make_unique_allocator_aware<page>(page_allocator{m_container.get_allocator()}, *ptr));
       else
-        m_container.emplace_back(page_pointer{});
+        m_container.emplace_back(m_null_page());
     }
   }
 
@@ -226,7 +314,15 @@ public:
   void
   swap(identifier_type const lhs, identifier_type const rhs)
   noexcept
-  { using std::swap; swap(position(lhs), position(rhs)); }
+  {
+    identifier_type &lhs_pos{position(lhs)};
+    identifier_type &rhs_pos{position(rhs)};
+    auto const       lhs_idx{id_traits::index(lhs_pos)};
+
+    // only the indexes are swapped, as each position keeps the generation of its identifier
+    lhs_pos = id_traits::from(id_traits::index(rhs_pos), id_traits::generation(lhs_pos));
+    rhs_pos = id_traits::from(lhs_idx                  , id_traits::generation(rhs_pos));
+  }
 
   [[nodiscard]] constexpr
   bool
@@ -283,6 +379,20 @@ public:
       return m_container[idx];
   }
 
+  // prefetches the position of the specified identifier, which must be reserved
+  constexpr
+  void
+  prefetch(identifier_type const id) const
+  noexcept
+  {
+    auto const idx{static_cast<std::size_t>(id_traits::index(id))};
+
+    if constexpr (is_paged)
+      heim::prefetch(m_container[s_page_index(idx)]->data() + s_line_index(idx));
+    else
+      heim::prefetch(m_container.data() + idx);
+  }
+
   constexpr
   void
   reserve_for(identifier_type const id)
@@ -297,7 +407,7 @@ public:
         m_container.reserve(pg_idx + 1);
 
       while (pg_idx >= m_container.size())
-        m_container.emplace_back(page_pointer{});
+        m_container.emplace_back(m_null_page());
 
       if (page_pointer &ptr{m_container[pg_idx]};
           !ptr)
@@ -312,12 +422,371 @@ public:
         m_container.resize(idx + 1, id_traits::null);
     }
   }
+
+  // allocates the positions of every identifier whose index is lower than the specified number
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    if (n == 0)
+      return;
+
+    if constexpr (is_paged)
+    {
+      std::size_t const pages{s_page_index(n - 1) + 1};
+
+      if (pages > m_container.size())
+        m_container.reserve(pages);
+
+      while (pages > m_container.size())
+        m_container.emplace_back(m_null_page());
+
+      for (std::size_t pg_idx{}; pg_idx < pages; ++pg_idx)
+      {
+        if (page_pointer &ptr{m_container[pg_idx]};
+            !ptr)
+        {
+          ptr = make_unique_allocator_aware<page>(page_allocator(m_container.get_allocator()));
+          ptr ->fill(id_traits::null);
+        }
+      }
+    }
+    else
+    {
+      if (n > m_container.size())
+        m_container.resize(n, id_traits::null);
+    }
+  }
 };
 
 
+#if __has_include(<sys/mman.h>)
+/*!
+ * \brief
+ *   The sparse container of sets and pools of the reserved page size, whose positions are stored in
+ *   a single anonymous mapping spanning every index of their identifiers.
+ *
+ * \details
+ *   The mapping is reserved with \c MAP_NORESERVE when the first position is, and the kernel commits
+ *   its pages as they are first written. Positions are stored complemented, so that the pages that
+ *   were never written, which read as zeros, hold null positions. The container tracks the highest
+ *   index it reserved, below which it copies its positions and above which it has written none, and
+ *   clearing it releases the pages below that index with \c MADV_DONTNEED . Where the kernel refuses to
+ *   reserve every index, the mapping only spans the reserved indices rounded up to a power of two, and
+ *   is replaced by one twice as large, into which the positions are copied, once it is exceeded. \n
+ *   The allocator is not used for the positions, and is kept for the interface of the container
+ *   only.
+ */
+template<
+    typename Identifier,
+    typename Allocator>
+requires (
+    identifier   <Identifier>
+ && allocator_for<Allocator, Identifier>)
+class set_sparse_container<Identifier, reserved_page_size_v<>, Allocator>
+{
+public:
+  using identifier_type = Identifier;
+  using allocator_type  = Allocator;
+
+  static constexpr std::size_t page_size = reserved_page_size_v<>;
+  static constexpr bool        is_paged  = false;
+
+private:
+  using id_traits = identifier_traits<identifier_type>;
+
+  static_assert(
+      static_cast<std::size_t>(id_traits::index_mask) < std::numeric_limits<std::size_t>::max() / sizeof(identifier_type),
+      "heim::sparse::detail::set_sparse_container: the indexes must fit in the address space;");
+
+  static constexpr std::size_t s_capacity
+  = static_cast<std::size_t>(id_traits::index_mask) + 1;
+
+  // the fewest positions mapped when every index cannot be reserved, a page of 64-bit identifiers
+  static constexpr std::size_t s_min_capacity
+  = std::min<std::size_t>(512, s_capacity);
+
+public:
+  // a position in the mapping, read and written through its complement
+  class reference
+  {
+  private:
+    identifier_type *m_ptr;
+
+  public:
+    explicit constexpr
+    reference(identifier_type * const ptr)
+    noexcept
+      : m_ptr{ptr}
+    { }
+
+    constexpr
+    reference(reference const &)
+    = default;
+
+    constexpr
+    reference &
+    operator=(reference const &other)
+    noexcept
+    { return *this = static_cast<identifier_type>(other); }
+
+    constexpr
+    reference &
+    operator=(identifier_type const pos)
+    noexcept
+    {
+      *m_ptr = static_cast<identifier_type>(pos ^ id_traits::null);
+      return *this;
+    }
+
+    [[nodiscard]] constexpr
+    operator identifier_type() const
+    noexcept
+    { return static_cast<identifier_type>(*m_ptr ^ id_traits::null); }
+  };
+
+private:
+  identifier_type *m_base;
+  std::size_t      m_size;
+  std::size_t      m_capacity;
+
+private:
+  // maps the positions of at least the specified number of indices, reserving every index first and
+  // falling back to a mapping of the specified ones, rounded up to a power of two, if that is refused
+  void
+  m_map(std::size_t const n)
+  {
+    if (n <= m_capacity)
+      return;
+
+    int const flags{MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE};
+
+    if (!m_base)
+    {
+      void * const mapping{::mmap(nullptr, s_capacity * sizeof(identifier_type), PROT_READ | PROT_WRITE, flags, -1, 0)};
+
+      if (mapping != MAP_FAILED)
+      {
+        m_base     = static_cast<identifier_type *>(mapping);
+        m_capacity = s_capacity;
+        return;
+      }
+    }
+
+    std::size_t const capacity{std::min(std::bit_ceil(std::max(n, s_min_capacity)), s_capacity)};
+    void      * const mapping {::mmap(nullptr, capacity * sizeof(identifier_type), PROT_READ | PROT_WRITE, flags, -1, 0)};
+
+    if (mapping == MAP_FAILED)
+      throw std::bad_alloc{};
+
+    // no position was written above the size, hence the rest of the new mapping is already null
+    if (m_base)
+    {
+      std::memcpy(mapping, m_base, m_size * sizeof(identifier_type));
+      ::munmap(m_base, m_capacity * sizeof(identifier_type));
+    }
+    m_base     = static_cast<identifier_type *>(mapping);
+    m_capacity = capacity;
+  }
+
+  // copies the written positions only, so that the pages the other container did not commit are not
+  // committed either
+  void
+  m_copy(set_sparse_container const &other)
+  {
+    if (other.m_size == 0)
+      return;
+
+    m_map(other.m_size);
+    for (std::size_t idx{}; idx < other.m_size; ++idx)
+    {
+      if (other.m_base[idx] != identifier_type{})
+        m_base[idx] = other.m_base[idx];
+    }
+    m_size = other.m_size;
+  }
+
+public:
+  explicit constexpr
+  set_sparse_container(allocator_type const &)
+  noexcept
+    : m_base    {}
+    , m_size    {}
+    , m_capacity{}
+  { }
+
+  set_sparse_container(set_sparse_container const &other, allocator_type const &)
+    : m_base    {}
+    , m_size    {}
+    , m_capacity{}
+  { m_copy(other); }
+
+  set_sparse_container(set_sparse_container const &other)
+    : m_base    {}
+    , m_size    {}
+    , m_capacity{}
+  { m_copy(other); }
+
+  constexpr
+  set_sparse_container(set_sparse_container &&other, allocator_type const &)
+  noexcept
+    : m_base    {std::exchange(other.m_base, nullptr)}
+    , m_size    {std::exchange(other.m_size, 0)}
+    , m_capacity{std::exchange(other.m_capacity, 0)}
+  { }
+
+  constexpr
+  set_sparse_container(set_sparse_container &&other)
+  noexcept
+    : m_base    {std::exchange(other.m_base, nullptr)}
+    , m_size    {std::exchange(other.m_size, 0)}
+    , m_capacity{std::exchange(other.m_capacity, 0)}
+  { }
+
+  constexpr
+  ~set_sparse_container()
+  {
+    if !consteval
+    {
+      if (m_base)
+        ::munmap(m_base, m_capacity * sizeof(identifier_type));
+    }
+  }
+
+  set_sparse_container &
+  operator=(set_sparse_container const &other)
+  {
+    if (this == std::addressof(other))
+      return *this;
+
+    clear();
+    m_copy(other);
+    return *this;
+  }
+
+  constexpr
+  set_sparse_container &
+  operator=(set_sparse_container &&other)
+  noexcept
+  {
+    set_sparse_container tmp{std::move(other)};
+
+    swap(tmp);
+    return *this;
+  }
+
+  constexpr
+  void
+  swap(set_sparse_container &other)
+  noexcept
+  {
+    std::swap(m_base    , other.m_base);
+    std::swap(m_size    , other.m_size);
+    std::swap(m_capacity, other.m_capacity);
+  }
+
+  friend constexpr
+  void
+  swap(set_sparse_container &lhs, set_sparse_container &rhs)
+  noexcept
+  { lhs.swap(rhs); }
+
+  constexpr
+  void
+  swap(identifier_type const lhs, identifier_type const rhs)
+  noexcept
+  {
+    reference             lhs_ref{position(lhs)};
+    reference             rhs_ref{position(rhs)};
+    identifier_type const lhs_pos{lhs_ref};
+    identifier_type const rhs_pos{rhs_ref};
+
+    lhs_ref = id_traits::from(id_traits::index(rhs_pos), id_traits::generation(lhs_pos));
+    rhs_ref = id_traits::from(id_traits::index(lhs_pos), id_traits::generation(rhs_pos));
+  }
+
+  [[nodiscard]] constexpr
+  bool
+  contains(identifier_type const id) const
+  noexcept
+  {
+    auto const idx{static_cast<std::size_t>(id_traits::index(id))};
+
+    // every index is mapped once the whole reservation succeeded, where a position that was never
+    // written, or was nulled, reads as zero, which rules out the null identifier as well
+    if (m_capacity == s_capacity)
+    {
+      identifier_type const stored{m_base[idx]};
+
+      return stored != identifier_type{}
+          && id_traits::generation(static_cast<identifier_type>(stored ^ id_traits::null)) == id_traits::generation(id);
+    }
+
+    return idx < m_size
+        && id_traits::generation(position(id)) == id_traits::generation(id);
+  }
+
+  [[nodiscard]] constexpr
+  reference
+  position(identifier_type const id)
+  noexcept
+  { return reference{m_base + static_cast<std::size_t>(id_traits::index(id))}; }
+
+  [[nodiscard]] constexpr
+  identifier_type
+  position(identifier_type const id) const
+  noexcept
+  { return static_cast<identifier_type>(m_base[static_cast<std::size_t>(id_traits::index(id))] ^ id_traits::null); }
+
+  // prefetches the position of the specified identifier, which must be reserved
+  constexpr
+  void
+  prefetch(identifier_type const id) const
+  noexcept
+  { heim::prefetch(m_base + static_cast<std::size_t>(id_traits::index(id))); }
+
+  void
+  reserve_for(identifier_type const id)
+  {
+    std::size_t const n{static_cast<std::size_t>(id_traits::index(id)) + 1};
+
+    m_map(n);
+    m_size = std::max(m_size, n);
+  }
+
+  // reserves the positions of every identifier whose index is lower than the specified number, which
+  // the kernel commits as they are written
+  void
+  reserve(std::size_t const n)
+  {
+    if (n == 0)
+      return;
+
+    m_map(n);
+    m_size = std::max(m_size, n);
+  }
+
+  // nulls every position and releases the pages holding them
+  void
+  clear()
+  noexcept
+  {
+    if (m_size == 0)
+      return;
+
+    ::madvise(m_base, m_size * sizeof(identifier_type), MADV_DONTNEED);
+    m_size = 0;
+  }
+};
+#endif
+
+
+// the dense container of sets and pools, whose pages are versioned individually when Versioned is
+// true, and otherwise all share the structural version of the container
 template<
     typename Identifier = default_identifier_t<>,
-    typename Allocator  = std::allocator<Identifier>>
+    typename Allocator  = std::allocator<Identifier>,
+    bool     Versioned  = false>
 requires (
     identifier   <Identifier>
  && allocator_for<Allocator, Identifier>)
@@ -326,13 +795,26 @@ class set_dense_container
 public:
   using identifier_type = Identifier;
   using allocator_type  = Allocator;
+  using version_type    = std::uint64_t;
+
+  static constexpr std::size_t dense_page_size
+  = default_dense_page_size_v<>;
+
+  static constexpr bool versions_pages
+  = Versioned;
 
 private:
   using container_type
   = std::vector<identifier_type, allocator_type>;
 
+  using version_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<version_type>;
+  using version_container = std::vector<version_type, version_allocator>;
+
 private:
-  container_type m_container;
+  container_type    m_container;
+  version_container m_versions;
+  version_type      m_version;
+  version_type      m_structure;
 
 private:
   static constexpr
@@ -340,27 +822,46 @@ private:
   s_noexcept_move_alloc_construct()
   noexcept
   {
-    return std::is_nothrow_constructible_v<
-        container_type,
-        container_type &&, allocator_type const &>;
+    return
+        std::is_nothrow_constructible_v<
+            container_type,
+            container_type    &&, allocator_type const &>
+     && std::is_nothrow_constructible_v<
+            version_container,
+            version_container &&, version_allocator const &>;
   }
 
   static constexpr
   bool
   s_noexcept_swap()
   noexcept
-  { return std::is_nothrow_swappable_v<container_type>; }
+  {
+    return std::is_nothrow_swappable_v<container_type>
+        && std::is_nothrow_swappable_v<version_container>;
+  }
+
+  static constexpr
+  std::size_t
+  s_page_index(std::size_t const idx)
+  noexcept
+  { return idx / dense_page_size; }
 
 public:
   explicit constexpr
   set_dense_container(allocator_type const &alloc)
   noexcept
     : m_container{alloc}
+    , m_versions {version_allocator{alloc}}
+    , m_version  {}
+    , m_structure{}
   { }
 
   constexpr
   set_dense_container(set_dense_container const &other, allocator_type const &alloc)
     : m_container{other.m_container, alloc}
+    , m_versions {other.m_versions , version_allocator{alloc}}
+    , m_version  {other.m_version}
+    , m_structure{other.m_structure}
   { }
 
   constexpr
@@ -369,7 +870,11 @@ public:
 
   constexpr
   set_dense_container(set_dense_container &&other, allocator_type const &alloc)
+  noexcept(s_noexcept_move_alloc_construct())
     : m_container{std::move(other.m_container), alloc}
+    , m_versions {std::move(other.m_versions) , version_allocator{alloc}}
+    , m_version  {other.m_version}
+    , m_structure{other.m_structure}
   { }
 
   constexpr
@@ -394,7 +899,14 @@ public:
   void
   swap(set_dense_container &other)
   noexcept(s_noexcept_swap())
-  { m_container.swap(other.m_container); }
+  {
+    using std::swap;
+
+    m_container.swap(other.m_container);
+    m_versions .swap(other.m_versions);
+    swap(m_version  , other.m_version);
+    swap(m_structure, other.m_structure);
+  }
 
   friend constexpr
   void
@@ -406,7 +918,14 @@ public:
   void
   swap(std::size_t const lhs, std::size_t const rhs)
   noexcept
-  { using std::swap; swap(m_container[lhs], m_container[rhs]); }
+  {
+    using std::swap;
+
+    swap(m_container[lhs], m_container[rhs]);
+    touch(lhs);
+    touch(rhs);
+    ++m_structure;
+  }
 
   [[nodiscard]] constexpr
   allocator_type
@@ -463,35 +982,193 @@ public:
   noexcept
   { return m_container.empty(); }
 
+  [[nodiscard]] constexpr
+  std::size_t
+  capacity() const
+  noexcept
+  { return m_container.capacity(); }
+
   [[nodiscard]] constexpr
   identifier_type
   back() const
   noexcept
   { return m_container.back(); }
 
+  /*!
+   * \brief
+   *   Returns the identifiers of the container in their dense order, which is the reverse of the
+   *   iteration order.
+   */
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return std::span<identifier_type const>{m_container.data(), m_container.size()}; }
+
+
+  [[nodiscard]] constexpr
+  version_type
+  version() const
+  noexcept
+  {
+    if constexpr (versions_pages)
+      return m_version;
+    else
+      return m_structure;
+  }
+
+  /*!
+   * \brief
+   *   Returns the version of the order of the identifiers, which changes on every insertion, removal or
+   *   swap, but not when the pages are only touched.
+   */
+  [[nodiscard]] constexpr
+  version_type
+  structural_version() const
+  noexcept
+  { return m_structure; }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  page_count() const
+  noexcept
+  {
+    if constexpr (versions_pages)
+      return m_versions.size();
+    else
+      return (m_container.size() + dense_page_size - 1) / dense_page_size;
+  }
+
+  [[nodiscard]] constexpr
+  version_type
+  page_version([[maybe_unused]] std::size_t const pg_idx) const
+  noexcept
+  {
+    if constexpr (versions_pages)
+      return m_versions[pg_idx];
+    else
+      return m_structure;
+  }
+
+  constexpr
+  void
+  touch([[maybe_unused]] std::size_t const idx)
+  noexcept
+  {
+    if constexpr (versions_pages)
+      m_versions[s_page_index(idx)] = ++m_version;
+  }
+
+  constexpr
+  void
+  touch_all()
+  noexcept
+  {
+    if constexpr (versions_pages)
+    {
+      ++m_version;
+      for (version_type &version : m_versions)
+        version = m_version;
+    }
+  }
+
 
   constexpr
   void
   insert(identifier_type const id)
-  { m_container.emplace_back(id); }
+  {
+    m_container.emplace_back(id);
+
+    if constexpr (versions_pages)
+    {
+      if (std::size_t const idx{m_container.size() - 1};
+          s_page_index(idx) == m_versions.size())
+      {
+        // strong exception safety guarantee
+        try
+        { m_versions.emplace_back(); }
+        catch (...)
+        { m_container.pop_back(); throw; }
+      }
+
+      touch(m_container.size() - 1);
+    }
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  append(std::span<identifier_type const> const ids)
+  {
+    if (ids.empty())
+      return;
+
+    if constexpr (versions_pages)
+    {
+      std::size_t const first{m_container.size()};
+      std::size_t const pages{s_page_index(first + ids.size() - 1) + 1};
+
+      // strong exception safety guarantee, as nothing may throw once the versions are reserved
+      m_versions .reserve(pages);
+      m_container.insert(m_container.end(), ids.begin(), ids.end());
+      m_versions .resize(pages);
+
+      ++m_version;
+      for (std::size_t pg_idx{s_page_index(first)}; pg_idx < pages; ++pg_idx)
+        m_versions[pg_idx] = m_version;
+    }
+    else
+      m_container.insert(m_container.end(), ids.begin(), ids.end());
+
+    ++m_structure;
+  }
+
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    if (n == 0)
+      return;
+
+    m_container.reserve(n);
+    if constexpr (versions_pages)
+      m_versions.reserve(s_page_index(n - 1) + 1);
+  }
 
   constexpr
   void
   overwrite_with_back(std::size_t const idx)
   noexcept
-  { m_container[idx] = std::move(m_container.back()); }
+  {
+    m_container[idx] = std::move(m_container.back());
+    touch(idx);
+  }
 
   constexpr
   void
   pop_back()
   noexcept
-  { m_container.pop_back(); }
+  {
+    m_container.pop_back();
+    ++m_structure;
+
+    if constexpr (versions_pages)
+    {
+      if (m_container.size() % dense_page_size == 0)
+        m_versions.pop_back();
+    }
+  }
 
   constexpr
   void
   clear()
   noexcept
-  { m_container.clear(); }
+  {
+    m_container.clear();
+    m_versions .clear();
+    ++m_version;
+    ++m_structure;
+  }
 };
 
 } // namespace detail
@@ -509,23 +1186,30 @@ public:
  *
  * \note
  *   Using a specializing page size of zero (0) will cause the container to not use pagination. This
- *   can be an option to very slightly improve performance when used identifier values are low.
+ *   can be an option to very slightly improve performance when used identifier values are low. Using
+ *   \c reserved_page_size_v instead reserves the positions of every identifier in virtual memory,
+ *   see \c reserved_page_size . \n
+ *   The dense pages are only versioned individually when \c Versioned is true, as pools of tracked
+ *   components are. Otherwise every page reports the structural version of the set, so that consumers
+ *   of the dense pages process them all after any structural change.
  */
 template<
     typename    Identifier = default_identifier_t<>,
     std::size_t PageSize   = default_page_size_v<>,
-    typename    Allocator  = std::allocator<Identifier>>
+    typename    Allocator  = std::allocator<Identifier>,
+    bool        Versioned  = false>
 class set
-  : protected detail::set_dense_container <Identifier, Allocator>
+  : protected detail::set_dense_container <Identifier, Allocator, Versioned>
   , protected detail::set_sparse_container<Identifier, PageSize, Allocator>
 {
 protected:
-  using dense_container  = detail::set_dense_container <Identifier, Allocator>;
+  using dense_container  = detail::set_dense_container <Identifier, Allocator, Versioned>;
   using sparse_container = detail::set_sparse_container<Identifier, PageSize, Allocator>;
 
 public:
   using identifier_type = Identifier;
   using allocator_type  = Allocator;
+  using version_type    = typename dense_container::version_type;
 
   static_assert(
       is_identifier_v<identifier_type>,
@@ -534,10 +1218,16 @@ public:
   static constexpr std::size_t page_size
   = PageSize;
 
+  static constexpr std::size_t dense_page_size
+  = dense_container::dense_page_size;
+
 private:
   using id_traits
   = identifier_traits<identifier_type>;
 
+protected:
+  std::size_t m_disabled;
+
 private:
   static constexpr
   bool
@@ -568,11 +1258,65 @@ private:
         && std::is_nothrow_swappable_v<sparse_container>;
   }
 
+protected:
+  // the digest of the identifier at the specified position, which accounts for whether it is enabled
+  [[nodiscard]] constexpr
+  std::uint64_t
+  m_identifier_digest(std::size_t const idx) const
+  noexcept
+  {
+    auto const id{static_cast<std::uint64_t>(dense_container::identifiers()[idx])};
+    return hash_mix(id ^ (idx < m_disabled ? 0x9e3779b97f4a7c15 : 0));
+  }
+
+  // sums the digests of the dense pages, each being the sum of the digests of its elements as returned
+  // by the specified function of their position, and reuses the cached digests of the pages whose
+  // version and size did not change
+  template<typename Digest>
+  [[nodiscard]]
+  std::uint64_t
+  m_hash(Digest &&digest, page_hash_cache * const cache) const
+  {
+    std::size_t const count{dense_container::page_count()};
+    std::uint64_t     hash {};
+
+    if (cache != nullptr)
+      cache->pages.resize(count);
+
+    for (std::size_t pg_idx{}; pg_idx < count; ++pg_idx)
+    {
+      std::size_t   const first  {pg_idx * dense_page_size};
+      std::size_t   const last   {std::min(first + dense_page_size, size())};
+      std::uint64_t const version{dense_container::page_version(pg_idx)};
+
+      if (cache != nullptr)
+      {
+        if (page_hash_cache::page_digest const &page{cache->pages[pg_idx]};
+            page.version == version && page.size == last - first)
+        {
+          hash += page.digest;
+          continue;
+        }
+      }
+
+      std::uint64_t page{};
+
+      for (std::size_t idx{first}; idx < last; ++idx)
+        page += digest(idx);
+
+      if (cache != nullptr)
+        cache->pages[pg_idx] = page_hash_cache::page_digest{version, last - first, page};
+
+      hash += page;
+    }
+    return hash;
+  }
+
 public:
   explicit constexpr
   set(allocator_type const &alloc)
   noexcept
-    : dense_container{alloc}, sparse_container{alloc}
+    : dense_container{alloc}, sparse_container{alloc}, m_disabled{}
   { }
 
   constexpr
@@ -585,6 +1329,7 @@ public:
   set(set const &other, allocator_type const &alloc)
     : dense_container {static_cast<dense_container  const &>(other), alloc}
     , sparse_container{static_cast<sparse_container const &>(other), alloc}
+    , m_disabled      {other.m_disabled}
   { }
 
   constexpr
@@ -595,6 +1340,7 @@ public:
   set(set &&other, allocator_type const &alloc)
     : dense_container {static_cast<dense_container  &&>(other), alloc}
     , sparse_container{static_cast<sparse_container &&>(other), alloc}
+    , m_disabled      {other.m_disabled}
   { }
 
   constexpr
@@ -622,6 +1368,7 @@ public:
   {
     dense_container ::swap(static_cast<dense_container  &>(other));
     sparse_container::swap(static_cast<sparse_container &>(other));
+    std::swap(m_disabled, other.m_disabled);
   }
 
   friend constexpr
@@ -666,11 +1413,47 @@ public:
   using dense_container::cbegin;
   using dense_container::cend;
   using dense_container::size;
+  using dense_container::capacity;
   using dense_container::empty;
+  using dense_container::identifiers;
+
+  using dense_container::version;
+  using dense_container::structural_version;
+  using dense_container::page_count;
+  using dense_container::page_version;
 
   using sparse_container
       ::contains;
 
+  /*!
+   * \brief
+   *   Returns the end of the range of enabled identifiers, which starts at \c begin() and precedes the
+   *   range of disabled identifiers.
+   */
+  [[nodiscard]] constexpr
+  auto
+  enabled_end()
+  noexcept
+  { return end() - static_cast<std::ptrdiff_t>(m_disabled); }
+
+  [[nodiscard]] constexpr
+  auto
+  enabled_end() const
+  noexcept
+  { return end() - static_cast<std::ptrdiff_t>(m_disabled); }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  enabled_size() const
+  noexcept
+  { return size() - m_disabled; }
+
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return static_cast<std::size_t>(id_traits::index(sparse_container::position(id))) >= m_disabled; }
+
   [[nodiscard]] constexpr
   auto
   iterator_to(identifier_type const id)
@@ -741,6 +1524,98 @@ public:
     return true;
   }
 
+  /*!
+   * \brief
+   *   Inserts the specified identifiers at once, none of which must already be contained.
+   */
+  constexpr
+  void
+  append(std::span<identifier_type const> const ids)
+  {
+    using index_type
+    = typename id_traits::index_type;
+
+    for (identifier_type const id : ids)
+      sparse_container::reserve_for(id);
+
+    auto idx{static_cast<index_type>(size())};
+
+    dense_container::append(ids);
+    for (identifier_type const id : ids)
+      sparse_container::position(id) = id_traits::from(idx++, id_traits::generation(id));
+  }
+
+  /*!
+   * \brief
+   *   Returns a digest of the identifiers of the set and of whether they are enabled, which does not
+   *   depend on their order.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  hash() const
+  { return m_hash([this](std::size_t const idx) { return m_identifier_digest(idx); }, nullptr); }
+
+  /*!
+   * \brief
+   *   Returns the same digest as \c hash() , only rehashing the dense pages that changed since the
+   *   specified cache was last used.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  hash(page_hash_cache &cache) const
+  { return m_hash([this](std::size_t const idx) { return m_identifier_digest(idx); }, &cache); }
+
+  /*!
+   * \brief
+   *   Reserves storage for the specified number of identifiers in the dense container.
+   */
+  constexpr
+  void
+  reserve(std::size_t const n)
+  { dense_container::reserve(n); }
+
+  /*!
+   * \brief
+   *   Allocates the sparse container for every identifier whose index is lower than the specified
+   *   number, so that inserting any of them does not allocate it.
+   */
+  constexpr
+  void
+  reserve_sparse(std::size_t const n)
+  { sparse_container::reserve(n); }
+
+  /*!
+   * \brief
+   *   Moves the specified identifier to the range of enabled identifiers.
+   */
+  constexpr
+  void
+  enable(identifier_type const id)
+  noexcept
+  {
+    if (enabled(id))
+      return;
+
+    swap(id, dense_container::identifiers()[m_disabled - 1]);
+    --m_disabled;
+  }
+
+  /*!
+   * \brief
+   *   Moves the specified identifier to the range of disabled identifiers.
+   */
+  constexpr
+  void
+  disable(identifier_type const id)
+  noexcept
+  {
+    if (!enabled(id))
+      return;
+
+    swap(id, dense_container::identifiers()[m_disabled]);
+    ++m_disabled;
+  }
+
   virtual constexpr
   void
   erase(identifier_type const id)
@@ -749,6 +1624,8 @@ public:
     using index_type
     = typename id_traits::index_type;
 
+    enable(id);
+
     if (auto const idx{static_cast<std::size_t>(id_traits::index(sparse_container::position(id)))};
         idx != size() - 1)
     {
@@ -779,10 +1656,16 @@ public:
   clear()
   noexcept
   {
-    for (identifier_type const id : *this)
-      sparse_container::position(id) = id_traits::null;
+    if constexpr (page_size == reserved_page_size_v<>)
+      sparse_container::clear();
+    else
+    {
+      for (identifier_type const id : *this)
+        sparse_container::position(id) = id_traits::null;
+    }
 
     dense_container::clear();
+    m_disabled = 0;
   }
 };
 
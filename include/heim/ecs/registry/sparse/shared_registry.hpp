@@ -0,0 +1,38 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_SHARED_REGISTRY_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_SHARED_REGISTRY_HPP
+
+#include <type_traits>
+#include "heim/ecs/identifier.hpp"
+#include "heim/lib/shared_memory.hpp"
+#include "static_registry.hpp"
+
+namespace heim::sparse
+{
+/*!
+ * \brief
+ *   A registry whose core, pages and pools are allocated in a shared memory segment, to be
+ *   constructed as the root of a \c heim::shared_memory_segment .
+ *
+ * \details
+ *   The components must be trivially copyable, so that they hold no pointer to the memory of the
+ *   writing process. The writer modifies the registry in the write sections of the segment. Readers
+ *   attaching the segment run queries on the registry in place, as const, in their read sections,
+ *   which never overlap a write section, and check the generations of the identifiers they keep
+ *   across sections with \c expired .
+ */
+template<
+    typename    Identifier,
+    typename ...Components>
+requires (std::is_trivially_copyable_v<Components> && ...)
+using generic_shared_static_registry
+= typename generic_static_registry<Identifier, shared_memory_allocator<Identifier>>
+    ::template with_all<Components ...>;
+
+template<typename ...Components>
+using shared_static_registry
+= generic_shared_static_registry<default_identifier_t<>, Components ...>;
+
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_SHARED_REGISTRY_HPP
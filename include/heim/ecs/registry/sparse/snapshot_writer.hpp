@@ -0,0 +1,283 @@
+#ifndef HEIM_ECS_REGISTRY_SPARSE_SNAPSHOT_WRITER_HPP
+#define HEIM_ECS_REGISTRY_SPARSE_SNAPSHOT_WRITER_HPP
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "heim/lib/trace.hpp"
+#include "extraction.hpp"
+
+#if __has_include(<unistd.h>)
+  #include <unistd.h>
+#endif
+
+namespace heim::sparse
+{
+namespace detail
+{
+inline constexpr std::uint64_t snapshot_magic = 0x32504e534d494548; // "HEIMSNP2"
+
+// the header of a snapshot file, which must match the snapshot it is read into
+struct snapshot_header
+{
+  std::uint64_t magic;
+  std::uint32_t identifier_size;
+  std::uint32_t component_count;
+};
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   Writes point-in-time images of the identifiers of a registry and of its pools of the specializing
+ *   component types to a file from a background thread, while the registry keeps being modified.
+ *
+ * \details
+ *   Capturing an image updates a \c registry_snapshot from the registry, which only copies the dense
+ *   pages that changed since the previous capture, then hands it to the background thread. The image
+ *   is consistent since it is entirely copied during the capture, and the background thread writes it
+ *   to a temporary file which then replaces the file, so that the file always holds a whole image.
+ *   The sparse arrays of the pools are not written, as they are rebuilt from their identifiers. A
+ *   registry is brought back to the state of the image with \c read_snapshot then \c restore . \n
+ *   Only the pools of tracked components (see \c is_tracked_component ) have the versions of their
+ *   pages compared: the components of the other pools are copied in full on every capture, and their
+ *   identifiers on every capture following a structural change of their pool. The identifiers of the
+ *   registry are copied in full on every capture following a structural change of the registry. \n
+ *   A capture is skipped while the previous image is still being written. Components must be
+ *   trivially copyable.
+ *
+ * \note
+ *   \c capture must be called by a single thread, which must also be the only one modifying the
+ *   registry during the call.
+ */
+template<
+    typename    Registry,
+    typename ...Components>
+requires (std::is_trivially_copyable_v<Components> && ...)
+class snapshot_writer
+{
+public:
+  using registry_type = Registry;
+  using snapshot_type = registry_snapshot<Registry, Components ...>;
+
+private:
+  snapshot_type               m_snapshot;
+  std::string                 m_path;
+  std::uint64_t               m_sequence;
+  std::mutex                  m_mutex;
+  std::condition_variable_any m_condition;
+  bool                        m_pending;
+  std::uint64_t               m_written;
+  int                         m_error;
+  std::jthread                m_writer;
+
+private:
+  // writes the image to a temporary file then renames it over the file, and returns an error number
+  int
+  m_write_image() const
+  {
+    errno = 0;
+
+    std::string const tmp {m_path + ".tmp"};
+    std::FILE  *const file{std::fopen(tmp.c_str(), "wb")};
+
+    if (file == nullptr)
+      return errno != 0 ? errno : EIO;
+
+    detail::snapshot_header const header{
+        detail::snapshot_magic,
+        sizeof(typename registry_type::identifier_type),
+        sizeof...(Components)};
+
+    bool ok{detail::write_objects(file, &header, sizeof(header), 1) && m_snapshot.write(file) && std::fflush(file) == 0};
+#if __has_include(<unistd.h>)
+    ok = ok && ::fsync(::fileno(file)) == 0;
+#endif
+
+    if (std::fclose(file) != 0 || !ok || std::rename(tmp.c_str(), m_path.c_str()) != 0)
+      return errno != 0 ? errno : EIO;
+    return 0;
+  }
+
+  void
+  m_write_loop(std::stop_token const stop)
+  {
+    std::unique_lock lock{m_mutex};
+
+    while (m_condition.wait(lock, stop, [this] { return m_pending; }))
+    {
+      lock.unlock();
+
+      HEIM_TRACE_ZONE("heim::snapshot_writer::write");
+      int const error{m_write_image()};
+
+      lock.lock();
+      if (error != 0)
+        m_error = error;
+      else
+        m_written = m_snapshot.sequence();
+
+      m_pending = false;
+      m_condition.notify_all();
+    }
+  }
+
+public:
+  /*!
+   * \brief
+   *   Constructs a writer of images to the file of the specified path, which is replaced by each of
+   *   them.
+   */
+  explicit
+  snapshot_writer(std::string path)
+    : m_snapshot {}
+    , m_path     {std::move(path)}
+    , m_sequence {}
+    , m_mutex    {}
+    , m_condition{}
+    , m_pending  {false}
+    , m_written  {}
+    , m_error    {}
+    , m_writer   {}
+  {
+    m_writer = std::jthread{[this](std::stop_token const stop) { m_write_loop(stop); }};
+  }
+
+  snapshot_writer(snapshot_writer const &)
+  = delete;
+
+  snapshot_writer(snapshot_writer &&)
+  = delete;
+
+  /*!
+   * \brief
+   *   Waits for the image being written, if any, then stops the background thread.
+   */
+  ~snapshot_writer()
+  {
+    {
+      std::unique_lock lock{m_mutex};
+      m_condition.wait(lock, [this] { return !m_pending; });
+    }
+    m_writer.request_stop();
+  }
+
+  snapshot_writer &
+  operator=(snapshot_writer const &)
+  = delete;
+
+  snapshot_writer &
+  operator=(snapshot_writer &&)
+  = delete;
+
+
+  /*!
+   * \brief
+   *   Captures an image of the registry and hands it to the background thread, and returns its
+   *   sequence number, or zero if the capture was skipped because the previous image is still being
+   *   written.
+   */
+  std::uint64_t
+  capture(registry_type const &registry)
+  {
+    HEIM_TRACE_ZONE("heim::snapshot_writer::capture");
+
+    {
+      std::scoped_lock lock{m_mutex};
+
+      if (m_pending)
+        return 0;
+    }
+
+    m_snapshot.update(registry, ++m_sequence);
+
+    std::scoped_lock lock{m_mutex};
+    m_pending = true;
+    m_condition.notify_all();
+    return m_sequence;
+  }
+
+  /*!
+   * \brief
+   *   Waits for the image being written, if any, to be written.
+   *
+   * \details
+   *   Throws \c std::system_error if writing an image failed since the last call.
+   */
+  void
+  wait()
+  {
+    std::unique_lock lock{m_mutex};
+    m_condition.wait(lock, [this] { return !m_pending; });
+
+    if (int const error{std::exchange(m_error, 0)}; error != 0)
+      throw std::system_error{error, std::generic_category(), "heim::sparse::snapshot_writer: write"};
+  }
+
+  /*!
+   * \brief
+   *   Returns the sequence number of the last image written to the file, or zero if none was.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  written()
+  {
+    std::scoped_lock lock{m_mutex};
+    return m_written;
+  }
+};
+
+
+/*!
+ * \brief
+ *   Reads the image written to the file of the specified path by a \c snapshot_writer of the same
+ *   registry and component types.
+ *
+ * \details
+ *   Throws \c std::system_error if the file cannot be read, and \c std::runtime_error if it is not a
+ *   whole image of such a writer.
+ */
+template<
+    typename    Registry,
+    typename ...Components>
+requires (std::is_trivially_copyable_v<Components> && ...)
+[[nodiscard]]
+registry_snapshot<Registry, Components ...>
+read_snapshot(char const * const path)
+{
+  std::FILE *const file{std::fopen(path, "rb")};
+
+  if (file == nullptr)
+    throw std::system_error{errno, std::generic_category(), "heim::sparse::read_snapshot: fopen"};
+
+  registry_snapshot<Registry, Components ...> snapshot{};
+  detail::snapshot_header                     header;
+
+  bool const ok{
+      detail::read_objects(file, &header, sizeof(header), 1)
+   && header.magic           == detail::snapshot_magic
+   && header.identifier_size == sizeof(typename Registry::identifier_type)
+   && header.component_count == sizeof...(Components)
+   && snapshot.read(file)
+   && std::fgetc(file)       == EOF};
+
+  std::fclose(file);
+  if (!ok)
+    throw std::runtime_error{"heim::sparse::read_snapshot: not a snapshot of this registry"};
+
+  return snapshot;
+}
+
+} // namespace heim::sparse
+
+#endif // HEIM_ECS_REGISTRY_SPARSE_SNAPSHOT_WRITER_HPP
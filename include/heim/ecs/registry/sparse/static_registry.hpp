@@ -1,31 +1,128 @@
 #ifndef HEIM_STATIC_REGISTRY_HPP
 #define HEIM_STATIC_REGISTRY_HPP
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <memory>
+#include <ranges>
+#include <span>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 #include "heim/ecs/entity.hpp"
 #include "heim/ecs/expression.hpp"
 #include "heim/ecs/identifier.hpp"
+#include "heim/ecs/prefab.hpp"
+#include "heim/lib/hash.hpp"
+#include "heim/lib/trace.hpp"
 #include "heim/lib/type_sequence.hpp"
+#include "heim/lib/utility.hpp"
 #include "detail/core.hpp"
 #include "detail/iterator.hpp"
+#include "detail/scheduler.hpp"
 #include "pool.hpp"
 #include "set.hpp"
 
 namespace heim::sparse
 {
+namespace detail
+{
+template<
+    typename Expression,
+    typename Registry>
+class generic_static_registry_query;
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   The position of a budgeted iteration over a query, kept between calls to resume the iteration where
+ *   it stopped.
+ *
+ * \details
+ *   The cursor holds the number of identifiers left to visit above the end of the iterated range rather
+ *   than an iterator, hence stays valid across structural changes of the registry. The iterated range
+ *   is the smallest of the pools guaranteed by the expression, or the enabled identifiers of the
+ *   registry if it has fewer, and is chosen when a pass starts. A cursor must only be used with queries
+ *   of the same expression on the same registry.
+ */
+class query_cursor
+{
+  template<typename, typename>
+  friend class detail::generic_static_registry_query;
+
+private:
+  std::size_t   m_source;
+  std::size_t   m_remaining;
+  std::uint64_t m_version;
+  std::uint64_t m_passes;
+  bool          m_invalidated;
+
+public:
+  constexpr
+  query_cursor()
+  noexcept
+    : m_source     {}
+    , m_remaining  {}
+    , m_version    {}
+    , m_passes     {}
+    , m_invalidated{}
+  { }
+
+  /*!
+   * \brief
+   *   Returns the number of identifiers left to visit in the current pass, which is zero once it is
+   *   complete.
+   */
+  [[nodiscard]] constexpr
+  std::size_t
+  remaining() const
+  noexcept
+  { return m_remaining; }
+
+  [[nodiscard]] constexpr
+  std::uint64_t
+  passes() const
+  noexcept
+  { return m_passes; }
+
+  /*!
+   * \brief
+   *   Returns whether the structure of the registry changed during the current pass, or during the
+   *   last one if it is complete, in which case some entities may have been visited twice or skipped.
+   */
+  [[nodiscard]] constexpr
+  bool
+  invalidated() const
+  noexcept
+  { return m_invalidated; }
+
+  /*!
+   * \brief
+   *   Abandons the current pass, so that the next budgeted iteration starts a new one.
+   */
+  constexpr
+  void
+  reset()
+  noexcept
+  { m_remaining = 0; }
+};
+
+
 namespace detail
 {
 template<
     typename    Component,
-    std::size_t PageSize  = default_page_size_v<>>
+    std::size_t PageSize  = default_page_size_v<>,
+    int         Node      = numa_first_touch>
 requires component<Component>
 using generic_static_registry_descriptor
-= type_sequence<Component, std::integral_constant<std::size_t, PageSize>>;
+= type_sequence<Component, std::integral_constant<std::size_t, PageSize>, std::integral_constant<int, Node>>;
 
 
 template<
@@ -39,7 +136,8 @@ template<
     typename       Identifier,
     typename       Allocator,
     typename    ...Components,
-    std::size_t ...PageSizes>
+    std::size_t ...PageSizes,
+    int         ...Nodes>
 requires (
     identifier   <Identifier>
  && allocator_for<Allocator, Identifier>
@@ -48,18 +146,22 @@ requires (
 class generic_static_registry_storage<
     Identifier,
     Allocator,
-    type_sequence<generic_static_registry_descriptor<Components, PageSizes> ...>>
+    type_sequence<generic_static_registry_descriptor<Components, PageSizes, Nodes> ...>>
 {
 public:
   using identifier_type      = Identifier;
   using allocator_type       = Allocator;
-  using description_sequence = type_sequence<generic_static_registry_descriptor<Components, PageSizes> ...>;
+  using description_sequence = type_sequence<generic_static_registry_descriptor<Components, PageSizes, Nodes> ...>;
+  using component_sequence   = type_sequence<Components ...>;
 
 private:
-  using component_sequence = type_sequence<Components ...>;
   using container_sequence = type_sequence<pool<Components, Identifier, PageSizes, Allocator> ...>;
   using container_tuple    = typename container_sequence::tuple;
 
+public:
+  static constexpr std::size_t component_count
+  = component_sequence::size;
+
   template<typename Component>
   requires (
      !component_sequence::empty
@@ -69,7 +171,6 @@ private:
   component_index
   = component_sequence::template index<Component>;
 
-public:
   template<typename Component>
   requires (
      !component_sequence::empty
@@ -81,14 +182,38 @@ private:
   container_tuple m_containers;
 
 private:
+  // whether the allocator can be bound to a node, as a heim::numa_allocator is
+  static constexpr bool s_binds_nodes
+  = requires (allocator_type const &alloc) { allocator_type{int{}, alloc.underlying()}; };
+
+  static_assert(
+      s_binds_nodes || ((Nodes == numa_first_touch) && ...),
+      "heim::sparse::detail::generic_static_registry_storage: pools can only be bound to a node by an allocator bound to nodes;");
+
+  // the allocator of the pool of the specified node, which is the allocator of the registry bound to
+  // that node unless the node is numa_first_touch
+  template<int Node>
+  [[nodiscard]] static constexpr
+  allocator_type
+  s_allocator_for(allocator_type const &alloc)
+  noexcept
+  {
+    if constexpr (Node != numa_first_touch)
+      return allocator_type{Node, alloc.underlying()};
+    else
+      return alloc;
+  }
+
   static constexpr
   bool
   s_noexcept_move_alloc_construct()
   noexcept
   {
-    return std::is_nothrow_constructible_v<
-        container_tuple,
-        std::allocator_arg_t, allocator_type const &, container_tuple &&>;
+    return ((
+        std::is_nothrow_constructible_v<
+            container_for<Components>,
+            container_for<Components> &&, allocator_type const &>
+     && std::is_nothrow_move_constructible_v<container_for<Components>>) && ...);
   }
 
   static constexpr
@@ -102,32 +227,66 @@ private:
   bool
   m_matches_conjunction(identifier_type const id, conjunction<Expressions ...>) const
   noexcept
-  { return (matches<Expressions>(id) && ...); }
+  { return (m_matches<Expressions>(id) && ...); }
 
   template<typename ...Expressions>
   [[nodiscard]] constexpr
   bool
   m_matches_disjunction(identifier_type const id, disjunction<Expressions ...>) const
   noexcept
-  { return (matches<Expressions>(id) || ...); }
+  { return (m_matches<Expressions>(id) || ...); }
 
   template<typename Expression>
   [[nodiscard]] constexpr
   bool
   m_matches_negation(identifier_type const id, negation<Expression>) const
   noexcept
-  { return !matches<Expression>(id); }
+  { return !m_matches<Expression>(id); }
+
+  // matches the specified expression without constructing it, so that components which are not
+  // default constructible can be part of expressions
+  template<typename Expression>
+  [[nodiscard]] constexpr
+  bool
+  m_matches(identifier_type const id) const
+  noexcept
+  {
+    if      constexpr (is_specialization_of_conjunction_v<Expression>)
+      return m_matches_conjunction(id, Expression{});
+    else if constexpr (is_specialization_of_disjunction_v<Expression>)
+      return m_matches_disjunction(id, Expression{});
+    else if constexpr (is_specialization_of_negation_v   <Expression>)
+      return m_matches_negation   (id, Expression{});
+    else
+      return container<Expression>().contains(id);
+  }
+
+  template<typename Component>
+  constexpr
+  void
+  m_append_copy(identifier_type const src, std::span<identifier_type const> const ids)
+  {
+    container_for<Component> &cont{container<Component>()};
+
+    if (!cont.contains(src))
+      return;
+
+    if constexpr (std::is_empty_v<Component>)
+      cont.append(ids);
+    else
+      cont.append(ids, std::as_const(cont)[src]);
+  }
 
 public:
   explicit constexpr
   generic_static_registry_storage(allocator_type const &alloc)
   noexcept
-    : m_containers{std::allocator_arg, alloc}
+    : m_containers{container_for<Components>{s_allocator_for<Nodes>(alloc)} ...}
   { }
 
   constexpr
   generic_static_registry_storage(generic_static_registry_storage const &other, allocator_type const &alloc)
-    : m_containers{std::allocator_arg, alloc, other.m_containers}
+    : m_containers{container_for<Components>{other.template container<Components>(), s_allocator_for<Nodes>(alloc)} ...}
   { }
 
   constexpr
@@ -137,7 +296,7 @@ public:
   constexpr
   generic_static_registry_storage(generic_static_registry_storage &&other, allocator_type const &alloc)
   noexcept(s_noexcept_move_alloc_construct())
-    : m_containers{std::allocator_arg, alloc, std::move(other.m_containers)}
+    : m_containers{container_for<Components>{std::move(other.template container<Components>()), s_allocator_for<Nodes>(alloc)} ...}
   { }
 
   constexpr
@@ -197,16 +356,7 @@ public:
   bool
   matches(identifier_type const id, Expression const = Expression{}) const
   noexcept
-  {
-    if      constexpr (is_specialization_of_conjunction_v<Expression>)
-      return m_matches_conjunction(id, Expression{});
-    else if constexpr (is_specialization_of_disjunction_v<Expression>)
-      return m_matches_disjunction(id, Expression{});
-    else if constexpr (is_specialization_of_negation_v   <Expression>)
-      return m_matches_negation   (id, Expression{});
-    else
-      return container<Expression>().contains(id);
-  }
+  { return m_matches<Expression>(id); }
 
   template<typename Component>
   requires (!std::is_empty_v<Component>)
@@ -270,6 +420,27 @@ public:
   insert_or_assign(identifier_type const id, Component &&c)
   { return container<Component>().insert_or_assign(id, std::forward<Component>(c)); }
 
+  template<typename Component>
+  constexpr
+  void
+  append(std::span<identifier_type const> const ids, Component const &c)
+  {
+    if constexpr (std::is_empty_v<Component>)
+      container<Component>().append(ids);
+    else
+      container<Component>().append(ids, c);
+  }
+
+  /*!
+   * \brief
+   *   Appends a copy of each component of the specified source identifier to each of the specified
+   *   identifiers, none of which must possess any component.
+   */
+  constexpr
+  void
+  append_copies(identifier_type const src, std::span<identifier_type const> const ids)
+  { (m_append_copy<Components>(src, ids), ...); }
+
   template<typename Component>
   constexpr
   void
@@ -283,11 +454,75 @@ public:
   { return container<Component>().try_erase(id); }
 
 
+  /*!
+   * \brief
+   *   Erases the component at the specified index in the description sequence from each of the
+   *   specified identifiers that possesses it.
+   *
+   * \details
+   *   The container is resolved once for the whole range, rather than once per identifier.
+   */
+  template<typename Range>
+  constexpr
+  void
+  try_erase_each(std::size_t const component_idx, Range &&ids)
+  {
+    auto const erase_each{[&ids]<typename Component>(container_for<Component> &cont)
+    {
+      for (identifier_type const id : ids)
+        cont.try_erase(id);
+    }};
+
+    ((component_idx == component_index<Components>
+        ? erase_each.template operator()<Components>(container<Components>())
+        : void()), ...);
+  }
+
+  constexpr
+  void
+  enable(identifier_type const id)
+  { ((container<Components>().contains(id) ? container<Components>().enable(id) : void()), ...); }
+
+  constexpr
+  void
+  disable(identifier_type const id)
+  { ((container<Components>().contains(id) ? container<Components>().disable(id) : void()), ...); }
+
   constexpr
   void
   clear(identifier_type const id)
   { (try_erase<Components>(id), ...); }
 
+  // combines the digests of the pools, using the specified caches (one per pool) if any
+  [[nodiscard]]
+  std::uint64_t
+  hash(page_hash_cache * const caches) const
+  {
+    std::uint64_t hash{};
+
+    if (caches != nullptr)
+      ((hash = hash_mix(hash ^ container<Components>().hash(caches[component_index<Components>]))), ...);
+    else
+      ((hash = hash_mix(hash ^ container<Components>().hash())), ...);
+    return hash;
+  }
+
+  // the sum of the structural versions of the pools, which increases on any of their structural
+  // changes
+  [[nodiscard]] constexpr
+  std::uint64_t
+  structural_version() const
+  noexcept
+  { return (std::uint64_t{} + ... + container<Components>().structural_version()); }
+
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    (container<Components>().reserve       (n), ...);
+    (container<Components>().reserve_sparse(n), ...);
+  }
+
   constexpr
   void
   clear()
@@ -364,7 +599,7 @@ public:
   iterator_type
   end(registry_type const * const registry)
   noexcept
-  { return registry->template container<expression_type>().end(); }
+  { return registry->template container<expression_type>().enabled_end(); }
 
 
   static constexpr
@@ -413,14 +648,14 @@ private:
   noexcept
   {
     auto        const &cont     {registry->template container<Component>()};
-    std::size_t const  cont_size{cont.size()};
+    std::size_t const  cont_size{cont.enabled_size()};
 
     if (cont_size >= size)
       return;
 
     size    = cont_size;
     m_begin = cont.begin();
-    m_end   = cont.end();
+    m_end   = cont.enabled_end();
   }
 
   template<typename ...Components>
@@ -431,7 +666,7 @@ private:
       type_sequence<Components ...> const          = type_sequence<Components ...>{})
   noexcept
   {
-    std::size_t size{registry->core_type::size()};
+    std::size_t size{registry->core_type::enabled_size()};
 
     (m_initialize_unfold<Components>(registry, size), ...);
     m_begin = increment(registry, m_begin);
@@ -456,8 +691,8 @@ public:
   explicit constexpr
   generic_static_registry_query_driver(registry_type const * const registry)
   noexcept
-    : m_begin{registry->core_type::begin()}
-    , m_end  {registry->core_type::end  ()}
+    : m_begin{registry->core_type::begin      ()}
+    , m_end  {registry->core_type::enabled_end()}
   { m_initialize(registry, guaranteed_t<expression_type>{}); }
 
   constexpr
@@ -608,7 +843,7 @@ public:
   iterator_type
   end(registry_type const * const registry)
   noexcept
-  { return registry->core_type::end(); }
+  { return registry->core_type::enabled_end(); }
 
 
   static constexpr
@@ -711,7 +946,7 @@ public:
   iterator_type
   end(registry_type const * const registry)
   noexcept
-  { return registry->core_type::end(); }
+  { return registry->core_type::enabled_end(); }
 
 
   static constexpr
@@ -889,6 +1124,72 @@ public:
 };
 
 
+// uninitialized storage for the components of a chunk of \c each_chunk and their positions in their
+// pool, which destroys the components it holds
+template<
+    typename    T,
+    std::size_t N>
+class query_chunk_buffer
+{
+private:
+  union
+  {
+    T m_values[N];
+  };
+
+  std::array<std::size_t, N> m_indices;
+  std::size_t                m_size;
+
+public:
+  constexpr
+  query_chunk_buffer()
+  noexcept
+    : m_indices{}
+    , m_size   {}
+  { }
+
+  query_chunk_buffer(query_chunk_buffer const &)
+  = delete;
+
+  constexpr
+  ~query_chunk_buffer()
+  { clear(); }
+
+  query_chunk_buffer &
+  operator=(query_chunk_buffer const &)
+  = delete;
+
+  [[nodiscard]] constexpr
+  std::span<T>
+  values()
+  noexcept
+  { return std::span<T>{m_values, m_size}; }
+
+  [[nodiscard]] constexpr
+  std::span<std::size_t const>
+  indices() const
+  noexcept
+  { return std::span<std::size_t const>{m_indices.data(), m_size}; }
+
+  constexpr
+  void
+  push_back(T const &value, std::size_t const idx)
+  {
+    std::construct_at(m_values + m_size, value);
+    m_indices[m_size++] = idx;
+  }
+
+  constexpr
+  void
+  clear()
+  noexcept
+  {
+    std::destroy_n(m_values, m_size);
+    m_size = 0;
+  }
+};
+
+
 template<
     typename Expression,
     typename Registry>
@@ -911,6 +1212,71 @@ private:
   registry_type *m_registry;
   driver_type    m_driver;
 
+private:
+  static constexpr std::size_t s_budget_stride = 64;
+
+  static constexpr bool s_single_component
+  =  !specialization_of_conjunction<expression_type>
+  && !specialization_of_disjunction<expression_type>
+  && !specialization_of_negation   <expression_type>;
+
+  using guaranteed_sequence
+  = guaranteed_t<expression_type>;
+
+  // the source of the identifiers visited by a budgeted pass, chosen when the pass starts: the index in
+  // the guaranteed components of the pool with the fewest enabled identifiers, or their number if the
+  // enabled identifiers of the registry are fewer
+  [[nodiscard]] constexpr
+  std::size_t
+  m_budgeted_source() const
+  noexcept
+  {
+    if constexpr (s_single_component)
+      return 0;
+    else
+    {
+      registry_type const &registry{*m_registry};
+
+      std::size_t source{guaranteed_sequence::size};
+      std::size_t size  {registry.core_type::enabled_size()};
+
+      [&]<typename ...Components>(type_sequence<Components ...>)
+      {
+        std::size_t idx{};
+
+        ((registry.template container<Components>().enabled_size() < size
+            ? void((source = idx, size = registry.template container<Components>().enabled_size()))
+            : void(), ++idx), ...);
+      }(guaranteed_sequence{});
+
+      return source;
+    }
+  }
+
+  // the end of the range of identifiers of the specified source and its size
+  [[nodiscard]] constexpr
+  auto
+  m_budgeted_range(std::size_t const source) const
+  noexcept
+  {
+    using iterator_type = typename std::remove_const_t<registry_type>::core_type::const_iterator;
+
+    registry_type const &registry{*m_registry};
+
+    std::pair<iterator_type, std::size_t> range{registry.core_type::enabled_end(), registry.core_type::enabled_size()};
+
+    [&]<typename ...Components>(type_sequence<Components ...>)
+    {
+      std::size_t idx{};
+
+      ((idx++ == source
+          ? void(range = {registry.template container<Components>().enabled_end(), registry.template container<Components>().enabled_size()})
+          : void()), ...);
+    }(guaranteed_sequence{});
+
+    return range;
+  }
+
 public:
   constexpr
   generic_static_registry_query()
@@ -1006,11 +1372,240 @@ public:
   cend() const
   noexcept
   { return const_iterator{m_driver, m_registry, std::bool_constant<false>{}}; }
+
+
+  /*!
+   * \brief
+   *   Invokes the specified function on chunks of the matched entities, with the span of their
+   *   identifiers followed by the spans of their components of the specializing types, in the same
+   *   order.
+   *
+   * \details
+   *   Queries of a single component pass spans over the dense arrays of its pool, one dense page at a
+   *   time. Other queries copy the components of each chunk of entities into uninitialized buffers on
+   *   the stack while iterating them, resolving the position of each entity in each pool once, then
+   *   move back those of non-const types to these positions once the function returns. The buffers of
+   *   a chunk take at most 16 KiB together, unless a single entity does not fit, and the components
+   *   must then be copy constructible, and move assignable if non-const. \n
+   *   The specializing component types must be guaranteed to be possessed by the matched entities, and
+   *   the function must not add or remove entities or components.
+   */
+  template<
+      typename ...Components,
+      typename    F>
+  requires (
+      sizeof...(Components) > 0
+   && (!std::is_empty_v<Components> && ...)
+   && (type_sequence_contains_v<guaranteed_t<expression_type>, std::remove_const_t<Components>> && ...))
+  constexpr
+  void
+  each_chunk(F &&f)
+  {
+    static_assert(
+        !std::is_const_v<registry_type> || (std::is_const_v<Components> && ...),
+        "heim::sparse::detail::generic_static_registry_query: components of a const registry must be const.");
+
+    HEIM_TRACE_ZONE("heim::query::each_chunk");
+
+    using identifier_type = typename std::remove_const_t<registry_type>::identifier_type;
+
+    if constexpr (
+        sizeof...(Components) == 1
+     && (std::is_same_v<std::remove_const_t<Components>, expression_type> && ...))
+    {
+      using chunk_component = std::tuple_element_t<0, std::tuple<Components ...>>;
+
+      auto &pool{m_registry->template container<expression_type>()};
+
+      // const components are accessed through the const pool, which does not stamp its pages
+      std::span<identifier_type const> const ids  {pool.identifiers()};
+      std::span<chunk_component>       const comps{[&pool]() -> std::span<chunk_component>
+      {
+        if constexpr (std::is_const_v<chunk_component>)
+          return std::as_const(pool).components();
+        else
+          return pool.components();
+      }()};
+
+      constexpr std::size_t page_size{std::remove_cvref_t<decltype(pool)>::dense_page_size};
+
+      // disabled identifiers precede the enabled ones in the dense arrays
+      for (std::size_t first{ids.size() - pool.enabled_size()}; first < ids.size(); )
+      {
+        std::size_t const last{std::min((first / page_size + 1) * page_size, ids.size())};
+
+        f(ids.subspan(first, last - first), comps.subspan(first, last - first));
+        first = last;
+      }
+    }
+    else
+    {
+      static_assert(
+          (std::copy_constructible<std::remove_const_t<Components>> && ...)
+       && ((std::is_const_v<Components> || std::is_move_assignable_v<Components>) && ...),
+          "heim::sparse::detail::generic_static_registry_query: components of chunks must be copy constructible, and move assignable if non-const.");
+
+      constexpr std::size_t chunk_size
+      = std::clamp<std::size_t>(16384 / ((sizeof(Components) + sizeof(std::size_t)) + ...), 1, 256);
+
+      std::array<identifier_type, chunk_size>                                       ids    {};
+      std::tuple<query_chunk_buffer<std::remove_const_t<Components>, chunk_size> ...> buffers{};
+      std::size_t                                                                   size   {};
+
+      // const components are read through the const pools, which do not stamp their pages
+      std::tuple const comps{std::as_const(m_registry->template container<std::remove_const_t<Components>>()).components() ...};
+
+      auto const flush{[&]
+      {
+        f(std::span<identifier_type const>{ids.data(), size},
+          std::get<query_chunk_buffer<std::remove_const_t<Components>, chunk_size>>(buffers).values() ...);
+
+        ([&]
+        {
+          auto &buffer{std::get<query_chunk_buffer<std::remove_const_t<Components>, chunk_size>>(buffers)};
+
+          if constexpr (!std::is_const_v<Components>)
+            m_registry->template container<Components>().scatter_at(buffer.indices(), buffer.values());
+
+          buffer.clear();
+        }(), ...);
+
+        size = 0;
+      }};
+
+      for (auto const e : *this)
+      {
+        identifier_type const id{e.identifier()};
+
+        ids[size++] = id;
+
+        ([&]
+        {
+          using component_type = std::remove_const_t<Components>;
+
+          std::size_t const idx{m_registry->template container<component_type>().index_of(id)};
+
+          std::get<query_chunk_buffer<component_type, chunk_size>>(buffers).push_back(
+              std::get<std::span<component_type const>>(comps)[idx], idx);
+        }(), ...);
+
+        if (size == chunk_size)
+          flush();
+      }
+
+      if (size != 0)
+        flush();
+    }
+  }
+
+  /*!
+   * \brief
+   *   Invokes the specified function on the matched entities from the position of the specified cursor,
+   *   until the pass over the matched entities is complete or the specified deadline is reached, and
+   *   returns whether the pass is complete.
+   *
+   * \details
+   *   Is designed to amortize the work of a system over several frames, the cursor being kept between
+   *   them and starting a new pass once the previous one is complete. The deadline is checked every 64
+   *   visited identifiers, hence at least as many are visited on each call. \n
+   *   The function may add or remove entities or components. The entities moved by such changes may
+   *   however be visited twice or skipped during the current pass, which is then reported by the
+   *   cursor.
+   */
+  template<
+      typename Clock,
+      typename Duration,
+      typename F>
+  bool
+  budgeted_each(query_cursor &cursor, std::chrono::time_point<Clock, Duration> const deadline, F &&f)
+  {
+    HEIM_TRACE_ZONE("heim::query::budgeted_each");
+
+    using identifier_type = typename std::remove_const_t<registry_type>::identifier_type;
+
+    std::uint64_t const version{m_registry->structural_version()};
+
+    if (cursor.m_remaining == 0)
+    {
+      cursor.m_source      = m_budgeted_source();
+      cursor.m_remaining   = m_budgeted_range(cursor.m_source).second;
+      cursor.m_invalidated = false;
+    }
+    else if (version != cursor.m_version)
+      cursor.m_invalidated = true;
+
+    for (std::size_t visited{}; ; ++visited)
+    {
+      // the range is fetched again as the function may change it, the identifiers left to visit being
+      // the ones right above its end
+      auto const [last, size]{m_budgeted_range(cursor.m_source)};
+
+      cursor.m_remaining = std::min(cursor.m_remaining, size);
+
+      if (cursor.m_remaining == 0
+       || (visited != 0 && visited % s_budget_stride == 0 && Clock::now() >= deadline))
+        break;
+
+      identifier_type const id{*(last - static_cast<std::ptrdiff_t>(cursor.m_remaining--))};
+
+      if constexpr (!s_single_component)
+      {
+        if (!m_registry->template matches<expression_type>(id))
+          continue;
+      }
+
+      f(entity<registry_type>{*m_registry, id});
+    }
+
+    cursor.m_version     = m_registry->structural_version();
+    cursor.m_invalidated = cursor.m_invalidated || cursor.m_version != version;
+
+    if (cursor.m_remaining != 0)
+      return false;
+
+    ++cursor.m_passes;
+    return true;
+  }
 };
 
 } // namespace detail
 
 
+/*!
+ * \brief
+ *   Invokes the specified function on the entities matched by the specified query from the position
+ *   of the specified cursor, until the deadline is reached, and returns whether the pass over the
+ *   matched entities is complete.
+ */
+template<
+    typename Expression,
+    typename Registry,
+    typename Clock,
+    typename Duration,
+    typename F>
+bool
+budgeted_each(
+    detail::generic_static_registry_query<Expression, Registry> query,
+    query_cursor                                                &cursor,
+    std::chrono::time_point<Clock, Duration> const               deadline,
+    F                                                          &&f)
+{ return query.budgeted_each(cursor, deadline, std::forward<F>(f)); }
+
+
+/*!
+ * \brief
+ *   The registry of entities and of their components, whose component types are known at compile time.
+ *
+ * \details
+ *   The registry follows a steady-state allocation contract: once enough storage is reserved (with
+ *   \c reserve or by a previous peak of usage), \c create , \c destroy , \c emplace , \c insert ,
+ *   \c erase , \c enable , \c disable , \c clone , \c instantiate and the iteration of queries do not
+ *   allocate, as storage is never released before the registry is destroyed. Reservations hold as long
+ *   as the number of entities and of components of each type stays within them. \n
+ *   The contract excludes copies of the registry, the scheduling of actions (\c expire_after ,
+ *   \c destroy_after and \c tick ) and the constructors of the components themselves. It can be
+ *   verified with \c heim::guarded_allocator .
+ */
 template<
     typename Identifier   = default_identifier_t<>,
     typename Allocator    = std::allocator<Identifier>,
@@ -1018,33 +1613,56 @@ template<
 class generic_static_registry
   : protected detail::registry_core                  <Identifier, Allocator>
   , protected detail::generic_static_registry_storage<Identifier, Allocator, DescSequence>
+  , protected detail::registry_scheduler             <Identifier, Allocator>
 {
-  using core_type    = detail::registry_core                  <Identifier, Allocator>;
-  using storage_type = detail::generic_static_registry_storage<Identifier, Allocator, DescSequence>;
+  using core_type      = detail::registry_core                  <Identifier, Allocator>;
+  using storage_type   = detail::generic_static_registry_storage<Identifier, Allocator, DescSequence>;
+  using scheduler_type = detail::registry_scheduler             <Identifier, Allocator>;
 
   template<typename>           friend class detail::registry_iterator;
   template<typename, typename> friend class detail::generic_static_registry_query_driver;
   template<typename, typename> friend class detail::generic_static_registry_query_iterator;
+  template<typename, typename> friend class detail::generic_static_registry_query;
 
 public:
   using identifier_type      = Identifier;
   using allocator_type       = Allocator;
   using description_sequence = DescSequence;
+  using component_sequence   = typename storage_type::component_sequence;
+  using tick_type            = typename scheduler_type::tick_type;
 
   using iterator       = detail::registry_iterator<generic_static_registry>;
   using const_iterator = detail::registry_iterator<generic_static_registry const>;
 
-
+  template<typename Component>
+  using container_for
+  = typename storage_type::template container_for<Component>;
+
+  using hash_cache
+  = std::array<page_hash_cache, storage_type::component_count>;
+
+
+  /*!
+   * \brief
+   *   The registry with the pool of the specified component, of the specified page size, and bound to
+   *   the specified node if that is not \c numa_first_touch .
+   *
+   * \details
+   *   A node requires an allocator bound to nodes, such as \c heim::numa_allocator , whose node is then
+   *   replaced by the specified one for that pool only, e.g. to keep a pool on the node of the workers
+   *   iterating it while the other pools follow the allocator of the registry.
+   */
   template<
       typename    Component,
-      std::size_t PageSize  = default_page_size_v<>>
+      std::size_t PageSize  = default_page_size_v<>,
+      int         Node      = numa_first_touch>
   using with
   = generic_static_registry<
       identifier_type,
       allocator_type,
       type_sequence_append_t<
           description_sequence,
-          detail::generic_static_registry_descriptor<Component, PageSize>>>;
+          detail::generic_static_registry_descriptor<Component, PageSize, Node>>>;
 
   template<typename ...Components>
   using with_all
@@ -1073,7 +1691,10 @@ private:
             core_type &&, allocator_type const &>
      && std::is_nothrow_constructible_v<
             storage_type,
-            storage_type &&, allocator_type const &>;
+            storage_type &&, allocator_type const &>
+     && std::is_nothrow_constructible_v<
+            scheduler_type,
+            scheduler_type &&, allocator_type const &>;
   }
 
   static constexpr
@@ -1082,15 +1703,60 @@ private:
   noexcept
   {
     return std::is_nothrow_swappable_v<core_type>
-        && std::is_nothrow_swappable_v<storage_type>;
+        && std::is_nothrow_swappable_v<storage_type>
+        && std::is_nothrow_swappable_v<scheduler_type>;
+  }
+
+  static constexpr std::uint32_t s_destroy_action
+  = static_cast<std::uint32_t>(storage_type::component_count);
+
+  template<typename Component>
+  constexpr
+  void
+  m_match_enabled(identifier_type const id)
+  {
+    if (!core_type::enabled(id))
+      storage_type::template container<std::remove_cvref_t<Component>>().disable(id);
+  }
+
+  template<typename Out, typename F>
+  constexpr
+  Out
+  m_create_each(std::size_t const n, Out out, F &&populate)
+  {
+    auto const created{core_type::create(n)};
+
+    // strong exception safety guarantee
+    try
+    {
+      for (auto const ids : created)
+        populate(ids);
+    }
+    catch (...)
+    {
+      for (auto const ids : created)
+      {
+        for (identifier_type const id : ids)
+          storage_type::clear(id);
+      }
+
+      core_type::revert_create(created);
+      throw;
+    }
+
+    for (auto const ids : created)
+      out = std::ranges::copy(ids, std::move(out)).out;
+
+    return out;
   }
 
 public:
   explicit constexpr
   generic_static_registry(allocator_type const &alloc)
   noexcept
-    : core_type   {alloc}
-    , storage_type{alloc}
+    : core_type     {alloc}
+    , storage_type  {alloc}
+    , scheduler_type{alloc}
   { }
 
   constexpr
@@ -1101,8 +1767,9 @@ public:
 
   constexpr
   generic_static_registry(generic_static_registry const &other, allocator_type const &alloc)
-    : core_type   {static_cast<core_type    const &>(other), alloc}
-    , storage_type{static_cast<storage_type const &>(other), alloc}
+    : core_type     {static_cast<core_type      const &>(other), alloc}
+    , storage_type  {static_cast<storage_type   const &>(other), alloc}
+    , scheduler_type{static_cast<scheduler_type const &>(other), alloc}
   { }
 
   constexpr
@@ -1112,8 +1779,9 @@ public:
   constexpr
   generic_static_registry(generic_static_registry &&other, allocator_type const &alloc)
   noexcept(s_noexcept_move_alloc_construct())
-    : core_type   {static_cast<core_type    &&>(other), alloc}
-    , storage_type{static_cast<storage_type &&>(other), alloc}
+    : core_type     {static_cast<core_type      &&>(other), alloc}
+    , storage_type  {static_cast<storage_type   &&>(other), alloc}
+    , scheduler_type{static_cast<scheduler_type &&>(other), alloc}
   { }
 
   constexpr
@@ -1139,8 +1807,9 @@ public:
   swap(generic_static_registry &other)
   noexcept(s_noexcept_swap())
   {
-    core_type   ::swap(static_cast<core_type    &>(other));
-    storage_type::swap(static_cast<storage_type &>(other));
+    core_type     ::swap(static_cast<core_type      &>(other));
+    storage_type  ::swap(static_cast<storage_type   &>(other));
+    scheduler_type::swap(static_cast<scheduler_type &>(other));
   }
 
   friend constexpr
@@ -1149,10 +1818,15 @@ public:
   noexcept(s_noexcept_swap())
   { lhs.swap(rhs); }
 
+  // the scheduled actions and the tick are not part of the state of the registries
   [[nodiscard]] friend constexpr
   bool
-  operator==(generic_static_registry const &, generic_static_registry const &)
-  = default;
+  operator==(generic_static_registry const &lhs, generic_static_registry const &rhs)
+  noexcept
+  {
+    return static_cast<core_type    const &>(lhs) == static_cast<core_type    const &>(rhs)
+        && static_cast<storage_type const &>(lhs) == static_cast<storage_type const &>(rhs);
+  }
 
   [[nodiscard]] constexpr
   allocator_type
@@ -1210,6 +1884,131 @@ public:
   noexcept
   { return core_type::empty(); }
 
+  [[nodiscard]] constexpr
+  std::size_t
+  capacity() const
+  noexcept
+  { return core_type::capacity(); }
+
+  /*!
+   * \brief
+   *   Returns the dense array of the identifiers of the registry, which holds the destroyed
+   *   identifiers (see \c destroyed_size ), then the disabled ones (see \c disabled_size ), then the
+   *   enabled ones.
+   *
+   * \details
+   *   Is the whole state of the identifiers of the registry, which \c restore_identifiers restores.
+   */
+  [[nodiscard]] constexpr
+  std::span<identifier_type const>
+  identifiers() const
+  noexcept
+  { return core_type::identifiers(); }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  destroyed_size() const
+  noexcept
+  { return core_type::destroyed_size(); }
+
+  [[nodiscard]] constexpr
+  std::size_t
+  disabled_size() const
+  noexcept
+  { return core_type::disabled_size(); }
+
+  /*!
+   * \brief
+   *   Replaces the identifiers of the registry with the specified state, as returned by
+   *   \c identifiers , \c destroyed_size and \c disabled_size , and returns whether it was valid.
+   *
+   * \details
+   *   Once restored, the components and the scheduled actions of the registry are cleared, and the
+   *   identifiers are created again in the same order as from the registry the state was taken from.
+   *   An invalid state leaves the registry unchanged.
+   */
+  constexpr
+  bool
+  restore_identifiers(std::span<identifier_type const> const ids, std::size_t const destroyed, std::size_t const disabled)
+  {
+    if (!core_type::assign(ids, destroyed, disabled))
+      return false;
+
+    storage_type  ::clear();
+    scheduler_type::clear();
+    return true;
+  }
+
+  /*!
+   * \brief
+   *   Returns a digest of the entities of the registry, of whether they are enabled and of their
+   *   components, which does not depend on the order of any of them.
+   *
+   * \details
+   *   Is designed to detect the divergence of the states of peers in lockstep simulations, which are
+   *   expected to run on platforms with the same byte order.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  hash() const
+  { return hash_mix(core_type::hash() ^ storage_type::hash(nullptr)); }
+
+  /*!
+   * \brief
+   *   Returns the same digest as \c hash() , only rehashing the dense pages of the pools that changed
+   *   since the specified caches were last used.
+   *
+   * \note
+   *   Only the pools of tracked components version their pages, see \c is_tracked_component , which
+   *   components are not by default: the pools of the other components are rehashed in full on every
+   *   call, as by \c hash() . Specializing \c is_tracked_component for the components modified
+   *   between hashes is what makes this rehash only the pages that changed.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  hash(hash_cache &caches) const
+  { return hash_mix(core_type::hash() ^ storage_type::hash(caches.data())); }
+
+  /*!
+   * \brief
+   *   Returns the version of the structure of the registry, which changes whenever entities or
+   *   components are added, removed, enabled, disabled or reordered, but not when components are only
+   *   modified.
+   */
+  [[nodiscard]] constexpr
+  std::uint64_t
+  structural_version() const
+  noexcept
+  { return core_type::structural_version() + storage_type::structural_version(); }
+
+  /*!
+   * \brief
+   *   Reserves storage for the specified number of entities, each possessing every component.
+   */
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    core_type   ::reserve(n);
+    storage_type::reserve(n);
+  }
+
+  /*!
+   * \brief
+   *   Reserves storage for the specified number of components of the specified type, on any of the
+   *   identifiers the registry can create without allocating.
+   */
+  template<typename Component>
+  constexpr
+  void
+  reserve(std::size_t const n)
+  {
+    container_for<Component> &c{storage_type::template container<Component>()};
+
+    c.reserve       (n);
+    c.reserve_sparse(core_type::capacity());
+  }
+
 
   [[nodiscard]] constexpr
   bool
@@ -1224,6 +2023,49 @@ public:
   noexcept
   { return storage_type::template matches<Expression>(id); }
 
+  [[nodiscard]] constexpr
+  bool
+  enabled(identifier_type const id) const
+  noexcept
+  { return core_type::enabled(id); }
+
+  /*!
+   * \brief
+   *   Enables the specified identifier, so that it is matched by queries again.
+   */
+  constexpr
+  void
+  enable(identifier_type const id)
+  {
+    if (core_type::enabled(id))
+      return;
+
+    storage_type::enable(id);
+    core_type   ::enable(id);
+  }
+
+  /*!
+   * \brief
+   *   Disables the specified identifier, so that queries skip it while it keeps its components.
+   *
+   * \details
+   *   Disabled identifiers are kept at the end of the iteration range of the registry and of each of
+   *   their containers, hence queries skip them without any test, and toggling only swaps the
+   *   identifier with the boundary of each of these ranges.
+   */
+  constexpr
+  void
+  disable(identifier_type const id)
+  {
+    if (!core_type::enabled(id))
+      return;
+
+    storage_type::disable(id);
+    core_type   ::disable(id);
+  }
+
+  using storage_type::container;
+
   template<typename Expression>
   [[nodiscard]] constexpr
   auto
@@ -1282,29 +2124,91 @@ public:
   entity()
   { return heim::entity<generic_static_registry>{*this, core_type::create()}; }
 
+  /*!
+   * \brief
+   *   Creates the specified number of identifiers, each possessing a copy of each component of the
+   *   specified source identifier, and writes them to the specified output iterator.
+   *
+   * \details
+   *   Identifiers are created at once, and each container of the source's components is appended to in
+   *   a single pass, at most twice (once for the recycled identifiers and once for the new ones).
+   */
+  template<std::weakly_incrementable Out>
+  requires std::indirectly_writable<Out, identifier_type const &>
+  constexpr
+  Out
+  clone(identifier_type const src, std::size_t const n, Out out)
+  {
+    HEIM_TRACE_ZONE("heim::registry::clone");
+
+    return m_create_each(n, std::move(out), [this, src](std::span<identifier_type const> const ids)
+    { storage_type::append_copies(src, ids); });
+  }
+
+  /*!
+   * \brief
+   *   Creates the specified number of identifiers, each possessing a copy of each component of the
+   *   specified prefab, and writes them to the specified output iterator.
+   *
+   * \details
+   *   Identifiers are created at once, and each container of the prefab's components is appended to in
+   *   a single pass, at most twice (once for the recycled identifiers and once for the new ones).
+   */
+  template<
+      typename ...Components,
+      std::weakly_incrementable Out>
+  requires std::indirectly_writable<Out, identifier_type const &>
+  constexpr
+  Out
+  instantiate(prefab<Components ...> const &pf, std::size_t const n, Out out)
+  {
+    HEIM_TRACE_ZONE("heim::registry::instantiate");
+
+    return m_create_each(n, std::move(out), [this, &pf]([[maybe_unused]] std::span<identifier_type const> const ids)
+    { (storage_type::template append<Components>(ids, pf.template get<Components>()), ...); });
+  }
+
   template<typename Component, typename ...Args>
   constexpr
   void
   emplace(identifier_type const id, Args &&...args)
-  { storage_type::template emplace<Component>(id, std::forward<Args>(args)...); }
+  {
+    storage_type::template emplace<Component>(id, std::forward<Args>(args)...);
+    m_match_enabled<Component>(id);
+  }
 
   template<typename Component, typename ...Args>
   constexpr
   bool
   try_emplace(identifier_type const id, Args &&...args)
-  { return storage_type::template try_emplace<Component>(id, std::forward<Args>(args)...); }
+  {
+    bool const inserted{storage_type::template try_emplace<Component>(id, std::forward<Args>(args)...)};
+
+    m_match_enabled<Component>(id);
+    return inserted;
+  }
 
   template<typename Component>
   constexpr
   bool
   insert(identifier_type const id, Component &&c)
-  { return storage_type::template insert<Component>(id, std::forward<Component>(c)); }
+  {
+    bool const inserted{storage_type::template insert<Component>(id, std::forward<Component>(c))};
+
+    m_match_enabled<Component>(id);
+    return inserted;
+  }
 
   template<typename Component>
   constexpr
   bool
   insert_or_assign(identifier_type const id, Component &&c)
-  { return storage_type::template insert_or_assign<Component>(id, std::forward<Component>(c)); }
+  {
+    bool const inserted{storage_type::template insert_or_assign<Component>(id, std::forward<Component>(c))};
+
+    m_match_enabled<Component>(id);
+    return inserted;
+  }
 
   template<typename Component>
   constexpr
@@ -1327,7 +2231,13 @@ public:
   void
   clear()
   noexcept
-  { storage_type::clear(); core_type::clear(); }
+  {
+    HEIM_TRACE_ZONE("heim::registry::clear");
+
+    storage_type  ::clear();
+    core_type     ::clear();
+    scheduler_type::clear();
+  }
 
   constexpr
   bool
@@ -1340,6 +2250,85 @@ public:
     core_type::destroy(id);
     return true;
   }
+
+
+  [[nodiscard]] constexpr
+  tick_type
+  current_tick() const
+  noexcept
+  { return scheduler_type::current_tick(); }
+
+  /*!
+   * \brief
+   *   Schedules the removal of the specified component from the specified identifier once the
+   *   specified number of ticks will have elapsed.
+   *
+   * \details
+   *   The removal is skipped if the identifier no longer possesses the component by then.
+   */
+  template<typename Component>
+  constexpr
+  void
+  expire_after(identifier_type const id, tick_type const ticks)
+  {
+    scheduler_type::schedule(
+        id,
+        static_cast<std::uint32_t>(storage_type::template component_index<Component>),
+        ticks);
+  }
+
+  /*!
+   * \brief
+   *   Schedules the destruction of the specified identifier once the specified number of ticks will
+   *   have elapsed.
+   *
+   * \details
+   *   The destruction is skipped if the identifier has expired by then.
+   */
+  constexpr
+  void
+  destroy_after(identifier_type const id, tick_type const ticks)
+  { scheduler_type::schedule(id, s_destroy_action, ticks); }
+
+  /*!
+   * \brief
+   *   Advances the registry by one tick, performing the scheduled removals and destructions that
+   *   became due.
+   *
+   * \details
+   *   Due actions are grouped by component, so that each container is resolved once per tick, and
+   *   component removals are performed before destructions.
+   */
+  constexpr
+  void
+  tick()
+  {
+    HEIM_TRACE_ZONE("heim::registry::tick");
+
+    auto &due{scheduler_type::advance()};
+
+    if (due.empty())
+      return;
+
+    std::ranges::sort(due, {}, &scheduler_type::entry::action);
+
+    for (auto first{due.begin()}; first != due.end(); )
+    {
+      auto const action{first->action};
+      auto const last  {std::ranges::find_if(first, due.end(), [action](auto const &e) { return e.action != action; })};
+      auto const ids   {std::ranges::subrange(first, last) | std::views::transform(&scheduler_type::entry::id)};
+
+      if (action == s_destroy_action)
+      {
+        for (identifier_type const id : ids)
+          destroy(id);
+      }
+      else
+        storage_type::try_erase_each(action, ids);
+
+      first = last;
+    }
+  }
 };
 
 using static_registry
@@ -1,6 +1,16 @@
 #ifndef HEIM_LIB_HPP
 #define HEIM_LIB_HPP
 
+#include "lib/guarded_allocator.hpp"
+#include "lib/hash.hpp"
+#if __has_include(<sys/mman.h>)
+  #include "lib/huge_page_allocator.hpp"
+  #include "lib/numa_allocator.hpp"
+  #include "lib/shared_memory.hpp"
+#endif
+#include "lib/spsc_ring.hpp"
+#include "lib/trace.hpp"
+#include "lib/triple_buffer.hpp"
 #include "lib/type_sequence.hpp"
 #include "lib/unique_allocator_aware_ptr.hpp"
 #include "lib/utility.hpp"
@@ -0,0 +1,286 @@
+#ifndef HEIM_LIB_GUARDED_ALLOCATOR_HPP
+#define HEIM_LIB_GUARDED_ALLOCATOR_HPP
+
+#include <version>
+#include <concepts>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "utility.hpp"
+
+// std::stacktrace needs an extra library to be linked with some toolchains (e.g. -lstdc++exp with
+// GCC), hence is only used when requested
+#if defined(HEIM_ENABLE_STACKTRACE) && defined(__cpp_lib_stacktrace)
+  #include <stacktrace>
+#elif __has_include(<execinfo.h>)
+  #include <execinfo.h>
+#endif
+
+namespace heim
+{
+/*!
+ * \brief
+ *   The reaction of the allocation guard to an allocation made while allocations are frozen.
+ */
+enum class allocation_guard_mode
+{
+  trap,  // reports the allocation and its stack to the standard error, then aborts
+  record // records the allocation and its stack, to be inspected once allocations are thawed
+};
+
+
+struct allocation_violation
+{
+  std::size_t bytes;
+  std::string stack;
+};
+
+
+/*!
+ * \brief
+ *   The per-thread state checked by \c heim::guarded_allocator on each allocation.
+ *
+ * \details
+ *   Allocations are frozen per thread, so that the threads allowed to allocate (e.g. loading or I/O
+ *   threads) are not reported while the frozen thread runs its steady-state loop. \n
+ *   Stacks are captured with \c backtrace where available, or with \c std::stacktrace if
+ *   \c HEIM_ENABLE_STACKTRACE is defined, in which case its library must be linked as well.
+ */
+class allocation_guard
+{
+private:
+  struct state
+  {
+    bool                              frozen;
+    allocation_guard_mode             mode;
+    std::vector<allocation_violation> violations;
+  };
+
+private:
+  [[nodiscard]] static
+  state &
+  s_state()
+  noexcept
+  {
+    thread_local state local{false, allocation_guard_mode::trap, {}};
+    return local;
+  }
+
+  [[nodiscard]] static
+  std::string
+  s_stack()
+  {
+#if defined(HEIM_ENABLE_STACKTRACE) && defined(__cpp_lib_stacktrace)
+    return std::to_string(std::stacktrace::current(2));
+#elif __has_include(<execinfo.h>)
+    void *frames[64];
+
+    int const    count  {::backtrace(frames, 64)};
+    char **const symbols{::backtrace_symbols(frames, count)};
+
+    if (symbols == nullptr)
+      return "(stack unavailable)\n";
+
+    std::string stack;
+
+    // skips the frames of the guard itself
+    for (int i{2}; i < count; ++i)
+      stack.append(symbols[i]).push_back('\n');
+
+    std::free(symbols);
+    return stack;
+#else
+    return "(stack unavailable)\n";
+#endif
+  }
+
+public:
+  static
+  void
+  freeze(allocation_guard_mode const mode = allocation_guard_mode::trap)
+  noexcept
+  {
+    s_state().frozen = true;
+    s_state().mode   = mode;
+  }
+
+  static
+  void
+  thaw()
+  noexcept
+  { s_state().frozen = false; }
+
+  [[nodiscard]] static
+  bool
+  frozen()
+  noexcept
+  { return s_state().frozen; }
+
+  /*!
+   * \brief
+   *   Returns the allocations recorded on the calling thread while it was frozen in record mode.
+   */
+  [[nodiscard]] static
+  std::vector<allocation_violation> const &
+  violations()
+  noexcept
+  { return s_state().violations; }
+
+  static
+  void
+  clear()
+  noexcept
+  { s_state().violations.clear(); }
+
+  /*!
+   * \brief
+   *   Reports the allocation of the specified number of bytes if allocations are frozen on the calling
+   *   thread.
+   */
+  static
+  void
+  check(std::size_t const bytes)
+  {
+    state &st{s_state()};
+
+    if (!st.frozen)
+      return;
+
+    if (st.mode == allocation_guard_mode::record)
+    {
+      st.violations.push_back(allocation_violation{bytes, s_stack()});
+      return;
+    }
+
+    std::string const stack{s_stack()};
+
+    std::fprintf(stderr, "heim: allocation of %zu bytes while allocations are frozen, at:\n%s", bytes, stack.c_str());
+    std::abort();
+  }
+};
+
+/*!
+ * \brief
+ *   Marks the start of the steady state of the calling thread, after which any allocation made through
+ *   a \c heim::guarded_allocator is trapped or recorded according to the specified mode.
+ */
+inline
+void
+freeze_allocations(allocation_guard_mode const mode = allocation_guard_mode::trap)
+noexcept
+{ allocation_guard::freeze(mode); }
+
+inline
+void
+thaw_allocations()
+noexcept
+{ allocation_guard::thaw(); }
+
+
+/*!
+ * \brief
+ *   An allocator that checks each allocation against the allocation guard of the calling thread, then
+ *   forwards it to the underlying allocator.
+ *
+ * \details
+ *   Is designed to be plugged in a registry to verify its steady-state allocation contract in debug
+ *   builds. Allocations made during constant evaluation are not checked.
+ */
+template<
+    typename T,
+    typename Allocator = std::allocator<T>>
+requires allocator_for<Allocator, T>
+class guarded_allocator
+{
+public:
+  using value_type     = T;
+  using allocator_type = Allocator;
+
+  using propagate_on_container_copy_assignment = typename std::allocator_traits<allocator_type>::propagate_on_container_copy_assignment;
+  using propagate_on_container_move_assignment = typename std::allocator_traits<allocator_type>::propagate_on_container_move_assignment;
+  using propagate_on_container_swap            = typename std::allocator_traits<allocator_type>::propagate_on_container_swap;
+  using is_always_equal                        = typename std::allocator_traits<allocator_type>::is_always_equal;
+
+  template<typename U>
+  struct rebind
+  {
+    using other
+    = guarded_allocator<U, typename std::allocator_traits<allocator_type>::template rebind_alloc<U>>;
+  };
+
+private:
+  [[no_unique_address]]
+  allocator_type m_allocator;
+
+private:
+  static constexpr
+  bool
+  s_noexcept_default_construct()
+  noexcept
+  { return std::is_nothrow_default_constructible_v<allocator_type>; }
+
+public:
+  constexpr
+  guarded_allocator()
+  noexcept(s_noexcept_default_construct())
+  requires std::default_initializable<allocator_type>
+    : m_allocator{}
+  { }
+
+  explicit constexpr
+  guarded_allocator(allocator_type const &alloc)
+  noexcept
+    : m_allocator{alloc}
+  { }
+
+  template<
+      typename U,
+      typename Alloc>
+  requires std::constructible_from<allocator_type, Alloc const &>
+  constexpr
+  guarded_allocator(guarded_allocator<U, Alloc> const &other)
+  noexcept
+    : m_allocator{other.underlying()}
+  { }
+
+  [[nodiscard]] constexpr
+  allocator_type const &
+  underlying() const
+  noexcept
+  { return m_allocator; }
+
+
+  [[nodiscard]] constexpr
+  T *
+  allocate(std::size_t const n)
+  {
+    if !consteval
+    { allocation_guard::check(n * sizeof(T)); }
+
+    return std::to_address(std::allocator_traits<allocator_type>::allocate(m_allocator, n));
+  }
+
+  constexpr
+  void
+  deallocate(T * const ptr, std::size_t const n)
+  noexcept
+  { std::allocator_traits<allocator_type>::deallocate(m_allocator, ptr, n); }
+
+  template<
+      typename U,
+      typename Alloc>
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(guarded_allocator const &lhs, guarded_allocator<U, Alloc> const &rhs)
+  noexcept
+  { return lhs.underlying() == rhs.underlying(); }
+};
+
+} // namespace heim
+
+#endif // HEIM_LIB_GUARDED_ALLOCATOR_HPP
@@ -0,0 +1,127 @@
+#ifndef HEIM_LIB_HASH_HPP
+#define HEIM_LIB_HASH_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace heim
+{
+/*!
+ * \brief
+ *   Mixes the bits of the specified value, so that each bit of the result depends on every bit of the
+ *   value.
+ */
+[[nodiscard]] inline constexpr
+std::uint64_t
+hash_mix(std::uint64_t x)
+noexcept
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  x ^= x >> 31;
+  return x;
+}
+
+/*!
+ * \brief
+ *   Hashes the specified bytes with the specified seed.
+ *
+ * \details
+ *   Reads the bytes as 64-bit words, 32 bytes at a time into four independent lanes, so that the
+ *   multiplications of consecutive words overlap and can be vectorized. The result depends on the
+ *   byte order of the platform.
+ */
+[[nodiscard]] inline
+std::uint64_t
+hash_bytes(void const * const data, std::size_t const size, std::uint64_t const seed = 0)
+noexcept
+{
+  constexpr std::uint64_t prime{0x9e3779b97f4a7c15};
+
+  auto const   *bytes    {static_cast<unsigned char const *>(data)};
+  std::size_t   remaining{size};
+  std::uint64_t hash     {seed ^ (size * prime)};
+
+  auto const round{[](std::uint64_t acc, std::uint64_t const word)
+  {
+    acc = (acc ^ word) * prime;
+    return acc ^ (acc >> 32);
+  }};
+
+  if (remaining >= 32)
+  {
+    std::array<std::uint64_t, 4> lanes{
+        hash ^ 0x243f6a8885a308d3,
+        hash ^ 0x13198a2e03707344,
+        hash ^ 0xa4093822299f31d0,
+        hash ^ 0x082efa98ec4e6c89};
+
+    for (; remaining >= 32; remaining -= 32, bytes += 32)
+    {
+      std::array<std::uint64_t, 4> words;
+      std::memcpy(words.data(), bytes, 32);
+
+      for (std::size_t i{}; i < 4; ++i)
+        lanes[i] = round(lanes[i], words[i]);
+    }
+
+    hash = hash_mix(lanes[0]) ^ hash_mix(lanes[1] + 1) ^ hash_mix(lanes[2] + 2) ^ hash_mix(lanes[3] + 3);
+  }
+
+  for (; remaining >= 8; remaining -= 8, bytes += 8)
+  {
+    std::uint64_t word;
+    std::memcpy(&word, bytes, 8);
+
+    hash = round(hash, word);
+  }
+
+  if (remaining != 0)
+  {
+    std::uint64_t word{};
+    std::memcpy(&word, bytes, remaining);
+
+    hash = round(hash, word);
+  }
+
+  return hash_mix(hash);
+}
+
+
+/*!
+ * \brief
+ *   Determines whether values of the specified type can be hashed through their object
+ *   representation, which are those without padding bytes and the floating-point scalars.
+ */
+template<typename T>
+concept bytewise_hashable
+= std::has_unique_object_representations_v<T> || std::is_floating_point_v<T>;
+
+/*!
+ * \brief
+ *   Hashes the specified values, one after the other, with the specified seed.
+ *
+ * \details
+ *   Is meant for the hash functions of aggregates with padding bytes or with floating-point members,
+ *   which hash their members one by one instead of their object representation, e.g.
+ *   \c hash_values(seed, p.x, p.y) .
+ */
+template<bytewise_hashable ...Ts>
+[[nodiscard]] inline
+std::uint64_t
+hash_values(std::uint64_t seed, Ts const &...values)
+noexcept
+{
+  ((seed = hash_bytes(std::addressof(values), sizeof(Ts), seed)), ...);
+  return seed;
+}
+
+} // namespace heim
+
+#endif // HEIM_LIB_HASH_HPP
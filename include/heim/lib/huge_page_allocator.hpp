@@ -0,0 +1,207 @@
+#ifndef HEIM_LIB_HUGE_PAGE_ALLOCATOR_HPP
+#define HEIM_LIB_HUGE_PAGE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+#include "utility.hpp"
+
+namespace heim
+{
+/*!
+ * \brief
+ *   The size of the huge pages backing the large allocations of \c heim::huge_page_allocator .
+ */
+inline constexpr std::size_t huge_page_size = std::size_t{1} << 21;
+
+
+namespace detail
+{
+[[nodiscard]] constexpr
+std::size_t
+huge_page_round(std::size_t const bytes)
+noexcept
+{ return (bytes + huge_page_size - 1) & ~(huge_page_size - 1); }
+
+// maps the specified number of bytes, a multiple of the huge page size, aligned to the huge page size
+// so that the kernel can back it with huge pages
+[[nodiscard]] inline
+void *
+huge_page_map(std::size_t const bytes)
+{
+  std::size_t const reserved{bytes + huge_page_size};
+  void       *const mapping {::mmap(nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+
+  if (mapping == MAP_FAILED)
+    throw std::bad_alloc{};
+
+  // trims the mapping to its aligned part
+  auto const first{reinterpret_cast<std::uintptr_t>(mapping)};
+  auto const begin{(first + huge_page_size - 1) & ~std::uintptr_t{huge_page_size - 1}};
+
+  if (begin != first)
+    ::munmap(mapping, begin - first);
+  ::munmap(reinterpret_cast<void *>(begin + bytes), first + reserved - (begin + bytes));
+
+#if defined(MADV_HUGEPAGE)
+  ::madvise(reinterpret_cast<void *>(begin), bytes, MADV_HUGEPAGE);
+#endif
+  return reinterpret_cast<void *>(begin);
+}
+
+inline
+void
+huge_page_unmap(void * const ptr, std::size_t const bytes)
+noexcept
+{ ::munmap(ptr, bytes); }
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   An allocator that backs its large allocations with anonymous mappings advised to be backed by
+ *   huge pages, and forwards the others to the underlying allocator.
+ *
+ * \details
+ *   Is designed to be plugged in a registry with millions of entities, whose dense arrays then span
+ *   few TLB entries. Allocations of at least a huge page are rounded up to whole huge pages and
+ *   aligned to them, then advised with \c MADV_HUGEPAGE , which takes effect when transparent huge
+ *   pages are enabled in \c madvise or \c always mode. Smaller allocations, such as the pages of the
+ *   sparse arrays, go to the underlying allocator, as do allocations made during constant evaluation.
+ *
+ * \note
+ *   Rounding to huge pages reserves up to a huge page of address space per large allocation, which
+ *   the kernel commits as the allocation is touched.
+ */
+template<
+    typename T,
+    typename Allocator = std::allocator<T>>
+requires allocator_for<Allocator, T>
+class huge_page_allocator
+{
+public:
+  using value_type     = T;
+  using allocator_type = Allocator;
+  using propagate_on_container_copy_assignment = typename std::allocator_traits<allocator_type>::propagate_on_container_copy_assignment;
+  using propagate_on_container_move_assignment = typename std::allocator_traits<allocator_type>::propagate_on_container_move_assignment;
+  using propagate_on_container_swap            = typename std::allocator_traits<allocator_type>::propagate_on_container_swap;
+  using is_always_equal                        = typename std::allocator_traits<allocator_type>::is_always_equal;
+
+  template<typename U>
+  struct rebind
+  {
+    using other
+    = huge_page_allocator<U, typename std::allocator_traits<allocator_type>::template rebind_alloc<U>>;
+  };
+
+  /*!
+   * \brief
+   *   The number of bytes from which allocations are backed by huge pages.
+   */
+  static constexpr std::size_t threshold
+  = huge_page_size;
+
+  static_assert(
+      alignof(T) <= huge_page_size,
+      "heim::huge_page_allocator: alignof(T) <= huge_page_size;");
+
+private:
+  [[no_unique_address]]
+  allocator_type m_allocator;
+
+private:
+  static constexpr
+  bool
+  s_noexcept_default_construct()
+  noexcept
+  { return std::is_nothrow_default_constructible_v<allocator_type>; }
+
+  // whether the specified number of elements spans at least the threshold, rounding the number of
+  // elements of the threshold up so that no allocation of zero elements is ever large
+  [[nodiscard]] static constexpr
+  bool
+  s_is_large(std::size_t const n)
+  noexcept
+  { return n >= (threshold + sizeof(T) - 1) / sizeof(T); }
+
+public:
+  constexpr
+  huge_page_allocator()
+  noexcept(s_noexcept_default_construct())
+  requires std::default_initializable<allocator_type>
+    : m_allocator{}
+  { }
+
+  explicit constexpr
+  huge_page_allocator(allocator_type const &alloc)
+  noexcept
+    : m_allocator{alloc}
+  { }
+
+  template<
+      typename U,
+      typename Alloc>
+  requires std::constructible_from<allocator_type, Alloc const &>
+  constexpr
+  huge_page_allocator(huge_page_allocator<U, Alloc> const &other)
+  noexcept
+    : m_allocator{other.underlying()}
+  { }
+
+  [[nodiscard]] constexpr
+  allocator_type const &
+  underlying() const
+  noexcept
+  { return m_allocator; }
+
+  [[nodiscard]] constexpr
+  T *
+  allocate(std::size_t const n)
+  {
+    if !consteval
+    {
+      if (s_is_large(n))
+      {
+        if (n > (std::numeric_limits<std::size_t>::max() - 2 * huge_page_size) / sizeof(T))
+          throw std::bad_array_new_length{};
+
+        return static_cast<T *>(detail::huge_page_map(detail::huge_page_round(n * sizeof(T))));
+      }
+    }
+    return std::to_address(std::allocator_traits<allocator_type>::allocate(m_allocator, n));
+  }
+
+  constexpr
+  void
+  deallocate(T * const ptr, std::size_t const n)
+  noexcept
+  {
+    if !consteval
+    {
+      if (s_is_large(n))
+      {
+        detail::huge_page_unmap(ptr, detail::huge_page_round(n * sizeof(T)));
+        return;
+      }
+    }
+    std::allocator_traits<allocator_type>::deallocate(m_allocator, ptr, n);
+  }
+
+  template<
+      typename U,
+      typename Alloc>
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(huge_page_allocator const &lhs, huge_page_allocator<U, Alloc> const &rhs)
+  noexcept
+  { return lhs.underlying() == rhs.underlying(); }
+};
+
+} // namespace heim
+
+#endif // HEIM_LIB_HUGE_PAGE_ALLOCATOR_HPP
@@ -0,0 +1,391 @@
+#ifndef HEIM_LIB_NUMA_ALLOCATOR_HPP
+#define HEIM_LIB_NUMA_ALLOCATOR_HPP
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "utility.hpp"
+
+#if __has_include(<linux/mempolicy.h>) && __has_include(<sys/syscall.h>)
+  #include <linux/mempolicy.h>
+  #include <sys/syscall.h>
+#endif
+
+namespace heim
+{
+namespace detail
+{
+// the number of nodes a node mask passed to the kernel can describe
+inline constexpr int numa_max_nodes = 1024;
+
+[[nodiscard]] inline
+std::size_t
+os_page_size()
+noexcept
+{
+  static std::size_t const size{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+  return size;
+}
+
+[[nodiscard]] inline
+std::size_t
+os_page_round(std::size_t const bytes)
+noexcept
+{ return (bytes + os_page_size() - 1) & ~(os_page_size() - 1); }
+
+// sets the policy of the pages spanning the specified range to prefer the specified node, falling back
+// to the others once it is full, and returns whether the kernel accepted it
+inline
+bool
+numa_prefer(void const * const ptr, std::size_t const bytes, int const node, bool const move)
+noexcept
+{
+#if defined(SYS_mbind)
+  constexpr int digits{std::numeric_limits<unsigned long>::digits};
+
+  if (node < 0 || node >= numa_max_nodes || bytes == 0)
+    return false;
+
+  std::array<unsigned long, numa_max_nodes / digits> mask{};
+
+  mask[static_cast<std::size_t>(node / digits)] = 1UL << (node % digits);
+
+  auto const first{reinterpret_cast<std::uintptr_t>(ptr) & ~std::uintptr_t{os_page_size() - 1}};
+  auto const last {reinterpret_cast<std::uintptr_t>(ptr) + bytes};
+
+  // the kernel reads one bit less than the specified number of nodes
+  return ::syscall(
+      SYS_mbind,
+      first, os_page_round(last - first),
+      MPOL_PREFERRED, mask.data(), mask.size() * digits + 1,
+      move ? MPOL_MF_MOVE : 0) == 0;
+#else
+  static_cast<void>(ptr), static_cast<void>(bytes), static_cast<void>(node), static_cast<void>(move);
+  return false;
+#endif
+}
+
+} // namespace detail
+
+
+/*!
+ * \brief
+ *   Returns the number of nodes of the machine, which is one where nodes cannot be determined.
+ */
+[[nodiscard]] inline
+int
+numa_node_count()
+noexcept
+{
+  static int const count{[]() noexcept
+  {
+    // the online nodes are listed as ranges, the last of which ends with the highest node
+    std::FILE *const file{std::fopen("/sys/devices/system/node/online", "r")};
+    int              last{};
+
+    if (file == nullptr)
+      return 1;
+
+    for (int c{}; (c = std::fgetc(file)) != EOF; )
+    {
+      if (c >= '0' && c <= '9')
+        last = last * 10 + (c - '0');
+      else if (c != '\n')
+        last = 0;
+    }
+    std::fclose(file);
+    return last + 1;
+  }()};
+
+  return count;
+}
+
+/*!
+ * \brief
+ *   Returns the node of the processor running the calling thread, or zero where it cannot be
+ *   determined.
+ */
+[[nodiscard]] inline
+int
+numa_current_node()
+noexcept
+{
+#if defined(SYS_getcpu)
+  unsigned cpu {};
+  unsigned node{};
+
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+    return static_cast<int>(node);
+#endif
+  return 0;
+}
+
+/*!
+ * \brief
+ *   Returns the node holding the page of the specified address, or \c numa_first_touch if that page
+ *   was not touched yet or its node cannot be determined.
+ *
+ * \details
+ *   Does not touch the page. Is meant for the schedulers of parallel queries, which can hand each
+ *   chunk of \c each_chunk to a worker running on the node of its identifiers and components, and
+ *   hand the chunks of unknown nodes to any worker.
+ */
+[[nodiscard]] inline
+int
+numa_node_of(void const * const ptr)
+noexcept
+{
+#if defined(SYS_move_pages)
+  void *page  {const_cast<void *>(ptr)};
+  int   status{-1};
+
+  // without target nodes, the kernel moves nothing and reports the node of each page
+  if (::syscall(SYS_move_pages, 0, 1UL, &page, nullptr, &status, 0) == 0 && status >= 0)
+    return status;
+#else
+  static_cast<void>(ptr);
+#endif
+  return numa_first_touch;
+}
+
+/*!
+ * \brief
+ *   Makes the pages spanning the specified range prefer the specified node, and moves those already
+ *   touched to it, then returns whether the kernel accepted it.
+ *
+ * \details
+ *   Binds an existing pool or shard after the fact, e.g. \c numa_bind(pool.components(), node) .
+ *   Pages shared with neighbouring allocations are bound as well. On a machine with a single node,
+ *   or where the kernel does not support memory policies, does nothing and returns false.
+ */
+inline
+bool
+numa_bind(void const * const ptr, std::size_t const bytes, int const node)
+noexcept
+{ return detail::numa_prefer(ptr, bytes, node, true); }
+
+template<typename Range>
+requires requires (Range const &r) { std::data(r); std::size(r); }
+inline
+bool
+numa_bind(Range const &r, int const node)
+noexcept
+{ return numa_bind(std::data(r), std::size(r) * sizeof(*std::data(r)), node); }
+
+/*!
+ * \brief
+ *   Writes back a byte of each page spanning the specified range from the calling thread, which places
+ *   the pages not yet touched on the node of that thread, and leaves the contents of the range as
+ *   they were.
+ *
+ * \details
+ *   Is meant to be called by the worker that will own a chunk of a pool allocated with
+ *   \c numa_first_touch , e.g. \c numa_touch(std::span{pool.components()}.subspan(first, count)) ,
+ *   before any other thread writes to it. Pages already touched stay where they are, see
+ *   \c numa_bind to move them. Must not race with writes to the range.
+ */
+inline
+void
+numa_touch(void * const ptr, std::size_t const bytes)
+noexcept
+{
+  if (bytes == 0)
+    return;
+
+  auto const first{reinterpret_cast<std::uintptr_t>(ptr)};
+  auto const last {first + bytes};
+
+  // the first byte of the range, then the first byte of each of the following pages
+  for (auto addr{first}; addr < last; addr = (addr & ~std::uintptr_t{detail::os_page_size() - 1}) + detail::os_page_size())
+  {
+    auto * const byte{reinterpret_cast<unsigned char volatile *>(addr)};
+    *byte = *byte;
+  }
+}
+
+template<typename Range>
+requires requires (Range &r) { std::data(r); std::size(r); }
+inline
+void
+numa_touch(Range &&r)
+noexcept
+{ numa_touch(static_cast<void *>(std::data(r)), std::size(r) * sizeof(*std::data(r))); }
+
+
+/*!
+ * \brief
+ *   An allocator that backs its large allocations with anonymous mappings preferring the specified
+ *   node, and forwards the others to the underlying allocator.
+ *
+ * \details
+ *   Is designed to bind the dense arrays of a registry, or of each shard of a partitioned world, to
+ *   the node of the workers iterating it, while a descriptor of the registry can bind a single pool to
+ *   another node, see \c generic_static_registry::with . Allocations of at least \c threshold bytes are mapped and
+ *   advised to prefer the node of the allocator, the kernel falling back to the other nodes once it
+ *   is full, so that a single-node machine behaves as with no policy. Their pages are only placed once
+ *   touched: with \c numa_first_touch , reserving a container from any thread and filling it, or
+ *   touching it with \c numa_touch , from the worker owning it places its pages on the node of that
+ *   worker. \n
+ *   Smaller allocations, such as the pages of the sparse arrays, go to the underlying allocator, as do
+ *   allocations made during constant evaluation. Allocators of different nodes compare unequal and
+ *   propagate with their containers, so that a container keeps its storage and its node when moved.
+ */
+template<
+    typename T,
+    typename Allocator = std::allocator<T>>
+requires allocator_for<Allocator, T>
+class numa_allocator
+{
+public:
+  using value_type     = T;
+  using allocator_type = Allocator;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap            = std::true_type;
+  using is_always_equal                        = std::false_type;
+
+  template<typename U>
+  struct rebind
+  {
+    using other
+    = numa_allocator<U, typename std::allocator_traits<allocator_type>::template rebind_alloc<U>>;
+  };
+
+  /*!
+   * \brief
+   *   The number of bytes from which allocations are mapped with the policy of the allocator.
+   */
+  static constexpr std::size_t threshold
+  = std::size_t{1} << 16;
+
+private:
+  [[no_unique_address]]
+  allocator_type m_allocator;
+  int            m_node;
+
+private:
+  static constexpr
+  bool
+  s_noexcept_default_construct()
+  noexcept
+  { return std::is_nothrow_default_constructible_v<allocator_type>; }
+
+  // whether the specified number of elements spans at least the threshold, rounding the number of
+  // elements of the threshold up so that no allocation of zero elements is ever large
+  [[nodiscard]] static constexpr
+  bool
+  s_is_large(std::size_t const n)
+  noexcept
+  { return n >= (threshold + sizeof(T) - 1) / sizeof(T); }
+
+public:
+  constexpr
+  numa_allocator()
+  noexcept(s_noexcept_default_construct())
+  requires std::default_initializable<allocator_type>
+    : m_allocator{}
+    , m_node     {numa_first_touch}
+  { }
+
+  explicit constexpr
+  numa_allocator(int const node)
+  noexcept(s_noexcept_default_construct())
+  requires std::default_initializable<allocator_type>
+    : m_allocator{}
+    , m_node     {node}
+  { }
+
+  constexpr
+  numa_allocator(int const node, allocator_type const &alloc)
+  noexcept
+    : m_allocator{alloc}
+    , m_node     {node}
+  { }
+
+  template<
+      typename U,
+      typename Alloc>
+  requires std::constructible_from<allocator_type, Alloc const &>
+  constexpr
+  numa_allocator(numa_allocator<U, Alloc> const &other)
+  noexcept
+    : m_allocator{other.underlying()}
+    , m_node     {other.node()}
+  { }
+
+  [[nodiscard]] constexpr
+  allocator_type const &
+  underlying() const
+  noexcept
+  { return m_allocator; }
+
+  [[nodiscard]] constexpr
+  int
+  node() const
+  noexcept
+  { return m_node; }
+
+  [[nodiscard]] constexpr
+  T *
+  allocate(std::size_t const n)
+  {
+    if !consteval
+    {
+      if (s_is_large(n))
+      {
+        if (n > (std::numeric_limits<std::size_t>::max() - detail::os_page_size()) / sizeof(T))
+          throw std::bad_array_new_length{};
+
+        std::size_t const bytes  {detail::os_page_round(n * sizeof(T))};
+        void       *const mapping{::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)};
+
+        if (mapping == MAP_FAILED)
+          throw std::bad_alloc{};
+
+        // failing to set the policy leaves the pages to the node of the thread touching them first
+        if (m_node != numa_first_touch)
+          detail::numa_prefer(mapping, bytes, m_node, false);
+        return static_cast<T *>(mapping);
+      }
+    }
+    return std::to_address(std::allocator_traits<allocator_type>::allocate(m_allocator, n));
+  }
+
+  constexpr
+  void
+  deallocate(T * const ptr, std::size_t const n)
+  noexcept
+  {
+    if !consteval
+    {
+      if (s_is_large(n))
+      {
+        ::munmap(ptr, detail::os_page_round(n * sizeof(T)));
+        return;
+      }
+    }
+    std::allocator_traits<allocator_type>::deallocate(m_allocator, ptr, n);
+  }
+
+  template<
+      typename U,
+      typename Alloc>
+  [[nodiscard]] friend constexpr
+  bool
+  operator==(numa_allocator const &lhs, numa_allocator<U, Alloc> const &rhs)
+  noexcept
+  { return lhs.node() == rhs.node() && lhs.underlying() == rhs.underlying(); }
+};
+
+} // namespace heim
+
+#endif // HEIM_LIB_NUMA_ALLOCATOR_HPP
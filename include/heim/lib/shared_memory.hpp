@@ -0,0 +1,1022 @@
+#ifndef HEIM_LIB_SHARED_MEMORY_HPP
+#define HEIM_LIB_SHARED_MEMORY_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "hash.hpp"
+
+namespace heim
+{
+/*!
+ * \brief
+ *   A pointer storing the offset of its pointee from its own address, which stays valid when the
+ *   memory holding both of them is mapped at different addresses.
+ *
+ * \details
+ *   Is designed to be used as the \c pointer type of allocators of shared memory, so that the
+ *   containers built in a segment can be used from any process mapping it. Copies recompute their
+ *   offset from their own address.
+ */
+template<typename T>
+class offset_ptr
+{
+  template<typename>
+  friend class offset_ptr;
+
+public:
+  using element_type      = T;
+  using value_type        = std::remove_cv_t<T>;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = T *;
+  using reference         = std::add_lvalue_reference_t<T>;
+  using iterator_category = std::random_access_iterator_tag;
+  using iterator_concept  = std::contiguous_iterator_tag;
+
+  template<typename U>
+  using rebind
+  = offset_ptr<U>;
+
+private:
+  // an offset of one never points to a suitably aligned object, hence denotes the null pointer
+  static constexpr std::intptr_t s_null = 1;
+
+private:
+  std::intptr_t m_offset;
+
+private:
+  void
+  m_assign(T * const ptr)
+  noexcept
+  {
+    m_offset
+    = ptr == nullptr
+    ? s_null
+    : reinterpret_cast<std::intptr_t>(ptr) - reinterpret_cast<std::intptr_t>(this);
+  }
+
+public:
+  offset_ptr()
+  noexcept
+    : m_offset{s_null}
+  { }
+
+  offset_ptr(std::nullptr_t)
+  noexcept
+    : m_offset{s_null}
+  { }
+
+  offset_ptr(T * const ptr)
+  noexcept
+    : m_offset{}
+  { m_assign(ptr); }
+
+  offset_ptr(offset_ptr const &other)
+  noexcept
+    : m_offset{}
+  { m_assign(other.get()); }
+
+  template<typename U>
+  requires std::convertible_to<U *, T *>
+  offset_ptr(offset_ptr<U> const &other)
+  noexcept
+    : m_offset{}
+  { m_assign(other.get()); }
+
+  template<typename U>
+  requires (
+     !std::convertible_to<U *, T *>
+   && requires (U *ptr) { static_cast<T *>(ptr); })
+  explicit
+  offset_ptr(offset_ptr<U> const &other)
+  noexcept
+    : m_offset{}
+  { m_assign(static_cast<T *>(other.get())); }
+
+  ~offset_ptr()
+  = default;
+
+  offset_ptr &
+  operator=(offset_ptr const &other)
+  noexcept
+  {
+    m_assign(other.get());
+    return *this;
+  }
+
+  offset_ptr &
+  operator=(T * const ptr)
+  noexcept
+  {
+    m_assign(ptr);
+    return *this;
+  }
+
+  offset_ptr &
+  operator=(std::nullptr_t)
+  noexcept
+  {
+    m_offset = s_null;
+    return *this;
+  }
+
+  [[nodiscard]]
+  T *
+  get() const
+  noexcept
+  {
+    if (m_offset == s_null)
+      return nullptr;
+
+    return reinterpret_cast<T *>(reinterpret_cast<std::intptr_t>(this) + m_offset);
+  }
+
+  [[nodiscard]] static
+  offset_ptr
+  pointer_to(reference r)
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return offset_ptr{std::addressof(r)}; }
+
+  explicit
+  operator bool() const
+  noexcept
+  { return m_offset != s_null; }
+
+
+  [[nodiscard]]
+  reference
+  operator*() const
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return *get(); }
+
+  [[nodiscard]]
+  T *
+  operator->() const
+  noexcept
+  { return get(); }
+
+  [[nodiscard]]
+  reference
+  operator[](difference_type const n) const
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return get()[n]; }
+
+  offset_ptr &
+  operator++()
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return *this += 1; }
+
+  offset_ptr
+  operator++(int)
+  noexcept
+  requires (!std::is_void_v<T>)
+  {
+    offset_ptr tmp{*this};
+    ++*this;
+    return tmp;
+  }
+
+  offset_ptr &
+  operator--()
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return *this -= 1; }
+
+  offset_ptr
+  operator--(int)
+  noexcept
+  requires (!std::is_void_v<T>)
+  {
+    offset_ptr tmp{*this};
+    --*this;
+    return tmp;
+  }
+
+  offset_ptr &
+  operator+=(difference_type const n)
+  noexcept
+  requires (!std::is_void_v<T>)
+  {
+    m_offset += n * static_cast<difference_type>(sizeof(T));
+    return *this;
+  }
+
+  offset_ptr &
+  operator-=(difference_type const n)
+  noexcept
+  requires (!std::is_void_v<T>)
+  {
+    m_offset -= n * static_cast<difference_type>(sizeof(T));
+    return *this;
+  }
+
+  [[nodiscard]] friend
+  offset_ptr
+  operator+(offset_ptr const &ptr, difference_type const n)
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return offset_ptr{ptr.get() + n}; }
+
+  [[nodiscard]] friend
+  offset_ptr
+  operator+(difference_type const n, offset_ptr const &ptr)
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return offset_ptr{ptr.get() + n}; }
+
+  [[nodiscard]] friend
+  offset_ptr
+  operator-(offset_ptr const &ptr, difference_type const n)
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return offset_ptr{ptr.get() - n}; }
+
+  [[nodiscard]] friend
+  difference_type
+  operator-(offset_ptr const &lhs, offset_ptr const &rhs)
+  noexcept
+  requires (!std::is_void_v<T>)
+  { return lhs.get() - rhs.get(); }
+
+  [[nodiscard]] friend
+  bool
+  operator==(offset_ptr const &lhs, offset_ptr const &rhs)
+  noexcept
+  { return lhs.get() == rhs.get(); }
+
+  [[nodiscard]] friend
+  bool
+  operator==(offset_ptr const &ptr, std::nullptr_t)
+  noexcept
+  { return !ptr; }
+
+  [[nodiscard]] friend
+  std::strong_ordering
+  operator<=>(offset_ptr const &lhs, offset_ptr const &rhs)
+  noexcept
+  { return std::compare_three_way{}(lhs.get(), rhs.get()); }
+};
+
+
+/*!
+ * \brief
+ *   The header of the arena of a shared memory segment, which allocates the rest of the arena and
+ *   holds its root object, the generation of its state and the slots of the processes reading it.
+ *
+ * \details
+ *   Blocks are rounded up to powers of two from 16 bytes and recycled through one free list per size,
+ *   whose links are offsets from the arena. Allocations must only be made by the process that created
+ *   the segment, in its write sections.
+ */
+class shared_memory_arena
+{
+  friend class shared_memory_segment;
+
+public:
+  static constexpr std::size_t max_alignment = 16;
+  static constexpr std::size_t max_readers   = 64;
+
+private:
+  static constexpr std::uint64_t s_magic       = 0x6865696d2d73686d; // "heim-shm"
+  static constexpr std::size_t   s_class_count = 48;
+  static constexpr std::size_t   s_block_size  = 16;
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<pid_t>        ::is_always_lock_free);
+
+  // the slot of a reading process, on a cache line of its own
+  struct alignas(64) reader_slot
+  {
+    std::atomic<pid_t>         pid;     // the process holding the slot, or zero if it is free
+    std::atomic<std::uint64_t> epoch;   // the generation read by the read section in flight, or zero
+    std::atomic<bool>          waiting; // whether the reader waited for a write section
+  };
+
+private:
+  std::uint64_t              m_magic;
+  std::uint64_t              m_size;
+  std::uint64_t              m_header_size;
+  std::atomic<std::uint64_t> m_generation;
+  std::uint64_t              m_top;
+  std::uint64_t              m_root;
+  std::uint64_t              m_root_size;
+  std::uint64_t              m_root_type;
+
+  std::array<std::uint64_t, s_class_count> m_free;
+  std::array<reader_slot, max_readers>     m_readers;
+
+private:
+  [[nodiscard]]
+  std::byte *
+  m_base()
+  noexcept
+  { return reinterpret_cast<std::byte *>(this); }
+
+  [[nodiscard]]
+  std::byte const *
+  m_base() const
+  noexcept
+  { return reinterpret_cast<std::byte const *>(this); }
+
+  // the digest identifying the type of the root object across the processes built from the same
+  // sources
+  template<typename T>
+  [[nodiscard]] static
+  std::uint64_t
+  s_type_digest()
+  noexcept
+  {
+    std::string_view const name{typeid(T).name()};
+    return hash_bytes(name.data(), name.size(), sizeof(T));
+  }
+
+  // the generations are even between write sections and odd during them, and start above zero so that
+  // a zero epoch denotes a reader out of any read section
+  shared_memory_arena(std::size_t const size, std::size_t const header_size)
+  noexcept
+    : m_magic      {s_magic}
+    , m_size       {size}
+    , m_header_size{header_size}
+    , m_generation {2}
+    , m_top        {header_size}
+    , m_root       {}
+    , m_root_size  {}
+    , m_root_type  {}
+    , m_free       {}
+    , m_readers    {}
+  { }
+
+  // returns the root object of the specializing type, or a null pointer if the arena holds none
+  template<typename T>
+  [[nodiscard]]
+  T const *
+  m_root_as() const
+  noexcept
+  {
+    if (m_magic != s_magic || m_root == 0 || m_root_size != sizeof(T) || m_root_type != s_type_digest<T>()
+     || m_root > m_size || m_size - m_root < sizeof(T))
+      return nullptr;
+
+    return std::launder(reinterpret_cast<T const *>(m_base() + m_root));
+  }
+
+  // frees the specified slot if the process holding it is gone, and returns whether the slot is free
+  [[nodiscard]]
+  bool
+  m_reclaim(reader_slot &slot)
+  noexcept
+  {
+    pid_t pid{slot.pid.load(std::memory_order_acquire)};
+
+    if (pid == 0)
+      return true;
+
+    if (::kill(pid, 0) == 0 || errno != ESRCH)
+      return false;
+
+    slot.epoch  .store(0    , std::memory_order_relaxed);
+    slot.waiting.store(false, std::memory_order_relaxed);
+    return slot.pid.compare_exchange_strong(pid, 0, std::memory_order_acq_rel);
+  }
+
+  // lets every reader that waited for a write section run a read section, then makes the generation odd
+  // and waits for the read sections in flight to end, so that readers can neither be starved by
+  // back-to-back write sections nor access the arena while it is modified
+  void
+  m_begin_write()
+  noexcept
+  {
+    for (reader_slot &slot : m_readers)
+      while (slot.waiting.load(std::memory_order_seq_cst) && !m_reclaim(slot))
+        std::this_thread::yield();
+
+    m_generation.store(m_generation.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+
+    for (reader_slot &slot : m_readers)
+      while (slot.epoch.load(std::memory_order_seq_cst) != 0 && !m_reclaim(slot))
+        std::this_thread::yield();
+  }
+
+  void
+  m_end_write()
+  noexcept
+  { m_generation.store(m_generation.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+public:
+  shared_memory_arena(shared_memory_arena const &)
+  = delete;
+
+  shared_memory_arena &
+  operator=(shared_memory_arena const &)
+  = delete;
+
+  [[nodiscard]]
+  std::size_t
+  size() const
+  noexcept
+  { return m_size; }
+
+  /*!
+   * \brief
+   *   Returns the number of bytes of the segment never allocated so far, free lists excluded.
+   */
+  [[nodiscard]]
+  std::size_t
+  available() const
+  noexcept
+  { return m_size - m_top; }
+
+  /*!
+   * \brief
+   *   Allocates a block of at least the specified number of bytes, aligned on \c max_alignment bytes.
+   *
+   * \details
+   *   Throws \c std::bad_alloc if the segment is exhausted.
+   */
+  [[nodiscard]]
+  void *
+  allocate(std::size_t const bytes)
+  {
+    std::size_t const cls{static_cast<std::size_t>(std::bit_width((std::max(bytes, s_block_size) - 1) / s_block_size))};
+
+    if (cls >= s_class_count)
+      throw std::bad_alloc{};
+
+    if (std::uint64_t const head{m_free[cls]}; head != 0)
+    {
+      std::memcpy(&m_free[cls], m_base() + head, sizeof(std::uint64_t));
+      return m_base() + head;
+    }
+
+    // each block is preceded by a header holding its size class
+    std::size_t const size{s_block_size + (s_block_size << cls)};
+
+    if (size > m_size - m_top)
+      throw std::bad_alloc{};
+
+    std::byte *const block{m_base() + m_top};
+
+    std::memcpy(block, &cls, sizeof(std::size_t));
+    m_top += size;
+    return block + s_block_size;
+  }
+
+  void
+  deallocate(void * const ptr)
+  noexcept
+  {
+    if (ptr == nullptr)
+      return;
+
+    auto *const   block {static_cast<std::byte *>(ptr)};
+    std::uint64_t offset{static_cast<std::uint64_t>(block - m_base())};
+    std::size_t   cls;
+
+    std::memcpy(&cls, block - s_block_size, sizeof(std::size_t));
+    std::memcpy(block, &m_free[cls], sizeof(std::uint64_t));
+    m_free[cls] = offset;
+  }
+};
+
+
+/*!
+ * \brief
+ *   An allocator of the memory of a shared memory segment, whose pointers are offset pointers.
+ *
+ * \details
+ *   Containers using it can be built in a segment by one process and read by any process mapping the
+ *   segment, at any address. The alignment of the allocated type must not exceed
+ *   \c shared_memory_arena::max_alignment .
+ */
+template<typename T>
+class shared_memory_allocator
+{
+  template<typename>
+  friend class shared_memory_allocator;
+
+  static_assert(
+      alignof(T) <= shared_memory_arena::max_alignment,
+      "heim::shared_memory_allocator: the alignment of the allocated type is too large.");
+
+public:
+  using value_type         = T;
+  using pointer            = offset_ptr<T>;
+  using const_pointer      = offset_ptr<T const>;
+  using void_pointer       = offset_ptr<void>;
+  using const_void_pointer = offset_ptr<void const>;
+  using size_type          = std::size_t;
+  using difference_type    = std::ptrdiff_t;
+
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap            = std::true_type;
+  using is_always_equal                        = std::false_type;
+
+private:
+  offset_ptr<shared_memory_arena> m_arena;
+
+public:
+  explicit
+  shared_memory_allocator(shared_memory_arena &arena)
+  noexcept
+    : m_arena{&arena}
+  { }
+
+  template<typename U>
+  shared_memory_allocator(shared_memory_allocator<U> const &other)
+  noexcept
+    : m_arena{other.m_arena}
+  { }
+
+  [[nodiscard]]
+  shared_memory_arena &
+  arena() const
+  noexcept
+  { return *m_arena; }
+
+  [[nodiscard]]
+  pointer
+  allocate(std::size_t const n)
+  {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length{};
+
+    return pointer{static_cast<T *>(m_arena->allocate(n * sizeof(T)))};
+  }
+
+  void
+  deallocate(pointer const ptr, std::size_t const)
+  noexcept
+  { m_arena->deallocate(ptr.get()); }
+
+  template<typename U>
+  [[nodiscard]] friend
+  bool
+  operator==(shared_memory_allocator const &lhs, shared_memory_allocator<U> const &rhs)
+  noexcept
+  { return lhs.m_arena == rhs.m_arena; }
+};
+
+
+/*!
+ * \brief
+ *   A mapping of a named POSIX shared memory segment, holding a root object allocated with
+ *   \c heim::shared_memory_allocator .
+ *
+ * \details
+ *   The creating process maps the segment read-write and is its only writer. Other processes attach it
+ *   read-only, but for the header of the arena, where each of them holds a reader slot. \n
+ *   Readers query the arena in place, and no copy of it is ever made. The writer makes the generation
+ *   of the arena odd for the duration of each write section, after waiting for the read sections in
+ *   flight, whose epochs are in the slots of the readers. A read section announces the even generation
+ *   it reads, checks that it did not change meanwhile, then runs its function on the root. Hence read
+ *   sections never observe a state being modified, and write sections wait for one read section of
+ *   each reader at most. \n
+ *   A reader that had to wait for a write section is let through before the next one starts, hence
+ *   cannot be starved by back-to-back write sections. Slots are reclaimed from the readers whose
+ *   process is gone, hence readers must run in the PID namespace of the writer.
+ */
+class shared_memory_segment
+{
+private:
+  std::string m_name;
+  void       *m_address;
+  std::size_t m_size;
+  std::size_t m_slot;
+  bool        m_writable;
+
+private:
+  shared_memory_segment(std::string_view const name, void * const address, std::size_t const size, bool const writable)
+    : m_name    {name}
+    , m_address {address}
+    , m_size    {size}
+    , m_slot    {shared_memory_arena::max_readers}
+    , m_writable{writable}
+  { }
+
+  [[noreturn]] static
+  void
+  s_throw(char const * const what)
+  { throw std::system_error{errno, std::generic_category(), what}; }
+
+  [[nodiscard]]
+  shared_memory_arena &
+  m_arena() const
+  noexcept
+  { return *static_cast<shared_memory_arena *>(m_address); }
+
+  // frees the reader slot of the segment, if it holds one
+  void
+  m_release()
+  noexcept
+  {
+    if (m_slot == shared_memory_arena::max_readers)
+      return;
+
+    auto &slot{m_arena().m_readers[m_slot]};
+
+    slot.epoch  .store(0    , std::memory_order_relaxed);
+    slot.waiting.store(false, std::memory_order_relaxed);
+    slot.pid    .store(0    , std::memory_order_release);
+    m_slot = shared_memory_arena::max_readers;
+  }
+
+public:
+  shared_memory_segment(shared_memory_segment const &)
+  = delete;
+
+  shared_memory_segment(shared_memory_segment &&other)
+  noexcept
+    : m_name    {std::move(other.m_name)}
+    , m_address {std::exchange(other.m_address, nullptr)}
+    , m_size    {std::exchange(other.m_size, 0)}
+    , m_slot    {std::exchange(other.m_slot, shared_memory_arena::max_readers)}
+    , m_writable{other.m_writable}
+  { }
+
+  ~shared_memory_segment()
+  {
+    if (m_address == nullptr)
+      return;
+
+    m_release();
+    ::munmap(m_address, m_size);
+  }
+
+  shared_memory_segment &
+  operator=(shared_memory_segment const &)
+  = delete;
+
+  shared_memory_segment &
+  operator=(shared_memory_segment &&other)
+  noexcept
+  {
+    shared_memory_segment tmp{std::move(other)};
+
+    std::swap(m_name    , tmp.m_name);
+    std::swap(m_address , tmp.m_address);
+    std::swap(m_size    , tmp.m_size);
+    std::swap(m_slot    , tmp.m_slot);
+    std::swap(m_writable, tmp.m_writable);
+    return *this;
+  }
+
+  /*!
+   * \brief
+   *   Creates and maps read-write the segment of the specified name, whose arena has the specified
+   *   size, and which must not exist.
+   *
+   * \details
+   *   The segment is as large as the arena, whose pages are only backed once written, and whose header
+   *   takes whole pages so that readers can write their slots only. Throws \c std::system_error if the
+   *   segment cannot be created or mapped.
+   */
+  [[nodiscard]] static
+  shared_memory_segment
+  create(std::string_view const name, std::size_t size)
+  {
+    auto const        page  {static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+    std::size_t const header{(sizeof(shared_memory_arena) + page - 1) / page * page};
+
+    size = (std::max(size, header) + shared_memory_arena::max_alignment - 1)
+         / shared_memory_arena::max_alignment * shared_memory_arena::max_alignment;
+
+    if (size > static_cast<std::size_t>(std::numeric_limits<off_t>::max()))
+    {
+      errno = EINVAL;
+      s_throw("heim::shared_memory_segment::create: size");
+    }
+
+    std::string const path{name};
+    int const         fd  {::shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)};
+
+    if (fd == -1)
+      s_throw("heim::shared_memory_segment::create: shm_open");
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) == -1)
+    {
+      int const error{errno};
+
+      ::close(fd);
+      ::shm_unlink(path.c_str());
+      errno = error;
+      s_throw("heim::shared_memory_segment::create: ftruncate");
+    }
+
+    void *const address{::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+    int const   error  {errno};
+
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+      ::shm_unlink(path.c_str());
+      errno = error;
+      s_throw("heim::shared_memory_segment::create: mmap");
+    }
+
+    ::new(address) shared_memory_arena{size, header};
+    return shared_memory_segment{name, address, size, true};
+  }
+
+  /*!
+   * \brief
+   *   Maps the existing segment of the specified name, read-only but for the header of its arena, and
+   *   takes a reader slot in it.
+   *
+   * \details
+   *   Throws \c std::system_error if the segment cannot be opened or mapped, was not created by
+   *   \c create , or has \c shared_memory_arena::max_readers readers already. The slots of the readers
+   *   whose process is gone are reclaimed.
+   */
+  [[nodiscard]] static
+  shared_memory_segment
+  attach(std::string_view const name)
+  {
+    std::string const path{name};
+    int const         fd  {::shm_open(path.c_str(), O_RDWR, 0)};
+
+    if (fd == -1)
+      s_throw("heim::shared_memory_segment::attach: shm_open");
+
+    struct stat st{};
+
+    if (::fstat(fd, &st) == -1)
+    {
+      int const error{errno};
+
+      ::close(fd);
+      errno = error;
+      s_throw("heim::shared_memory_segment::attach: fstat");
+    }
+
+    auto const  size   {static_cast<std::size_t>(st.st_size)};
+    void *const address{size < sizeof(shared_memory_arena) ? MAP_FAILED : ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+    int const   error  {size < sizeof(shared_memory_arena) ? EINVAL : errno};
+
+    ::close(fd);
+    if (address == MAP_FAILED)
+    {
+      errno = error;
+      s_throw("heim::shared_memory_segment::attach: mmap");
+    }
+
+    shared_memory_segment segment{name, address, size, false};
+    shared_memory_arena  &arena  {segment.m_arena()};
+
+    auto const page{static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))};
+
+    if (arena.m_magic != shared_memory_arena::s_magic
+     || arena.m_size  != size
+     || arena.m_header_size < sizeof(shared_memory_arena) || arena.m_header_size > size || arena.m_header_size % page != 0)
+    {
+      errno = EINVAL;
+      s_throw("heim::shared_memory_segment::attach: not a heim segment");
+    }
+
+    if (::mprotect(address, arena.m_header_size, PROT_READ | PROT_WRITE) == -1)
+      s_throw("heim::shared_memory_segment::attach: mprotect");
+
+    for (std::size_t idx{}; idx < shared_memory_arena::max_readers && segment.m_slot == shared_memory_arena::max_readers; ++idx)
+    {
+      pid_t expected{0};
+
+      if (arena.m_reclaim(arena.m_readers[idx]) && arena.m_readers[idx].pid.compare_exchange_strong(expected, ::getpid(), std::memory_order_acq_rel))
+        segment.m_slot = idx;
+    }
+
+    if (segment.m_slot == shared_memory_arena::max_readers)
+    {
+      errno = EAGAIN;
+      s_throw("heim::shared_memory_segment::attach: too many readers");
+    }
+
+    return segment;
+  }
+
+  /*!
+   * \brief
+   *   Removes the name of the specified segment, which is destroyed once every process unmapped it.
+   */
+  static
+  void
+  remove(std::string_view const name)
+  noexcept
+  { ::shm_unlink(std::string{name}.c_str()); }
+
+  [[nodiscard]]
+  std::string const &
+  name() const
+  noexcept
+  { return m_name; }
+
+  [[nodiscard]]
+  bool
+  writable() const
+  noexcept
+  { return m_writable; }
+
+  [[nodiscard]]
+  shared_memory_arena const &
+  arena() const
+  noexcept
+  { return m_arena(); }
+
+  template<typename T = std::byte>
+  [[nodiscard]]
+  shared_memory_allocator<T>
+  get_allocator() const
+  noexcept
+  { return shared_memory_allocator<T>{m_arena()}; }
+
+
+  /*!
+   * \brief
+   *   Constructs the root object of the segment with the specified arguments in a write section, and
+   *   returns it.
+   *
+   * \details
+   *   Must only be called once, by the process that created the segment, which modifies the root
+   *   through the returned reference in write sections.
+   */
+  template<
+      typename    T,
+      typename ...Args>
+  T &
+  construct(Args &&...args)
+  {
+    return write([&]() -> T &
+    {
+      shared_memory_arena &arena{m_arena()};
+      void *const          ptr  {arena.allocate(sizeof(T))};
+
+      T *obj;
+
+      try
+      { obj = ::new(ptr) T(std::forward<Args>(args)...); }
+      catch (...)
+      { arena.deallocate(ptr); throw; }
+
+      arena.m_root      = static_cast<std::uint64_t>(static_cast<std::byte *>(ptr) - arena.m_base());
+      arena.m_root_size = sizeof(T);
+      arena.m_root_type = shared_memory_arena::s_type_digest<T>();
+      return *obj;
+    });
+  }
+
+  /*!
+   * \brief
+   *   Returns the root object of the arena of the segment, or a null pointer if it was not constructed
+   *   or is not of the specializing type.
+   *
+   * \details
+   *   Is meant for the writer: the arena may be modified at any time, hence readers access the root
+   *   through \c read instead.
+   */
+  template<typename T>
+  [[nodiscard]]
+  T const *
+  root() const
+  noexcept
+  { return m_arena().template m_root_as<T>(); }
+
+
+  /*!
+   * \brief
+   *   Returns the number of write sections completed so far, which readers can compare between read
+   *   sections to skip those with nothing new.
+   */
+  [[nodiscard]]
+  std::uint64_t
+  sequence() const
+  noexcept
+  { return (m_arena().m_generation.load(std::memory_order_acquire) - 2) / 2; }
+
+  /*!
+   * \brief
+   *   Invokes the specified function in a write section, and returns its result.
+   *
+   * \details
+     *   The section starts once the read sections in flight ended, and ends even if the function throws,
+   *   the state it left being then read as is.
+   */
+  template<typename F>
+  decltype(auto)
+  write(F &&f)
+  {
+    struct section
+    {
+      shared_memory_arena &arena;
+
+      ~section()
+      { arena.m_end_write(); }
+    };
+
+    m_arena().m_begin_write();
+
+    section const guard{m_arena()};
+    return std::invoke(std::forward<F>(f));
+  }
+
+  /*!
+   * \brief
+   *   Invokes the specified function on the root object of the arena in a read section, and returns
+   *   whether the arena held a root of the specializing type.
+   *
+   * \details
+   *   The function is invoked in place, on a state no write section modifies meanwhile, and the
+   *   references into the arena must not be kept after the section. A segment must not be read from
+   *   several threads at once, nor from within a write section of the same process.
+   */
+  template<
+      typename T,
+      typename F>
+  requires std::invocable<F &, T const &>
+  bool
+  read(F &&f) const
+  {
+    shared_memory_arena &arena{m_arena()};
+
+    // the writer never modifies the arena concurrently with itself
+    if (m_writable)
+    {
+      T const *const root{arena.template m_root_as<T>()};
+
+      if (root == nullptr)
+        return false;
+
+      std::invoke(f, *root);
+      return true;
+    }
+
+    struct section
+    {
+      shared_memory_arena::reader_slot &slot;
+
+      ~section()
+      {
+        slot.epoch  .store(0    , std::memory_order_release);
+        slot.waiting.store(false, std::memory_order_release);
+      }
+    };
+
+    section const guard{arena.m_readers[m_slot]};
+
+    for (;;)
+    {
+      std::uint64_t const generation{arena.m_generation.load(std::memory_order_acquire)};
+
+      if (generation % 2 != 0)
+      {
+        guard.slot.waiting.store(true, std::memory_order_seq_cst);
+        std::this_thread::yield();
+        continue;
+      }
+
+      // either the writer sees the epoch and waits for the section, or the section sees the writer
+      guard.slot.epoch.store(generation, std::memory_order_seq_cst);
+      if (arena.m_generation.load(std::memory_order_seq_cst) == generation)
+      {
+        T const *const root{arena.template m_root_as<T>()};
+
+        if (root != nullptr)
+          std::invoke(f, *root);
+
+        return root != nullptr;
+      }
+
+      guard.slot.epoch  .store(0   , std::memory_order_release);
+      guard.slot.waiting.store(true, std::memory_order_seq_cst);
+    }
+  }
+};
+
+} // namespace heim
+
+#endif // HEIM_LIB_SHARED_MEMORY_HPP
@@ -0,0 +1,155 @@
+#ifndef HEIM_LIB_SPSC_RING_HPP
+#define HEIM_LIB_SPSC_RING_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace heim
+{
+/*!
+ * \brief
+ *   A lock-free single-producer single-consumer ring of bytes.
+ *
+ * \details
+ *   The producer writes bytes at the tail of the ring and the consumer reads them from its head, each
+ *   side only loading the position of the other one when its cached copy of it does not allow it to
+ *   proceed. The capacity is rounded up to a power of two.
+ */
+class spsc_ring
+{
+private:
+  std::unique_ptr<std::byte[]> m_buffer;
+  std::size_t                  m_mask;
+
+  alignas(64)
+  std::atomic<std::size_t> m_head;
+  std::size_t              m_cached_tail;
+
+  alignas(64)
+  std::atomic<std::size_t> m_tail;
+  std::size_t              m_cached_head;
+
+public:
+  explicit
+  spsc_ring(std::size_t const capacity)
+    : m_buffer     {std::make_unique_for_overwrite<std::byte[]>(std::bit_ceil(std::max<std::size_t>(capacity, 64)))}
+    , m_mask       {std::bit_ceil(std::max<std::size_t>(capacity, 64)) - 1}
+    , m_head       {0}
+    , m_cached_tail{0}
+    , m_tail       {0}
+    , m_cached_head{0}
+  { }
+
+  spsc_ring(spsc_ring const &)
+  = delete;
+
+  spsc_ring(spsc_ring &&)
+  = delete;
+
+  ~spsc_ring()
+  = default;
+
+  spsc_ring &
+  operator=(spsc_ring const &)
+  = delete;
+
+  spsc_ring &
+  operator=(spsc_ring &&)
+  = delete;
+
+  [[nodiscard]]
+  std::size_t
+  capacity() const
+  noexcept
+  { return m_mask + 1; }
+
+
+  /*!
+   * \brief
+   *   Writes as many of the specified bytes as the ring has room for, and returns their number.
+   *
+   * \details
+   *   Must only be called by the producer.
+   */
+  std::size_t
+  write_some(std::span<std::byte const> const bytes)
+  noexcept
+  {
+    std::size_t const tail{m_tail.load(std::memory_order_relaxed)};
+
+    if (tail - m_cached_head + bytes.size() > capacity())
+      m_cached_head = m_head.load(std::memory_order_acquire);
+
+    std::size_t const n    {std::min(bytes.size(), capacity() - (tail - m_cached_head))};
+
+    if (n == 0)
+      return 0;
+
+    std::size_t const first{std::min(n, capacity() - (tail & m_mask))};
+
+    std::memcpy(m_buffer.get() + (tail & m_mask), bytes.data()        , first);
+    std::memcpy(m_buffer.get()                  , bytes.data() + first, n - first);
+
+    m_tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  /*!
+   * \brief
+   *   Reads at most as many bytes as the specified buffer holds, and returns their number.
+   *
+   * \details
+   *   Must only be called by the consumer.
+   */
+  std::size_t
+  read_some(std::span<std::byte> const bytes)
+  noexcept
+  {
+    std::size_t const head{m_head.load(std::memory_order_relaxed)};
+
+    if (m_cached_tail - head < bytes.size())
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+
+    std::size_t const n    {std::min(bytes.size(), m_cached_tail - head)};
+
+    if (n == 0)
+      return 0;
+
+    std::size_t const first{std::min(n, capacity() - (head & m_mask))};
+
+    std::memcpy(bytes.data()        , m_buffer.get() + (head & m_mask), first);
+    std::memcpy(bytes.data() + first, m_buffer.get()                  , n - first);
+
+    m_head.store(head + n, std::memory_order_release);
+    return n;
+  }
+
+  /*!
+   * \brief
+   *   Returns the total number of bytes written to the ring since its construction.
+   */
+  [[nodiscard]]
+  std::size_t
+  written() const
+  noexcept
+  { return m_tail.load(std::memory_order_acquire); }
+
+  /*!
+   * \brief
+   *   Returns the total number of bytes read from the ring since its construction.
+   */
+  [[nodiscard]]
+  std::size_t
+  read() const
+  noexcept
+  { return m_head.load(std::memory_order_acquire); }
+};
+
+} // namespace heim
+
+#endif // HEIM_LIB_SPSC_RING_HPP
@@ -0,0 +1,332 @@
+#ifndef HEIM_LIB_TRACE_HPP
+#define HEIM_LIB_TRACE_HPP
+
+#define HEIM_TRACE_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define HEIM_TRACE_CONCAT(lhs, rhs)      HEIM_TRACE_CONCAT_IMPL(lhs, rhs)
+
+/*!
+ * \brief
+ *   Opens a trace zone with the specified name, which must be a string literal, until the end of the
+ *   enclosing scope.
+ *
+ * \details
+ *   Expands to nothing unless \c HEIM_ENABLE_TRACE is defined, in which case the rest of this header
+ *   defines the recorder the zones are written to.
+ */
+#if defined(HEIM_ENABLE_TRACE)
+  #define HEIM_TRACE_ZONE(name) ::heim::trace_zone const HEIM_TRACE_CONCAT(heim_trace_zone_, __LINE__){name}
+#else
+  #define HEIM_TRACE_ZONE(name) static_cast<void>(0)
+#endif
+
+#if defined(HEIM_ENABLE_TRACE)
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <new>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+
+namespace heim
+{
+/*!
+ * \brief
+ *   Determines the default number of zones kept by the trace buffer of each thread.
+ */
+template<typename = void>
+struct default_trace_buffer_size
+  : std::integral_constant<std::size_t, 16384>
+{ };
+
+template<typename = void>
+inline constexpr
+std::size_t
+default_trace_buffer_size_v
+= default_trace_buffer_size<>::value;
+
+
+struct trace_event
+{
+  char const   *name;
+  std::uint64_t begin;
+  std::uint64_t end;
+};
+
+
+/*!
+ * \brief
+ *   The process-wide recorder of trace zones, exportable to the Chrome trace-event format.
+ *
+ * \details
+ *   Each thread records its zones into its own ring buffer, which it registers with a single
+ *   compare-and-swap the first time it records. Recording never locks and never allocates after
+ *   that, and a thread overflowing its buffer overwrites its oldest zones. Timestamps are in
+ *   nanoseconds since the construction of the recorder. \n
+ *   Buffers outlive their threads, so that zones recorded by joined threads are still exported.
+ *
+ * \note
+ *   Exporting and clearing must not happen concurrently with recording.
+ */
+class trace_recorder
+{
+public:
+  using clock_type = std::chrono::steady_clock;
+
+  static constexpr std::size_t buffer_size
+  = default_trace_buffer_size_v<>;
+
+  static_assert(
+      (buffer_size & (buffer_size - 1)) == 0,
+      "heim::trace_recorder: buffer_size must be a power of two.");
+
+private:
+  struct thread_buffer
+  {
+    std::array<trace_event, buffer_size> events;
+    std::atomic<std::uint64_t>           head;
+    std::uint32_t                        thread;
+    thread_buffer                       *next;
+  };
+
+private:
+  clock_type::time_point       m_epoch;
+  std::atomic<thread_buffer *> m_buffers;
+  std::atomic<std::uint32_t>   m_thread_count;
+
+private:
+  trace_recorder()
+    : m_epoch       {clock_type::now()}
+    , m_buffers     {nullptr}
+    , m_thread_count{}
+  { }
+
+  [[nodiscard]]
+  thread_buffer *
+  m_local()
+  noexcept
+  {
+    thread_local thread_buffer *local{nullptr};
+
+    if (local != nullptr)
+      return local;
+
+    auto *const buffer{new (std::nothrow) thread_buffer{}};
+
+    if (buffer == nullptr)
+      return nullptr;
+
+    buffer->thread = m_thread_count.fetch_add(1, std::memory_order_relaxed);
+    buffer->next   = m_buffers.load(std::memory_order_relaxed);
+    while (!m_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed))
+    { }
+
+    return local = buffer;
+  }
+
+  static
+  void
+  s_write_string(std::ostream &os, char const * const str)
+  {
+    os << '"';
+    for (char const c : std::string_view{str})
+    {
+      if (c == '"' || c == '\\')
+        os << '\\';
+      os << c;
+    }
+    os << '"';
+  }
+
+  static
+  void
+  s_write_microseconds(std::ostream &os, std::uint64_t const ns)
+  {
+    char const fraction[]{
+        static_cast<char>('0' + ns / 100 % 10),
+        static_cast<char>('0' + ns / 10  % 10),
+        static_cast<char>('0' + ns       % 10),
+        '\0'};
+
+    os << ns / 1000 << '.' << fraction;
+  }
+
+public:
+  trace_recorder(trace_recorder const &)
+  = delete;
+
+  trace_recorder(trace_recorder &&)
+  = delete;
+
+  ~trace_recorder()
+  {
+    for (thread_buffer *curr{m_buffers.load(std::memory_order_acquire)}; curr != nullptr; )
+    {
+      thread_buffer *const next{curr->next};
+
+      delete curr;
+      curr = next;
+    }
+  }
+
+  trace_recorder &
+  operator=(trace_recorder const &)
+  = delete;
+
+  trace_recorder &
+  operator=(trace_recorder &&)
+  = delete;
+
+  [[nodiscard]] static
+  trace_recorder &
+  instance()
+  {
+    static trace_recorder recorder{};
+    return recorder;
+  }
+
+
+  [[nodiscard]]
+  std::uint64_t
+  now() const
+  noexcept
+  { return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - m_epoch).count()); }
+
+  /*!
+   * \brief
+   *   Records the specified zone into the buffer of the calling thread. The zone is dropped if the
+   *   buffer of the thread cannot be allocated.
+   */
+  void
+  record(trace_event const &event)
+  noexcept
+  {
+    thread_buffer *const buffer{m_local()};
+
+    if (buffer == nullptr)
+      return;
+
+    std::uint64_t const head{buffer->head.load(std::memory_order_relaxed)};
+
+    buffer->events[head & (buffer_size - 1)] = event;
+    buffer->head.store(head + 1, std::memory_order_release);
+  }
+
+  /*!
+   * \brief
+   *   Writes the recorded zones of every thread as a Chrome trace-event JSON document.
+   */
+  void
+  write_chrome_json(std::ostream &os) const
+  {
+    bool first{true};
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    for (thread_buffer const *curr{m_buffers.load(std::memory_order_acquire)}; curr != nullptr; curr = curr->next)
+    {
+      std::uint64_t const head{curr->head.load(std::memory_order_acquire)};
+
+      for (std::uint64_t idx{head > buffer_size ? head - buffer_size : 0}; idx < head; ++idx)
+      {
+        trace_event const &event{curr->events[idx & (buffer_size - 1)]};
+
+        os << (first ? "\n" : ",\n") << "{\"name\":";
+        s_write_string(os, event.name);
+        os << ",\"cat\":\"heim\",\"ph\":\"X\",\"pid\":0,\"tid\":" << curr->thread << ",\"ts\":";
+        s_write_microseconds(os, event.begin);
+        os << ",\"dur\":";
+        s_write_microseconds(os, event.end - event.begin);
+        os << '}';
+
+        first = false;
+      }
+    }
+
+    os << "\n]}\n";
+  }
+
+  /*!
+   * \brief
+   *   Writes the recorded zones of every thread as a Chrome trace-event JSON document to the file at
+   *   the specified path, and returns whether it succeeded.
+   */
+  bool
+  write_chrome_json(char const * const path) const
+  {
+    std::ofstream file{path, std::ios::out | std::ios::trunc};
+
+    if (!file)
+      return false;
+
+    write_chrome_json(file);
+    return static_cast<bool>(file.flush());
+  }
+
+  /*!
+   * \brief
+   *   Discards the recorded zones of every thread, keeping their buffers.
+   */
+  void
+  clear()
+  noexcept
+  {
+    for (thread_buffer *curr{m_buffers.load(std::memory_order_acquire)}; curr != nullptr; curr = curr->next)
+      curr->head.store(0, std::memory_order_relaxed);
+  }
+};
+
+
+/*!
+ * \brief
+ *   A zone recorded from its construction to its destruction.
+ *
+ * \details
+ *   Zones are not recorded during constant evaluation, hence they can be opened in constexpr
+ *   functions.
+ */
+class trace_zone
+{
+private:
+  char const   *m_name;
+  std::uint64_t m_begin;
+
+public:
+  explicit constexpr
+  trace_zone(char const * const name)
+  noexcept
+    : m_name {name}
+    , m_begin{}
+  {
+    if !consteval
+    { m_begin = trace_recorder::instance().now(); }
+  }
+
+  trace_zone(trace_zone const &)
+  = delete;
+
+  constexpr
+  ~trace_zone()
+  {
+    if !consteval
+    {
+      trace_recorder &recorder{trace_recorder::instance()};
+      recorder.record(trace_event{m_name, m_begin, recorder.now()});
+    }
+  }
+
+  trace_zone &
+  operator=(trace_zone const &)
+  = delete;
+};
+
+} // namespace heim
+
+#endif // HEIM_ENABLE_TRACE
+
+#endif // HEIM_LIB_TRACE_HPP
@@ -0,0 +1,128 @@
+#ifndef HEIM_LIB_TRIPLE_BUFFER_HPP
+#define HEIM_LIB_TRIPLE_BUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace heim
+{
+/*!
+ * \brief
+ *   A wait-free single-producer single-consumer exchange of values of the specializing type through
+ *   three buffers.
+ *
+ * \details
+ *   The producer writes into its back buffer and publishes it, the consumer acquires the most
+ *   recently published buffer. Neither side ever waits for the other: the producer always owns one
+ *   buffer, the consumer always owns one buffer, and the third buffer is exchanged atomically
+ *   between them. \n
+ *   Buffers are recycled, hence the producer observes in its back buffer whatever value was written
+ *   into it two publications ago.
+ */
+template<typename T>
+requires std::is_default_constructible_v<T>
+class triple_buffer
+{
+public:
+  using value_type = T;
+
+private:
+  static constexpr std::uint8_t s_index_mask = 0b011;
+  static constexpr std::uint8_t s_fresh_bit  = 0b100;
+
+private:
+  std::array<value_type, 3> m_buffers;
+
+  alignas(64)
+  std::atomic<std::uint8_t> m_shared;
+
+  alignas(64)
+  std::uint8_t m_back;
+  std::uint8_t m_front;
+
+public:
+  triple_buffer()
+  noexcept(std::is_nothrow_default_constructible_v<value_type>)
+    : m_buffers{}
+    , m_shared {1}
+    , m_back   {0}
+    , m_front  {2}
+  { }
+
+  triple_buffer(triple_buffer const &)
+  = delete;
+
+  triple_buffer(triple_buffer &&)
+  = delete;
+
+  ~triple_buffer()
+  = default;
+
+  triple_buffer &
+  operator=(triple_buffer const &)
+  = delete;
+
+  triple_buffer &
+  operator=(triple_buffer &&)
+  = delete;
+
+
+  /*!
+   * \brief
+   *   Returns the buffer currently owned by the producer.
+   */
+  [[nodiscard]]
+  value_type &
+  back()
+  noexcept
+  { return m_buffers[m_back]; }
+
+  /*!
+   * \brief
+   *   Makes the producer's buffer the most recently published one, and hands the previously shared
+   *   buffer back to the producer.
+   */
+  void
+  publish()
+  noexcept
+  {
+    auto const prev{m_shared.exchange(static_cast<std::uint8_t>(m_back | s_fresh_bit), std::memory_order_acq_rel)};
+    m_back = prev & s_index_mask;
+  }
+
+  /*!
+   * \brief
+   *   Returns the most recently published buffer, which stays owned by the consumer until the next
+   *   call.
+   */
+  [[nodiscard]]
+  value_type const &
+  acquire()
+  noexcept
+  {
+    if (m_shared.load(std::memory_order_relaxed) & s_fresh_bit)
+    {
+      auto const prev{m_shared.exchange(m_front, std::memory_order_acq_rel)};
+      m_front = prev & s_index_mask;
+    }
+    return m_buffers[m_front];
+  }
+
+  /*!
+   * \brief
+   *   Returns the buffer currently owned by the consumer, without looking for a newer publication.
+   */
+  [[nodiscard]]
+  value_type const &
+  front() const
+  noexcept
+  { return m_buffers[m_front]; }
+};
+
+} // namespace heim
+
+#endif // HEIM_LIB_TRIPLE_BUFFER_HPP
@@ -18,6 +18,134 @@ template<typename ...Ts>
 struct type_sequence;
 
 
+// The operations on type sequences are implemented with constant instantiation depth (folds, pack
+// expansions and constant evaluation over the whole pack) rather than by recursing on the pack, so
+// that sequences of hundreds of types stay cheap to compile.
+namespace detail
+{
+#if defined(__GNUC__) || defined(__clang__)
+  #define HEIM_TYPE_SEQUENCE_IS_SAME(T, U) __is_same(T, U)
+#else
+  #define HEIM_TYPE_SEQUENCE_IS_SAME(T, U) std::is_same_v<T, U>
+#endif
+
+template<typename>
+struct is_type_sequence
+  : std::false_type
+{ };
+
+template<typename ...Ts>
+struct is_type_sequence<type_sequence<Ts ...>>
+  : std::true_type
+{ };
+
+
+// the index of the first occurrence of T in Ts, or the size of Ts if there is none
+template<
+    typename    T,
+    typename ...Ts>
+[[nodiscard]] consteval
+std::size_t
+type_sequence_find()
+noexcept
+{
+  constexpr bool matches[]{HEIM_TYPE_SEQUENCE_IS_SAME(T, Ts) ..., true};
+
+  std::size_t idx{};
+  while (!matches[idx])
+    ++idx;
+  return idx;
+}
+
+
+// the type at index I in Ts, selected through the base class it is the only one to match
+template<
+    std::size_t I,
+    typename    T>
+struct type_sequence_indexed
+{ };
+
+template<
+    typename,
+    typename ...>
+struct type_sequence_indexer;
+
+template<
+    std::size_t ...Is,
+    typename    ...Ts>
+struct type_sequence_indexer<
+    std::index_sequence<Is ...>,
+    Ts ...>
+  : type_sequence_indexed<Is, Ts> ...
+{ };
+
+template<
+    std::size_t I,
+    typename    T>
+std::type_identity<T>
+type_sequence_select(type_sequence_indexed<I, T> const &);
+
+template<
+    std::size_t    I,
+    typename    ...Ts>
+struct type_sequence_element
+#if defined(__cpp_pack_indexing) && __cpp_pack_indexing >= 202311L
+  : std::type_identity<Ts...[I]>
+#elif defined(__has_builtin) && __has_builtin(__type_pack_element)
+  : std::type_identity<__type_pack_element<I, Ts ...>>
+#else
+  : decltype(detail::type_sequence_select<I>(
+        std::declval<type_sequence_indexer<std::index_sequence_for<Ts ...>, Ts ...>>()))
+#endif
+{ };
+
+
+template<
+    std::size_t I,
+    typename>
+struct type_sequence_element_of;
+
+template<
+    std::size_t    I,
+    typename    ...Ts>
+struct type_sequence_element_of<
+    I,
+    type_sequence<Ts ...>>
+  : type_sequence_element<I, Ts ...>
+{ };
+
+
+// the type sequence of the types at the indices Is in Ts
+template<
+    typename,
+    typename>
+struct type_sequence_at;
+
+template<
+    typename    ...Ts,
+    std::size_t ...Is>
+struct type_sequence_at<
+    type_sequence<Ts ...>,
+    std::index_sequence<Is ...>>
+  : std::type_identity<type_sequence<typename type_sequence_element<Is, Ts ...>::type ...>>
+{ };
+
+template<
+    std::size_t    Offset,
+    std::size_t ...Is>
+std::index_sequence<Offset + Is ...>
+type_sequence_offset(std::index_sequence<Is ...>);
+
+template<
+    std::size_t First,
+    std::size_t Last>
+using type_sequence_range
+= decltype(type_sequence_offset<First>(std::make_index_sequence<Last - First>{}));
+
+
+}
+
+
 /*!
  * \brief
  *   Determines the number of types specializing the specializing type sequence.
@@ -89,23 +217,47 @@ template<typename ...>
 struct type_sequence_concat
 { };
 
-template<typename ...Ts>
-struct type_sequence_concat<
-    type_sequence<Ts ...>>
-  : std::type_identity<type_sequence<Ts ...>>
-{ };
+namespace detail
+{
+// maps each index of the concatenation to the sequence it comes from and its index in that sequence
+template<typename ...Seqs>
+struct type_sequence_concat_impl
+{
+  static constexpr std::size_t s_size
+  = (0 + ... + type_sequence_size<Seqs>::value);
+
+  static constexpr std::array<std::array<std::size_t, 2>, s_size> s_origins
+  = []
+  {
+    std::array<std::array<std::size_t, 2>, s_size> origins{};
+    std::array<std::size_t, sizeof...(Seqs)>       sizes  {type_sequence_size<Seqs>::value ...};
+
+    std::size_t idx{};
+    for (std::size_t seq{}; seq < sizes.size(); ++seq)
+      for (std::size_t i{}; i < sizes[seq]; ++i)
+        origins[idx++] = {seq, i};
+    return origins;
+  }();
+
+  template<std::size_t ...Is>
+  static
+  type_sequence<
+      typename type_sequence_element_of<
+          s_origins[Is][1],
+          typename type_sequence_element<s_origins[Is][0], Seqs ...>::type>
+          ::type ...>
+  concat(std::index_sequence<Is ...>);
+
+  using type = decltype(concat(std::make_index_sequence<s_size>{}));
+};
 
-template<
-    typename ...As,
-    typename ...Bs,
-    typename ...Rest>
-struct type_sequence_concat<
-    type_sequence<As ...>,
-    type_sequence<Bs ...>,
-    Rest ...>
-  : type_sequence_concat<
-        type_sequence<As ..., Bs ...>,
-        Rest ...>
+
+}
+
+template<typename ...Ts>
+requires (detail::is_type_sequence<Ts>::value && ...)
+struct type_sequence_concat<Ts ...>
+  : std::type_identity<typename detail::type_sequence_concat_impl<Ts ...>::type>
 { };
 
 
@@ -209,30 +361,18 @@ struct type_sequence_filter
 { };
 
 template<
-    template<typename>
-    typename Pred>
-struct type_sequence_filter<
-    type_sequence<>,
-    Pred>
-  : std::type_identity<type_sequence<>>
-{ };
-
-template<
-    typename    First,
-    typename ...Rest,
+    typename ...Ts,
     template<typename>
     typename    Pred>
 struct type_sequence_filter<
-    type_sequence<First, Rest ...>,
+    type_sequence<Ts ...>,
     Pred>
   : type_sequence_concat<
+        type_sequence<>,
         std::conditional_t<
-            Pred<First>::value,
-            type_sequence<First>,
-            type_sequence<>>,
-        type_sequence_filter_t<
-            type_sequence<Rest ...>,
-            Pred>>
+            Pred<Ts>::value,
+            type_sequence<Ts>,
+            type_sequence<>> ...>
 { };
 
 
@@ -258,32 +398,15 @@ template<
 struct type_sequence_take
 { };
 
-template<typename ...Ts>
-struct type_sequence_take<
-    type_sequence<Ts ...>,
-    0>
-  : std::type_identity<type_sequence<>>
-{ };
-
-template<std::size_t N>
-struct type_sequence_take<
-    type_sequence<>,
-    N>
-  : std::type_identity<type_sequence<>>
-{ };
-
 template<
-    typename    First,
-    typename ...Rest,
+    typename ...Ts,
     std::size_t N>
 struct type_sequence_take<
-    type_sequence<First, Rest ...>,
+    type_sequence<Ts ...>,
     N>
-  : type_sequence_concat<
-        type_sequence<First>,
-        type_sequence_take_t<
-            type_sequence<Rest ...>,
-            N - 1>>
+  : detail::type_sequence_at<
+        type_sequence<Ts ...>,
+        std::make_index_sequence<std::min(N, sizeof...(Ts))>>
 { };
 
 
@@ -309,32 +432,15 @@ template<
 struct type_sequence_drop
 { };
 
-template<typename ...Ts>
-struct type_sequence_drop<
-    type_sequence<Ts ...>,
-    0>
-  : std::type_identity<type_sequence<Ts ...>>
-{ };
-
-template<std::size_t N>
-requires (N > 0)
-struct type_sequence_drop<
-    type_sequence<>,
-    N>
-  : std::type_identity<type_sequence<>>
-{ };
-
 template<
-    typename    First,
-    typename ...Rest,
+    typename ...Ts,
     std::size_t N>
-requires (N > 0)
 struct type_sequence_drop<
-    type_sequence<First, Rest ...>,
+    type_sequence<Ts ...>,
     N>
-  : type_sequence_drop<
-        type_sequence<Rest ...>,
-        N - 1>
+  : detail::type_sequence_at<
+        type_sequence<Ts ...>,
+        detail::type_sequence_range<std::min(N, sizeof...(Ts)), sizeof...(Ts)>>
 { };
 
 
@@ -354,31 +460,15 @@ template<typename>
 struct type_sequence_join
 { };
 
-template<>
-struct type_sequence_join<
-    type_sequence<>>
-  : std::type_identity<type_sequence<>>
-{ };
-
-template<
-    typename    First,
-    typename ...Rest>
-struct type_sequence_join<
-    type_sequence<First, Rest ...>>
-  : type_sequence_concat<
-        type_sequence<First>,
-        type_sequence_join_t<type_sequence<Rest ...>>>
-{ };
-
-template<
-    typename ...First,
-    typename ...Rest>
+template<typename ...Ts>
 struct type_sequence_join<
-    type_sequence<type_sequence<First ...>, Rest ...>>
+    type_sequence<Ts ...>>
   : type_sequence_concat<
-        type_sequence<First ...>,
-        type_sequence_join_t<
-            type_sequence<Rest ...>>>
+        type_sequence<>,
+        std::conditional_t<
+            detail::is_type_sequence<Ts>::value,
+            Ts,
+            type_sequence<Ts>> ...>
 { };
 
 
@@ -396,46 +486,38 @@ using type_sequence_unique_t
 
 namespace detail
 {
-template<
-    typename,
-    typename = type_sequence<>>
-struct type_sequence_unique_impl;
-
 template<
     typename,
     typename>
-struct type_sequence_unique_impl
-{ };
-
-template<
-    typename ...Visited>
-struct type_sequence_unique_impl<
-    type_sequence<>,
-    type_sequence<Visited...>>
-  : std::type_identity<type_sequence<Visited...>>
-{ };
+struct type_sequence_unique_impl;
 
 template<
-    typename    First,
-    typename ...Rest,
-    typename ...Visited>
+    typename    ...Ts,
+    std::size_t ...Is>
 struct type_sequence_unique_impl<
-    type_sequence<First, Rest ...>,
-    type_sequence<Visited ...>>
-  : type_sequence_unique_impl<
-        type_sequence<Rest ...>,
+    type_sequence<Ts ...>,
+    std::index_sequence<Is ...>>
+  : type_sequence_concat<
+        type_sequence<>,
         std::conditional_t<
-            (std::is_same_v<First, Visited> || ...),
-            type_sequence<Visited ...>,
-            type_sequence<Visited ..., First>>>
+            type_sequence_find<Ts, Ts ...>() == Is,
+            type_sequence<Ts>,
+            type_sequence<>> ...>
 { };
 
 
 }
 
-template<typename T>
+template<typename>
 struct type_sequence_unique
-  : detail::type_sequence_unique_impl<T>
+{ };
+
+template<typename ...Ts>
+struct type_sequence_unique<
+    type_sequence<Ts ...>>
+  : detail::type_sequence_unique_impl<
+        type_sequence<Ts ...>,
+        std::index_sequence_for<Ts ...>>
 { };
 
 
@@ -452,9 +534,18 @@ bool
 type_sequence_is_unique_v
 = type_sequence_is_unique<T>::value;
 
-template<typename T>
+template<typename>
 struct type_sequence_is_unique
-  : std::is_same<T, type_sequence_unique_t<T>>
+{ };
+
+template<typename ...Ts>
+struct type_sequence_is_unique<
+    type_sequence<Ts ...>>
+  : std::bool_constant<
+        []<std::size_t ...Is>(std::index_sequence<Is ...>)
+        {
+          return ((detail::type_sequence_find<Ts, Ts ...>() == Is) && ...);
+        }(std::index_sequence_for<Ts ...>{})>
 { };
 
 
@@ -473,20 +564,23 @@ template<typename>
 struct type_sequence_reverse
 { };
 
-template<>
-struct type_sequence_reverse<
-    type_sequence<>>
-  : std::type_identity<type_sequence<>>
-{ };
-
+namespace detail
+{
 template<
-    typename    First,
-    typename ...Rest>
+    std::size_t    N,
+    std::size_t ...Is>
+std::index_sequence<N - 1 - Is ...>
+type_sequence_reversed(std::index_sequence<Is ...>);
+
+
+}
+
+template<typename ...Ts>
 struct type_sequence_reverse<
-    type_sequence<First, Rest ...>>
-  : type_sequence_concat<
-        type_sequence_reverse_t<type_sequence<Rest ...>>,
-        type_sequence<First>>
+    type_sequence<Ts ...>>
+  : detail::type_sequence_at<
+        type_sequence<Ts ...>,
+        decltype(detail::type_sequence_reversed<sizeof...(Ts)>(std::index_sequence_for<Ts ...>{}))>
 { };
 
 
@@ -845,25 +939,13 @@ template<
 struct type_sequence_index
 { };
 
-template<typename T>
-struct type_sequence_index<
-    type_sequence<>,
-    T>
-  : std::integral_constant<std::size_t, 0>
-{ };
-
 template<
-    typename    First,
-    typename ...Rest,
+    typename ...Ts,
     typename    T>
 struct type_sequence_index<
-    type_sequence<First, Rest ...>,
+    type_sequence<Ts ...>,
     T>
-  : std::integral_constant<
-        std::size_t,
-        std::is_same_v<First, T>
-          ? 0
-          : 1 + type_sequence_index_v<type_sequence<Rest ...>, T>>
+  : std::integral_constant<std::size_t, detail::type_sequence_find<T, Ts ...>()>
 { };
 
 
@@ -898,7 +980,7 @@ struct type_sequence_count<
     T>
   : std::integral_constant<
         std::size_t,
-        (0 + ... + (std::is_same_v<Ts, T> ? 1 : 0))>
+        (0 + ... + (HEIM_TYPE_SEQUENCE_IS_SAME(Ts, T) ? 1 : 0))>
 { };
 
 
@@ -963,9 +1045,15 @@ template<typename T>
 using type_sequence_back_t
 = typename type_sequence_back<T>::type;
 
-template<typename T>
+template<typename>
 struct type_sequence_back
-  : type_sequence_front<type_sequence_reverse_t<T>>
+{ };
+
+template<typename ...Ts>
+requires (sizeof...(Ts) > 0)
+struct type_sequence_back<
+    type_sequence<Ts ...>>
+  : detail::type_sequence_element<sizeof...(Ts) - 1, Ts ...>
 { };
 
 
@@ -985,10 +1073,19 @@ using type_sequence_get_t
 = typename type_sequence_get<T, N>::type;
 
 template<
-    typename    T,
-    std::size_t N>
+    typename,
+    std::size_t>
 struct type_sequence_get
-  : type_sequence_front<type_sequence_drop_t<T, N>>
+{ };
+
+template<
+    typename ...Ts,
+    std::size_t N>
+requires (N < sizeof...(Ts))
+struct type_sequence_get<
+    type_sequence<Ts ...>,
+    N>
+  : detail::type_sequence_element<N, Ts ...>
 { };
 
 
@@ -1073,30 +1170,18 @@ struct type_sequence_remove_if
 { };
 
 template<
-    template<typename>
-    typename Pred>
-struct type_sequence_remove_if<
-    type_sequence<>,
-    Pred>
-  : std::type_identity<type_sequence<>>
-{ };
-
-template<
-    typename    First,
-    typename ...Rest,
+    typename ...Ts,
     template<typename>
     typename    Pred>
 struct type_sequence_remove_if<
-    type_sequence<First, Rest ...>,
+    type_sequence<Ts ...>,
     Pred>
   : type_sequence_concat<
+        type_sequence<>,
         std::conditional_t<
-            Pred<First>::value,
+            Pred<Ts>::value,
             type_sequence<>,
-            type_sequence<First>>,
-        type_sequence_remove_if_t<
-            type_sequence<Rest ...>,
-            Pred>>
+            type_sequence<Ts>> ...>
 { };
 
 
@@ -1161,58 +1246,54 @@ using type_sequence_erase_t
 
 namespace detail
 {
+template<std::size_t ...Ns>
+[[nodiscard]] consteval
+bool
+type_sequence_erased(std::size_t const idx)
+noexcept
+{ return ((idx == Ns) || ...); }
+
 template<
-    std::size_t,
+    typename,
     typename,
     std::size_t ...>
 struct type_sequence_erase_impl;
 
 template<
-    std::size_t    Current,
-    typename       T,
-    std::size_t ...Ns>
-struct type_sequence_erase_impl
-{ };
-
-template<
-    std::size_t    Current,
-    std::size_t ...Ns>
-struct type_sequence_erase_impl<
-    Current,
-    type_sequence<>,
-    Ns ...>
-  : std::type_identity<type_sequence<>>
-{ };
-
-template<
-    std::size_t    Current,
-    typename       First,
-    typename    ...Rest,
+    typename    ...Ts,
+    std::size_t ...Is,
     std::size_t ...Ns>
 struct type_sequence_erase_impl<
-    Current,
-    type_sequence<First, Rest ...>,
+    type_sequence<Ts ...>,
+    std::index_sequence<Is ...>,
     Ns ...>
   : type_sequence_concat<
+        type_sequence<>,
         std::conditional_t<
-            ((Current == Ns) || ...),
+            type_sequence_erased<Ns ...>(Is),
             type_sequence<>,
-            type_sequence<First>>,
-        typename type_sequence_erase_impl<
-            Current + 1,
-            type_sequence<Rest ...>,
-            Ns ...>
-            ::type>
+            type_sequence<Ts>> ...>
 { };
 
 
 }
 
 template<
-    typename       T,
-    std::size_t ...Ns>
+    typename,
+    std::size_t ...>
 struct type_sequence_erase
-  : detail::type_sequence_erase_impl<0, T, Ns ...>
+{ };
+
+template<
+    typename    ...Ts,
+    std::size_t ...Ns>
+struct type_sequence_erase<
+    type_sequence<Ts ...>,
+    Ns ...>
+  : detail::type_sequence_erase_impl<
+        type_sequence<Ts ...>,
+        std::index_sequence_for<Ts ...>,
+        Ns ...>
 { };
 
 
@@ -1283,9 +1364,15 @@ template<typename T>
 using type_sequence_pop_back_t
 = typename type_sequence_pop_back<T>::type;
 
-template<typename T>
+template<typename>
 struct type_sequence_pop_back
-  : type_sequence_reverse<type_sequence_pop_front_t<type_sequence_reverse_t<T>>>
+{ };
+
+template<typename ...Ts>
+requires (sizeof...(Ts) > 0)
+struct type_sequence_pop_back<
+    type_sequence<Ts ...>>
+  : type_sequence_take<type_sequence<Ts ...>, sizeof...(Ts) - 1>
 { };
 
 
@@ -1845,4 +1932,6 @@ struct to_type_sequence<
 
 } // namespace heim
 
+#undef HEIM_TYPE_SEQUENCE_IS_SAME
+
 #endif // HEIM_TYPE_SEQUENCE_HPP
@@ -128,6 +128,39 @@ template<int Digits>
 using unsigned_integral_for_t
 = typename unsigned_integral_for<Digits>::type;
 
+
+/*!
+ * \brief
+ *   Hints the processor to load the cache line containing the specified address, which does not need
+ *   to be dereferenceable.
+ *
+ * \details
+ *   Has no effect during constant evaluation or on compilers without a prefetch builtin.
+ */
+template<typename T>
+inline constexpr
+void
+prefetch(T const * const ptr)
+noexcept
+{
+  if !consteval
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr);
+#else
+    static_cast<void>(ptr);
+#endif
+  }
+}
+
+
+/*!
+ * \brief
+ *   The node of a \c heim::numa_allocator , or of a pool of a registry, that binds allocations to no
+ *   node, whose pages are then placed on the node of the thread that first touches them.
+ */
+inline constexpr int numa_first_touch = -1;
+
 } // namespace heim
 
 #endif // HEIM_LIB_UTILITY_HPP
@@ -7,5 +7,7 @@
 // #include "ecs/registry/hibit/static_registry.hpp"
 // #include "ecs/registry/sparse/runtime_registry.hpp"
 #include "ecs/registry/sparse/static_registry.hpp"
+#include "ecs/registry/sparse/fixed_registry.hpp"
+#include "ecs/registry/sparse/frozen_registry.hpp"
 
 #endif // HEIM_REGISTRY_HPP
@@ -0,0 +1,169 @@
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+struct velocity { int dx; };
+
+using registry
+= heim::sparse::static_registry::with_all<position, velocity>;
+
+using clock_type = std::chrono::steady_clock;
+
+// a deadline already reached, so that each call visits the minimal number of identifiers, and one
+// that is never reached, so that each call completes its pass
+clock_type::time_point const past  {clock_type::now() - std::chrono::hours{1}};
+clock_type::time_point const future{clock_type::now() + std::chrono::hours{1}};
+
+
+// creates the specified number of entities with a position, every tenth one with a velocity as well
+std::vector<registry::identifier_type>
+populate(registry &reg, int const n)
+{
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < n; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(i);
+    if (i % 10 == 0)
+      e.emplace<velocity>(i);
+    ids.push_back(e.identifier());
+  }
+  return ids;
+}
+
+// a pass resumes across calls, visits each matched entity once, and walks the smallest guaranteed pool
+// rather than every entity of the registry
+void
+test_resume()
+{
+  registry reg{};
+  populate(reg, 1000);
+
+  heim::sparse::query_cursor               cursor{};
+  std::map<registry::identifier_type, int> visits;
+
+  auto const visit{[&](auto e) { ++visits[e.identifier()]; }};
+
+  HEIM_CHECK(!heim::sparse::budgeted_each(reg.query<heim::conjunction<position, velocity>>(), cursor, past, visit));
+  HEIM_CHECK(cursor.remaining() == 100 - 64);
+  HEIM_CHECK(cursor.passes() == 0);
+  HEIM_CHECK(visits.size() == 64);
+
+  HEIM_CHECK( heim::sparse::budgeted_each(reg.query<heim::conjunction<position, velocity>>(), cursor, past, visit));
+  HEIM_CHECK(cursor.remaining() == 0);
+  HEIM_CHECK(cursor.passes() == 1);
+  HEIM_CHECK(!cursor.invalidated());
+  HEIM_CHECK(visits.size() == 100);
+  for (auto const &[id, count] : visits)
+    HEIM_CHECK(count == 1 && reg.matches<heim::conjunction<position, velocity>>(id));
+
+  // the order of the operands does not matter, and a second pass starts over
+  visits.clear();
+  HEIM_CHECK(!heim::sparse::budgeted_each(reg.query<heim::conjunction<velocity, position>>(), cursor, past, visit));
+  HEIM_CHECK(cursor.remaining() == 100 - 64);
+  HEIM_CHECK( heim::sparse::budgeted_each(reg.query<heim::conjunction<velocity, position>>(), cursor, future, visit));
+  HEIM_CHECK(cursor.passes() == 2);
+  HEIM_CHECK(visits.size() == 100);
+
+  // a single component walks its pool, and a pure negation walks the enabled entities
+  heim::sparse::query_cursor single{};
+  std::size_t                count{};
+
+  HEIM_CHECK(heim::sparse::budgeted_each(reg.query<velocity>(), single, future, [&](auto) { ++count; }));
+  HEIM_CHECK(count == 100);
+
+  heim::sparse::query_cursor negated{};
+  count = 0;
+
+  HEIM_CHECK(!heim::sparse::budgeted_each(reg.query<heim::negation<velocity>>(), negated, past, [&](auto) { ++count; }));
+  HEIM_CHECK(negated.remaining() == 1000 - 64);
+  HEIM_CHECK(heim::sparse::budgeted_each(reg.query<heim::negation<velocity>>(), negated, future, [&](auto) { ++count; }));
+  HEIM_CHECK(count == 900);
+
+  // a reset abandons the pass
+  HEIM_CHECK(!heim::sparse::budgeted_each(reg.query<heim::conjunction<position, velocity>>(), cursor, past, visit));
+  cursor.reset();
+  HEIM_CHECK(cursor.remaining() == 0);
+  HEIM_CHECK(cursor.passes() == 2);
+}
+
+// entities destroyed or disabled during a pass are no longer visited and invalidate it, as the moved
+// entities may then be visited twice or skipped, while the next pass is valid again
+void
+test_changes()
+{
+  registry reg{};
+  auto const ids{populate(reg, 1000)};
+
+  heim::sparse::query_cursor               cursor{};
+  std::map<registry::identifier_type, int> visits;
+
+  auto const visit{
+      [&](auto e)
+      {
+        HEIM_CHECK(!reg.expired(e.identifier()) && reg.enabled(e.identifier()));
+        ++visits[e.identifier()];
+      }};
+
+  HEIM_CHECK(!heim::sparse::budgeted_each(reg.query<heim::conjunction<position, velocity>>(), cursor, past, visit));
+  HEIM_CHECK(!cursor.invalidated());
+
+  std::vector<registry::identifier_type> removed;
+  for (std::size_t i{}; i < ids.size(); i += 10)
+    if (!visits.contains(ids[i]) && removed.size() < 10)
+      removed.push_back(ids[i]);
+
+  for (std::size_t i{}; i < removed.size(); ++i)
+  {
+    if (i % 2 == 0)
+      reg.destroy(removed[i]);
+    else
+      reg.disable(removed[i]);
+  }
+
+  HEIM_CHECK(heim::sparse::budgeted_each(reg.query<heim::conjunction<position, velocity>>(), cursor, future, visit));
+  HEIM_CHECK(cursor.invalidated());
+  HEIM_CHECK(cursor.passes() == 1);
+  for (auto const id : removed)
+    HEIM_CHECK(!visits.contains(id));
+
+  // the function itself destroys the entities it visits
+  visits.clear();
+  HEIM_CHECK(heim::sparse::budgeted_each(
+      reg.query<heim::conjunction<position, velocity>>(), cursor, future,
+      [&](auto e)
+      {
+        visit(e);
+        reg.destroy(e.identifier());
+      }));
+  HEIM_CHECK(cursor.invalidated());
+  HEIM_CHECK(cursor.passes() == 2);
+  HEIM_CHECK(visits.size() == 90);
+  HEIM_CHECK(reg.container<velocity>().enabled_size() == 0);
+
+  // with no change, the next pass is valid
+  visits.clear();
+  for (auto const id : removed)
+    if (!reg.expired(id))
+      reg.enable(id);
+
+  HEIM_CHECK(heim::sparse::budgeted_each(reg.query<heim::conjunction<position, velocity>>(), cursor, future, visit));
+  HEIM_CHECK(!cursor.invalidated());
+  HEIM_CHECK(cursor.passes() == 3);
+  HEIM_CHECK(visits.size() == 5);
+}
+
+
+int
+main()
+{
+  test_resume();
+  test_changes();
+  return heim::test::failures;
+}
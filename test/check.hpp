@@ -0,0 +1,21 @@
+#ifndef HEIM_TEST_CHECK_HPP
+#define HEIM_TEST_CHECK_HPP
+
+#include <cstdio>
+
+namespace heim::test
+{
+// the number of failed checks of the test executable, which is its exit status
+inline int failures{};
+
+} // namespace heim::test
+
+// reports the specified condition if it does not hold, and carries on so that a test reports every
+// failure before exiting
+#define HEIM_CHECK(...)                                                                          \
+  ((__VA_ARGS__)                                                                                 \
+    ? void()                                                                                     \
+    : (std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__VA_ARGS__),      \
+       void(++::heim::test::failures)))
+
+#endif // HEIM_TEST_CHECK_HPP
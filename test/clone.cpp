@@ -0,0 +1,91 @@
+#include <iterator>
+#include <string>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { float x, y; };
+struct name     { std::string value; };
+struct tag      { };
+
+using registry
+= heim::sparse::static_registry::with_all<position, name, tag>;
+
+
+// each clone owns a copy of each component of its source, and nothing more, including when some of
+// the clones recycle destroyed identifiers
+void
+test_clone()
+{
+  registry reg{};
+
+  auto src{reg.entity()};
+  auto gap{reg.entity()};
+
+  src.emplace<position>(1.f, 2.f);
+  src.emplace<name>    ("orc");
+  gap.emplace<tag>     ();
+  gap.destroy();
+
+  std::vector<registry::identifier_type> ids;
+
+  reg.clone(src.identifier(), 5, std::back_inserter(ids));
+
+  HEIM_CHECK(ids.size() == 5);
+  HEIM_CHECK(reg.size() == 6);
+  HEIM_CHECK(reg.container<position>().size() == 6);
+  HEIM_CHECK(reg.container<name>    ().size() == 6);
+  HEIM_CHECK(reg.container<tag>     ().size() == 0);
+
+  for (auto const id : ids)
+  {
+    HEIM_CHECK(id != src.identifier());
+    HEIM_CHECK(reg.get<position>(id).x == 1.f && reg.get<position>(id).y == 2.f);
+    HEIM_CHECK(reg.get<name>(id).value == "orc");
+  }
+
+  // the clones are independent of their source
+  reg.get<name>(ids.front()).value = "goblin";
+  HEIM_CHECK(src.get<name>().value == "orc");
+
+  std::size_t matched{};
+
+  for ([[maybe_unused]] auto e : reg.query<heim::conjunction<position, name>>())
+    ++matched;
+  HEIM_CHECK(matched == 6);
+}
+
+// each instance owns a copy of each component of the prefab
+void
+test_instantiate()
+{
+  registry reg{};
+
+  heim::prefab const pf{position{3.f, 4.f}, name{"elf"}};
+
+  std::vector<registry::identifier_type> ids;
+
+  reg.instantiate(pf, 3, std::back_inserter(ids));
+  reg.instantiate(heim::prefab<>{}, 2, std::back_inserter(ids));
+
+  HEIM_CHECK(ids.size() == 5);
+  HEIM_CHECK(reg.size() == 5);
+  HEIM_CHECK(reg.container<position>().size() == 3);
+  HEIM_CHECK(reg.container<name>    ().size() == 3);
+
+  for (std::size_t i{}; i < 3; ++i)
+  {
+    HEIM_CHECK(reg.get<position>(ids[i]).x == 3.f);
+    HEIM_CHECK(reg.get<name>(ids[i]).value == "elf");
+  }
+  HEIM_CHECK(reg.get_if<name>(ids[3]) == nullptr);
+}
+
+
+int main()
+{
+  test_clone();
+  test_instantiate();
+
+  return heim::test::failures;
+}
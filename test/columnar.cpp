@@ -0,0 +1,201 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+#include <unistd.h>
+#include <heim/registry.hpp>
+#include <heim/ecs/registry/sparse/columnar.hpp>
+#include "check.hpp"
+
+struct position { float x; double y; };
+struct health   { int points; };
+struct colour   { std::uint8_t r, g, b; };
+
+template<>
+struct heim::sparse::columnar_layout<position>
+{
+  static constexpr std::tuple members{
+      heim::sparse::columnar_member{"x", &position::x},
+      heim::sparse::columnar_member{"y", &position::y}};
+};
+
+using registry
+= heim::sparse::static_registry::with_all<position, health, colour>;
+
+using columns
+= heim::sparse::registry_columns<registry, position, health, colour>;
+
+
+// formats are the primitive formats of the Arrow C data interface, or fixed-size binaries
+void
+test_formats()
+{
+  using heim::sparse::detail::arrow_format;
+
+  HEIM_CHECK(arrow_format<std::int8_t>  () == "c");
+  HEIM_CHECK(arrow_format<std::uint8_t> () == "C");
+  HEIM_CHECK(arrow_format<std::int16_t> () == "s");
+  HEIM_CHECK(arrow_format<std::uint16_t>() == "S");
+  HEIM_CHECK(arrow_format<std::int32_t> () == "i");
+  HEIM_CHECK(arrow_format<std::uint32_t>() == "I");
+  HEIM_CHECK(arrow_format<std::int64_t> () == "l");
+  HEIM_CHECK(arrow_format<std::uint64_t>() == "L");
+  HEIM_CHECK(arrow_format<float>        () == "f");
+  HEIM_CHECK(arrow_format<double>       () == "g");
+  HEIM_CHECK(arrow_format<bool>         () == "w:1");
+  HEIM_CHECK(arrow_format<colour>       () == "w:3");
+}
+
+// split components are copied member by member in the dense order of their pool, and the others are
+// views of it
+void
+test_update()
+{
+  registry reg{};
+
+  for (int i{}; i < 100; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(static_cast<float>(i), -static_cast<double>(i));
+    if (i % 4 == 0)
+      e.emplace<health>(i);
+  }
+  reg.disable(reg.container<health>().identifiers()[3]);
+
+  columns cols{{"position", "health", "colour"}};
+  cols.update(reg);
+
+  auto const pos{cols.get<position>().columns()};
+  auto const hp {cols.get<health>  ().columns()};
+  auto const col{cols.get<colour>  ().columns()};
+
+  HEIM_CHECK(pos.size() == 3 && hp.size() == 2 && col.size() == 2);
+  HEIM_CHECK(pos[0].name == "position.id" && pos[1].name == "position.x" && pos[2].name == "position.y");
+  HEIM_CHECK(pos[0].format == "L" && pos[1].format == "f" && pos[2].format == "g");
+  HEIM_CHECK(hp[1].name == "health" && hp[1].format == "w:4" && col[1].format == "w:3");
+  HEIM_CHECK(pos[1].length == 100 && hp[1].length == 25 && col[1].length == 0);
+  HEIM_CHECK(cols.get<health>().enabled_size() == 24);
+
+  auto const &pool{reg.container<position>()};
+  auto const  xs  {reinterpret_cast<float  const *>(pos[1].data.data())};
+  auto const  ys  {reinterpret_cast<double const *>(pos[2].data.data())};
+  auto const  ids {reinterpret_cast<std::uint64_t const *>(pos[0].data.data())};
+
+  bool split{true};
+  for (std::size_t i{}; i < pool.size(); ++i)
+    split = split
+        && ids[i] == pool.identifiers()[i]
+        && xs[i]  == pool.components()[i].x
+        && ys[i]  == pool.components()[i].y;
+  HEIM_CHECK(split);
+  HEIM_CHECK(hp[1].data.data() == reinterpret_cast<std::byte const *>(reg.container<health>().components().data()));
+
+  reg.get<position>(pool.identifiers()[0]).x = 1000.f;
+  cols.update(reg);
+  HEIM_CHECK(reinterpret_cast<float const *>(cols.get<position>().columns()[1].data.data())[0] == 1000.f);
+}
+
+// the file holds a table of the columns, then the data of each column at the offset of the table,
+// aligned to 64 bytes
+void
+test_write()
+{
+  registry reg{};
+
+  for (int i{}; i < 37; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(1.f, 2.);
+    e.emplace<colour>(std::uint8_t{1}, std::uint8_t{2}, std::uint8_t(i));
+  }
+
+  columns cols{{"position", "health", "colour"}};
+  cols.update(reg);
+
+  auto const path{std::filesystem::temp_directory_path() / ("heim_columnar_" + std::to_string(::getpid()))};
+  cols.write(path.c_str());
+
+  std::vector<std::byte> file(std::filesystem::file_size(path));
+  {
+    std::FILE *const f{std::fopen(path.c_str(), "rb")};
+    HEIM_CHECK(f != nullptr && std::fread(file.data(), 1, file.size(), f) == file.size());
+    std::fclose(f);
+  }
+  std::filesystem::remove(path);
+
+  std::size_t cursor{};
+  auto const read_u64{[&] { std::uint64_t v; std::memcpy(&v, file.data() + cursor, 8); cursor += 8; return v; }};
+  auto const read_u32{[&] { std::uint32_t v; std::memcpy(&v, file.data() + cursor, 4); cursor += 4; return v; }};
+  auto const read_str{[&](std::uint32_t const n) { std::string s(reinterpret_cast<char const *>(file.data() + cursor), n); cursor += n; return s; }};
+
+  HEIM_CHECK(read_u64() == heim::sparse::detail::columnar_magic);
+
+  std::vector<heim::sparse::column const *> expected;
+  for (auto const pool : {cols.get<position>().columns(), cols.get<health>().columns(), cols.get<colour>().columns()})
+  {
+    for (auto const &c : pool)
+      expected.push_back(&c);
+  }
+
+  HEIM_CHECK(read_u64() == expected.size());
+
+  bool matches{true};
+  for (auto const *c : expected)
+  {
+    std::uint64_t const length{read_u64()};
+    std::uint64_t const offset{read_u64()};
+    std::uint64_t const size  {read_u64()};
+    std::uint32_t const name  {read_u32()};
+    std::uint32_t const format{read_u32()};
+
+    matches = matches
+        && length == c->length
+        && offset % 64 == 0
+        && size == c->data.size()
+        && offset + size <= file.size()
+        && read_str(name) == c->name
+        && read_str(format) == c->format
+        && (size == 0 || std::memcmp(file.data() + offset, c->data.data(), size) == 0);
+  }
+  HEIM_CHECK(matches);
+}
+
+// a failing write reports the error of the failing call
+void
+test_write_error()
+{
+  if (!std::filesystem::exists("/dev/full"))
+    return;
+
+  registry reg{};
+  for (int i{}; i < 10000; ++i)
+    reg.entity().emplace<health>(i);
+
+  columns cols{{"position", "health", "colour"}};
+  cols.update(reg);
+
+  int error{};
+  try
+  { cols.write("/dev/full"); }
+  catch (std::system_error const &e)
+  { error = e.code().value(); }
+  HEIM_CHECK(error == ENOSPC);
+}
+
+
+int
+main()
+{
+  test_formats();
+  test_update();
+  test_write();
+  test_write_error();
+  return heim::test::failures;
+}
@@ -0,0 +1,113 @@
+#include <string>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+
+// has no default constructor, and owns memory that must be released by the buffers of the chunks
+struct label
+{
+  std::string value;
+
+  explicit
+  label(std::string v)
+    : value{std::move(v)}
+  { }
+};
+
+struct big { char bytes[40000]; };
+
+using registry
+= heim::sparse::static_registry::with_all<position, label, big>;
+
+
+// the components of the chunks of several components are written back to their entities, except
+// for the const ones, and the entities matched by the query are all visited once
+void
+test_conjunction()
+{
+  registry reg{};
+
+  for (int i{}; i < 1000; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(i);
+    if (i % 3 != 0)
+      e.emplace<label>(std::to_string(i));
+  }
+
+  std::size_t visited{};
+
+  reg.query<heim::conjunction<position, label>>().each_chunk<position, label const>(
+      [&](auto const ids, std::span<position> const p, std::span<label const> const l)
+      {
+        HEIM_CHECK(ids.size() == p.size() && p.size() == l.size());
+
+        for (std::size_t i{}; i < p.size(); ++i)
+        {
+          HEIM_CHECK(std::to_string(p[i].x) == l[i].value);
+          HEIM_CHECK(reg.get<position>(ids[i]).x == p[i].x);
+          p[i].x = -p[i].x;
+        }
+        visited += p.size();
+      });
+
+  HEIM_CHECK(visited == 666);
+
+  bool written{true};
+
+  for (auto e : reg.query<heim::conjunction<position>>())
+    written = written && (e.get<position>().x <= 0) == (reg.container<label>().contains(e.identifier()) || e.get<position>().x == 0);
+  HEIM_CHECK(written);
+
+  reg.query<heim::conjunction<label, position>>().each_chunk<label, position const>(
+      [](auto, std::span<label> const l, std::span<position const>)
+      {
+        for (label &lb : l)
+          lb.value += "!";
+      });
+
+  HEIM_CHECK(reg.get<label>((*reg.query<heim::conjunction<label>>().begin()).identifier()).value.back() == '!');
+}
+
+// components larger than the buffers of a chunk are passed one entity at a time
+void
+test_large()
+{
+  registry reg{};
+
+  for (int i{}; i < 3; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(i);
+    e.emplace<big>     ();
+    e.get<big>().bytes[0] = static_cast<char>(i);
+  }
+
+  std::size_t chunks{};
+
+  reg.query<heim::conjunction<position, big>>().each_chunk<position const, big>(
+      [&](auto, std::span<position const> const p, std::span<big> const b)
+      {
+        HEIM_CHECK(p.size() == 1 && b[0].bytes[0] == static_cast<char>(p[0].x));
+        b[0].bytes[1] = 'x';
+        ++chunks;
+      });
+
+  HEIM_CHECK(chunks == 3);
+
+  for (auto e : reg.query<heim::conjunction<big>>())
+    HEIM_CHECK(e.get<big>().bytes[1] == 'x');
+}
+
+
+int main()
+{
+  test_conjunction();
+  test_large();
+
+  return heim::test::failures;
+}
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+struct velocity { int dx; };
+struct tag      { };
+
+using registry
+= heim::sparse::static_registry::with_all<position, velocity, tag>;
+
+template<typename Expression>
+std::vector<registry::identifier_type>
+matched(registry &reg)
+{
+  std::vector<registry::identifier_type> ids;
+
+  for (auto e : reg.query<Expression>())
+    ids.push_back(e.identifier());
+  std::ranges::sort(ids);
+  return ids;
+}
+
+
+// queries of a single component, of several components and of the registry skip disabled
+// identifiers, which keep their components and are matched again once enabled
+void
+test_partitions()
+{
+  registry                               reg{};
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < 8; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(i);
+    if (i % 2 == 0)
+      e.emplace<velocity>(1);
+    ids.push_back(e.identifier());
+  }
+
+  reg.disable(ids[0]);
+  reg.disable(ids[3]);
+  reg.disable(ids[3]);
+
+  HEIM_CHECK(!reg.enabled(ids[0]) && !reg.enabled(ids[3]) && reg.enabled(ids[1]));
+  HEIM_CHECK(reg.get<position>(ids[0]).x == 0);
+  HEIM_CHECK(reg.container<position>().enabled_size() == 6);
+  HEIM_CHECK(reg.container<velocity>().enabled_size() == 3);
+
+  HEIM_CHECK((matched<heim::conjunction<position>>(reg)
+      == std::vector{ids[1], ids[2], ids[4], ids[5], ids[6], ids[7]}));
+  HEIM_CHECK((matched<heim::conjunction<position, velocity>>(reg)
+      == std::vector{ids[2], ids[4], ids[6]}));
+  HEIM_CHECK((matched<heim::conjunction<position, heim::negation<velocity>>>(reg)
+      == std::vector{ids[1], ids[5], ids[7]}));
+
+  reg.enable(ids[0]);
+  reg.enable(ids[0]);
+
+  HEIM_CHECK(reg.enabled(ids[0]));
+  HEIM_CHECK((matched<heim::conjunction<position, velocity>>(reg)
+      == std::vector{ids[0], ids[2], ids[4], ids[6]}));
+  HEIM_CHECK(reg.container<position>().enabled_size() == 7);
+}
+
+// components emplaced on a disabled identifier join it in the disabled range, and destroying a
+// disabled identifier keeps the partitions of its containers consistent
+void
+test_emplace_and_destroy()
+{
+  registry reg{};
+
+  auto a{reg.entity()};
+  auto b{reg.entity()};
+  auto c{reg.entity()};
+
+  a.emplace<position>(1);
+  b.emplace<position>(2);
+  c.emplace<position>(3);
+
+  b.disable();
+  b.emplace<velocity>(5);
+  b.emplace<tag>     ();
+
+  HEIM_CHECK(!b.enabled());
+  HEIM_CHECK(b.get<velocity>().dx == 5);
+  HEIM_CHECK(reg.container<velocity>().enabled_size() == 0);
+  HEIM_CHECK(matched<heim::conjunction<tag>>(reg).empty());
+
+  a.disable();
+  b.destroy();
+
+  HEIM_CHECK(reg.container<position>().size()         == 2);
+  HEIM_CHECK(reg.container<position>().enabled_size() == 1);
+  HEIM_CHECK(reg.container<velocity>().size()         == 0);
+  HEIM_CHECK((matched<heim::conjunction<position>>(reg) == std::vector{c.identifier()}));
+
+  a.enable();
+  HEIM_CHECK((matched<heim::conjunction<position>>(reg)
+      == std::vector{std::min(a.identifier(), c.identifier()), std::max(a.identifier(), c.identifier())}));
+}
+
+
+int main()
+{
+  test_partitions();
+  test_emplace_and_destroy();
+
+  return heim::test::failures;
+}
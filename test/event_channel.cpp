@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <vector>
+#include <heim/ecs/event_channel.hpp>
+#include "check.hpp"
+
+struct hit
+{
+  int source;
+  int sequence;
+};
+
+struct counted
+{
+  static inline int alive{};
+
+  counted()  noexcept { ++alive; }
+  ~counted() noexcept { --alive; }
+};
+
+
+// every event emitted concurrently by several producers is drained exactly once
+void
+test_producers()
+{
+  constexpr int producers{4};
+  constexpr int events   {20000};
+
+  heim::event_channel<hit, 256> channel{};
+  std::vector<std::thread>      threads;
+
+  for (int p{}; p < producers; ++p)
+    threads.emplace_back([&channel, p] { for (int i{}; i < events; ++i) channel.emit(p, i); });
+  for (std::thread &t : threads)
+    t.join();
+
+  HEIM_CHECK(channel.size() == std::size_t{producers * events});
+
+  std::vector<std::vector<int>> seen(producers);
+
+  channel.drain([&seen](std::span<hit> const span)
+  {
+    for (hit const &h : span)
+      seen[static_cast<std::size_t>(h.source)].push_back(h.sequence);
+  });
+
+  HEIM_CHECK(channel.empty());
+  for (std::vector<int> &sequences : seen)
+  {
+    std::ranges::sort(sequences);
+
+    HEIM_CHECK(sequences.size() == std::size_t{events});
+    HEIM_CHECK(std::ranges::adjacent_find(sequences) == sequences.end());
+  }
+}
+
+// clearing destroys the events and keeps the chunks for the next emissions
+void
+test_clear()
+{
+  {
+    heim::event_channel<counted, 8> channel{};
+
+    for (int i{}; i < 20; ++i)
+      channel.emit();
+    HEIM_CHECK(counted::alive == 20);
+
+    channel.clear();
+    HEIM_CHECK(counted::alive == 0);
+    HEIM_CHECK(channel.empty());
+
+    for (int i{}; i < 3; ++i)
+      channel.emit();
+    HEIM_CHECK(channel.size() == 3);
+  }
+  HEIM_CHECK(counted::alive == 0);
+}
+
+
+int main()
+{
+  test_producers();
+  test_clear();
+
+  return heim::test::failures;
+}
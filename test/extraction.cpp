@@ -0,0 +1,134 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <heim/registry.hpp>
+#include <heim/ecs/registry/sparse/extraction.hpp>
+#include "check.hpp"
+
+struct position { float x, y; };
+struct health   { int hp; };
+
+template<>
+struct heim::sparse::is_tracked_component<health>
+  : std::true_type
+{ };
+
+using registry
+= heim::sparse::static_registry::with_all<position, health>;
+
+
+// pools of untracked components report their structural version for every page, while pools of
+// tracked components stamp the pages they modify
+void
+test_page_versions()
+{
+  registry reg{};
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < 3000; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(static_cast<float>(i), 0.f);
+    e.emplace<health>(i);
+    ids.push_back(e.identifier());
+  }
+
+  auto const &positions{std::as_const(reg).container<position>()};
+  auto const &healths  {std::as_const(reg).container<health>()};
+
+  HEIM_CHECK(positions.page_count() == 3);
+  for (std::size_t pg_idx{}; pg_idx < positions.page_count(); ++pg_idx)
+    HEIM_CHECK(positions.page_version(pg_idx) == positions.structural_version());
+
+  auto const before{healths.page_version(0)};
+
+  reg.get<position>(ids[2500]).x = -1.f;
+  reg.get<health>  (ids[2500]).hp = -1;
+
+  HEIM_CHECK(positions.version() == positions.structural_version());
+  HEIM_CHECK(healths.page_version(0) == before);
+  HEIM_CHECK(healths.page_version(2) == healths.version());
+}
+
+// updating a snapshot only copies the modified pages of tracked pools, yet always matches the pools
+void
+test_pool_snapshot()
+{
+  registry reg{};
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < 2500; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(static_cast<float>(i), 0.f);
+    e.emplace<health>(i);
+    ids.push_back(e.identifier());
+  }
+
+  heim::sparse::registry_snapshot<registry, position, health> snapshot{};
+
+  auto const matches{[&]
+  {
+    auto const &hs{snapshot.get<health>()};
+    auto const &ps{snapshot.get<position>()};
+
+    bool equal{hs.size() == reg.container<health>().size() && ps.size() == reg.container<position>().size()};
+
+    for (std::size_t i{}; equal && i < hs.size(); ++i)
+      equal = hs.identifiers()[i] == std::as_const(reg).container<health>().identifiers()[i]
+           && hs.components ()[i].hp == std::as_const(reg).container<health>().components()[i].hp;
+    for (std::size_t i{}; equal && i < ps.size(); ++i)
+      equal = ps.identifiers()[i] == std::as_const(reg).container<position>().identifiers()[i]
+           && ps.components ()[i].x == std::as_const(reg).container<position>().components()[i].x;
+    return equal;
+  }};
+
+  snapshot.update(reg, 1);
+  HEIM_CHECK(snapshot.sequence() == 1);
+  HEIM_CHECK(matches());
+
+  reg.get<health>  (ids[10]).hp = 1000;
+  reg.get<position>(ids[20]).x  = 1000.f;
+  reg.destroy(ids[30]);
+  reg.destroy(ids[2499]);
+
+  auto e{reg.entity()};
+  e.emplace<health>(7);
+
+  snapshot.update(reg, 2);
+  HEIM_CHECK(matches());
+}
+
+// the consumer of an extractor sees the latest published extraction
+void
+test_extractor()
+{
+  registry reg{};
+  heim::sparse::snapshot_extractor<registry, health> extractor{};
+
+  auto e{reg.entity()};
+  e.emplace<health>(1);
+  extractor.extract(reg);
+
+  HEIM_CHECK(extractor.acquire().sequence() == 1);
+  HEIM_CHECK(extractor.acquire().get<health>().components()[0].hp == 1);
+
+  e.get<health>().hp = 2;
+  extractor.extract(reg);
+  extractor.extract(reg);
+
+  HEIM_CHECK(extractor.acquire().sequence() == 3);
+  HEIM_CHECK(extractor.acquire().get<health>().components()[0].hp == 2);
+}
+
+
+int main()
+{
+  test_page_versions();
+  test_pool_snapshot();
+  test_extractor();
+
+  return heim::test::failures;
+}
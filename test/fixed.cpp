@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+struct velocity { int dx; };
+
+using registry
+= heim::sparse::fixed_registry<4, position, velocity>;
+
+template<typename Expression>
+std::vector<int>
+matched(registry &reg)
+{
+  std::vector<int> xs;
+
+  for (auto e : reg.query<Expression>())
+    xs.push_back(reg.get<position>(e.identifier()).x);
+  std::ranges::sort(xs);
+  return xs;
+}
+
+
+// entities are created up to the capacity, past which no handle is returned, and a destroyed entity
+// frees a slot whose index is recycled under a new generation
+void
+test_capacity()
+{
+  registry                               reg{};
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < 4; ++i)
+  {
+    auto e{reg.entity()};
+
+    HEIM_CHECK(e.has_value());
+    e->emplace<position>(i);
+    ids.push_back(e->identifier());
+  }
+
+  HEIM_CHECK(reg.full() && reg.size() == registry::capacity());
+  HEIM_CHECK(!reg.entity().has_value());
+  HEIM_CHECK(reg.size() == 4);
+
+  HEIM_CHECK(reg.destroy(ids[1]));
+  HEIM_CHECK(!reg.destroy(ids[1]));
+  HEIM_CHECK(reg.expired(ids[1]) && !reg.full());
+  HEIM_CHECK(reg.get_if<position>(ids[1]) == nullptr);
+
+  auto const recycled{reg.entity()};
+
+  HEIM_CHECK(recycled.has_value());
+  HEIM_CHECK(heim::identifier_traits<registry::identifier_type>::index(recycled->identifier())
+      == heim::identifier_traits<registry::identifier_type>::index(ids[1]));
+  HEIM_CHECK(recycled->identifier() != ids[1] && reg.expired(ids[1]));
+  HEIM_CHECK(reg.full() && !reg.entity().has_value());
+
+  reg.clear();
+  HEIM_CHECK(reg.empty() && reg.entity().has_value());
+}
+
+// components are emplaced, replaced and erased in place, and queries skip the entities lacking them or
+// disabled until they are enabled again
+void
+test_components()
+{
+  registry                               reg{};
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < 4; ++i)
+  {
+    auto const id{reg.entity()->identifier()};
+
+    reg.emplace<position>(id, i);
+    if (i % 2 == 0)
+      reg.emplace<velocity>(id, i * 10);
+    ids.push_back(id);
+  }
+
+  HEIM_CHECK(!reg.try_emplace<position>(ids[0], 7) && reg.get<position>(ids[0]).x == 0);
+  HEIM_CHECK(!reg.insert_or_assign(ids[0], position{8}) && reg.get<position>(ids[0]).x == 8);
+  HEIM_CHECK(reg.insert(ids[1], velocity{1}) && reg.matches<velocity>(ids[1]));
+
+  HEIM_CHECK((matched<heim::conjunction<position, velocity>>(reg) == std::vector{1, 2, 8}));
+
+  reg.disable(ids[2]);
+  HEIM_CHECK(!reg.enabled(ids[2]) && reg.get<velocity>(ids[2]).dx == 20);
+  HEIM_CHECK((matched<heim::conjunction<position, velocity>>(reg) == std::vector{1, 8}));
+  HEIM_CHECK((matched<heim::conjunction<position, heim::negation<velocity>>>(reg) == std::vector{3}));
+
+  reg.emplace<velocity>(ids[3], 30);
+  HEIM_CHECK((matched<heim::conjunction<position, heim::negation<velocity>>>(reg).empty()));
+
+  reg.enable(ids[2]);
+  HEIM_CHECK(reg.try_erase<velocity>(ids[1]) && !reg.try_erase<velocity>(ids[1]));
+  HEIM_CHECK((matched<heim::conjunction<position, velocity>>(reg) == std::vector{2, 3, 8}));
+
+  reg.clear(ids[0]);
+  HEIM_CHECK(!reg.expired(ids[0]) && !reg.matches<position>(ids[0]));
+}
+
+// a copy holds its own storage, left untouched by changes to the original
+void
+test_copy()
+{
+  registry reg{};
+
+  auto const id{reg.entity()->identifier()};
+  reg.emplace<position>(id, 1);
+
+  registry copy{reg};
+
+  reg.get<position>(id).x = 2;
+  reg.destroy(id);
+
+  HEIM_CHECK(copy.size() == 1 && !copy.expired(id));
+  HEIM_CHECK(copy.get<position>(id).x == 1);
+}
+
+
+int
+main()
+{
+  test_capacity();
+  test_components();
+  test_copy();
+  return heim::test::failures;
+}
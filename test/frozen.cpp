@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+struct velocity { int dx; };
+
+using registry
+= heim::sparse::static_registry::with_all<position, velocity>;
+
+// six entities, the second destroyed so that its index is recycled by the last, the third disabled
+inline constexpr auto frozen{heim::sparse::freeze<[]
+{
+  registry                                 reg{};
+  std::array<registry::identifier_type, 5> ids{};
+
+  for (int i{}; i < 5; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(i);
+    if (i % 2 == 0)
+      e.emplace<velocity>(i * 10);
+    ids[static_cast<std::size_t>(i)] = e.identifier();
+  }
+  reg.destroy(ids[1]);
+  reg.entity().emplace<position>(5);
+  reg.disable(ids[2]);
+  return reg;
+}>()};
+
+template<typename Expression>
+std::vector<int>
+matched()
+{
+  std::vector<int> xs;
+
+  for (auto e : frozen.query<Expression>())
+    xs.push_back(frozen.get<position>(e.identifier()).x);
+  std::ranges::sort(xs);
+  return xs;
+}
+
+
+// the live identifiers are found by their index, an identifier of a recycled index or past the
+// largest index is expired, and only the enabled ones are enabled
+void
+test_lookup()
+{
+  using traits = heim::identifier_traits<registry::identifier_type>;
+
+  HEIM_CHECK(frozen.size() == 5 && frozen.enabled_size() == 4);
+
+  std::size_t enabled{};
+  for (auto const id : frozen.identifiers())
+  {
+    HEIM_CHECK(frozen.contains(id) && !frozen.expired(id));
+    enabled += frozen.enabled(id);
+  }
+  HEIM_CHECK(enabled == 4);
+
+  for (std::size_t i{}; i < frozen.enabled_size(); ++i)
+    HEIM_CHECK(frozen.enabled(frozen.identifiers()[i]));
+  HEIM_CHECK(!frozen.enabled(frozen.identifiers().back()));
+  HEIM_CHECK(frozen.get<position>(frozen.identifiers().back()).x == 2);
+
+  for (auto const id : frozen.identifiers())
+  {
+    auto const stale{traits::next(id)};
+
+    HEIM_CHECK(!frozen.contains(stale) && frozen.expired(stale) && !frozen.enabled(stale));
+  }
+
+  auto const beyond{traits::from(64, 0)};
+  HEIM_CHECK(!frozen.contains(beyond) && !frozen.enabled(beyond));
+
+  static_assert(frozen.contains(frozen.identifiers()[0]));
+}
+
+// queries iterate the enabled entities matching their expression, with the components of the registry
+void
+test_query()
+{
+  HEIM_CHECK((matched<heim::conjunction<position>>() == std::vector{0, 3, 4, 5}));
+  HEIM_CHECK((matched<heim::conjunction<position, velocity>>() == std::vector{0, 4}));
+  HEIM_CHECK((matched<heim::conjunction<position, heim::negation<velocity>>>() == std::vector{3, 5}));
+
+  for (auto const id : frozen.identifiers<velocity>())
+    HEIM_CHECK(frozen.get<velocity>(id).dx == frozen.get<position>(id).x * 10);
+  HEIM_CHECK(frozen.get_if<velocity>(frozen.identifiers().back()) != nullptr);
+  HEIM_CHECK(frozen.get_if<velocity>(heim::identifier_traits<registry::identifier_type>::from(64, 0)) == nullptr);
+}
+
+
+int
+main()
+{
+  test_lookup();
+  test_query();
+  return heim::test::failures;
+}
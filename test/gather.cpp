@@ -0,0 +1,137 @@
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct health { int hp; };
+struct armour { int value; };
+
+template<>
+struct heim::sparse::is_tracked_component<armour>
+  : std::true_type
+{ };
+
+using identifier
+= heim::default_identifier_t<>;
+
+template<typename Component>
+using pool
+= heim::sparse::pool<Component, identifier>;
+
+using traits
+= heim::identifier_traits<identifier>;
+
+
+// gathers and scatters a number of identifiers that is not a multiple of the batch size, in an order
+// unrelated to their positions
+void
+test_round_trip()
+{
+  pool<health>            hp{};
+  std::vector<identifier> ids;
+
+  for (std::uint32_t i{}; i < 100; ++i)
+    hp.emplace(traits::from(i, 0), static_cast<int>(i));
+  for (std::uint32_t i{99}; i >= 3; i -= 2)
+    ids.push_back(traits::from(i, 0));
+
+  HEIM_CHECK(ids.size() % 16 != 0 && ids.size() > 16);
+
+  std::vector<health> out(ids.size());
+  hp.gather(ids, out);
+
+  bool gathered{true};
+  for (std::size_t i{}; i < ids.size(); ++i)
+    gathered = gathered && out[i].hp == static_cast<int>(traits::index(ids[i]));
+  HEIM_CHECK(gathered);
+
+  for (health &h : out)
+    h.hp = -h.hp;
+  hp.scatter(ids, out);
+
+  bool scattered{true};
+  for (std::uint32_t i{}; i < 100; ++i)
+    scattered = scattered && hp[traits::from(i, 0)].hp == (i % 2 == 1 && i >= 3 ? -static_cast<int>(i) : static_cast<int>(i));
+  HEIM_CHECK(scattered);
+}
+
+// buffers smaller than the identifiers are rejected before anything is copied
+void
+test_short_buffers()
+{
+  pool<health>                                     hp   {};
+  heim::sparse::fixed_pool<health, identifier, 64> fixed{};
+  std::vector<identifier>                          ids;
+
+  for (std::uint32_t i{}; i < 20; ++i)
+  {
+    hp   .emplace(traits::from(i, 0), 1);
+    fixed.emplace(traits::from(i, 0), 1);
+    ids.push_back(traits::from(i, 0));
+  }
+
+  std::vector<health> const in(19, health{2});
+  std::vector<health>       out(19);
+
+  auto const throws{[](auto &&f)
+  {
+    try
+    { f(); }
+    catch (std::out_of_range const &)
+    { return true; }
+    return false;
+  }};
+
+  HEIM_CHECK(throws([&] { hp   .gather (ids, out); }));
+  HEIM_CHECK(throws([&] { hp   .scatter(ids, in);  }));
+  HEIM_CHECK(throws([&] { fixed.gather (ids, out); }));
+  HEIM_CHECK(throws([&] { fixed.scatter(ids, in);  }));
+  HEIM_CHECK(hp[ids[0]].hp == 1 && fixed[ids[0]].hp == 1);
+
+  HEIM_CHECK(!throws([&] { hp.gather(std::span{ids}.first(19), out); }));
+}
+
+// scattering to a tracked pool stamps exactly the dense pages of the identifiers it writes to
+void
+test_page_stamping()
+{
+  constexpr std::size_t page{pool<armour>::dense_page_size};
+
+  pool<armour> ar{};
+
+  for (std::uint32_t i{}; i < 3 * page; ++i)
+    ar.emplace(traits::from(i, 0), 0);
+
+  std::vector<identifier> ids;
+  std::vector<armour>     in;
+  for (std::size_t pos{page + 5}; pos < page + 5 + 37; ++pos)
+  {
+    ids.push_back(ar.identifiers()[pos]);
+    in .push_back(armour{7});
+  }
+
+  std::vector<std::uint64_t> before;
+  for (std::size_t pg{}; pg < 3; ++pg)
+    before.push_back(ar.page_version(pg));
+
+  ar.scatter(ids, in);
+
+  HEIM_CHECK(ar.page_version(0) == before[0]);
+  HEIM_CHECK(ar.page_version(1) >  before[1]);
+  HEIM_CHECK(ar.page_version(2) == before[2]);
+  HEIM_CHECK(std::as_const(ar)[ids.back()].value == 7);
+}
+
+
+int
+main()
+{
+  test_round_trip();
+  test_short_buffers();
+  test_page_stamping();
+  return heim::test::failures;
+}
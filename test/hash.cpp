@@ -0,0 +1,138 @@
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct health { int points; };
+struct padded { char c; int i; };
+struct mass   { double kg; };
+
+template<>
+struct heim::sparse::is_tracked_component<health>
+  : std::true_type
+{ };
+
+// the padding byte of padded is left out by hashing its members
+template<>
+struct heim::sparse::component_hash<padded>
+{
+  [[nodiscard]]
+  std::uint64_t
+  operator()(padded const &p, std::uint64_t const seed) const
+  noexcept
+  { return heim::hash_values(seed, p.c, p.i); }
+};
+
+static_assert( heim::sparse::hashable_component<health>);
+static_assert( heim::sparse::hashable_component<double>);
+static_assert( heim::sparse::hashable_component<padded>);
+static_assert(!heim::sparse::hashable_component<mass>);
+
+using registry
+= heim::sparse::static_registry::with_all<health, padded>;
+
+
+// the cached hash matches the full hash after each kind of modification, of tracked and untracked
+// components alike
+void
+test_cache()
+{
+  registry                               reg{};
+  registry::hash_cache                   cache{};
+  std::vector<registry::identifier_type> ids;
+
+  for (int i{}; i < 3000; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<health>(i);
+    if (i % 3 == 0)
+      e.emplace<padded>('a', i);
+    ids.push_back(e.identifier());
+  }
+
+  auto const agree{[&] { return reg.hash(cache) == reg.hash(); }};
+
+  HEIM_CHECK(agree());
+  HEIM_CHECK(agree());
+
+  auto const before{reg.hash()};
+
+  reg.get<health>(ids[2500]).points = -1;
+  HEIM_CHECK(agree() && reg.hash() != before);
+
+  reg.get<padded>(ids[300]).i = -1;
+  HEIM_CHECK(agree());
+
+  reg.container<health>().components()[10].points = -2;
+  HEIM_CHECK(agree());
+
+  std::array<health, 2> const in{health{7}, health{8}};
+  std::array                  targets{ids[1200], ids[20]};
+  reg.container<health>().scatter(targets, in);
+  HEIM_CHECK(agree());
+
+  reg.disable(ids[5]);
+  HEIM_CHECK(agree());
+
+  reg.destroy(ids[6]);
+  reg.destroy(ids[2999]);
+  HEIM_CHECK(agree());
+
+  reg.enable(ids[5]);
+  HEIM_CHECK(agree());
+}
+
+// the hash does not depend on the order in which components were inserted or entities enabled, nor
+// on the padding bytes of components
+void
+test_order()
+{
+  registry lhs{};
+  registry rhs{};
+
+  std::vector<registry::identifier_type> ids;
+  for (int i{}; i < 64; ++i)
+  {
+    ids.push_back(lhs.entity().identifier());
+    static_cast<void>(rhs.entity());
+  }
+
+  for (int i{}; i < 64; ++i)
+  {
+    lhs.emplace<health>(ids[static_cast<std::size_t>(i)], i);
+    rhs.emplace<health>(ids[static_cast<std::size_t>(63 - i)], 63 - i);
+  }
+
+  padded lhs_padded;
+  padded rhs_padded;
+  std::memset(&lhs_padded, 0x00, sizeof(padded));
+  std::memset(&rhs_padded, 0xff, sizeof(padded));
+  lhs_padded.c = rhs_padded.c = 'x';
+  lhs_padded.i = rhs_padded.i = 4;
+  lhs.insert(ids[7], std::move(lhs_padded));
+  rhs.insert(ids[7], std::move(rhs_padded));
+
+  lhs.disable(ids[1]);
+  lhs.disable(ids[2]);
+  rhs.disable(ids[2]);
+  rhs.disable(ids[1]);
+
+  HEIM_CHECK(lhs.hash() == rhs.hash());
+
+  rhs.enable(ids[1]);
+  HEIM_CHECK(lhs.hash() != rhs.hash());
+}
+
+
+int
+main()
+{
+  test_cache();
+  test_order();
+  return heim::test::failures;
+}
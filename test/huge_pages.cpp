@@ -0,0 +1,130 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <heim/lib/huge_page_allocator.hpp>
+#include "check.hpp"
+
+// counts the allocations forwarded to it by the huge page allocator
+template<typename T>
+struct counting_allocator
+{
+  using value_type = T;
+
+  inline static std::size_t allocations{};
+
+  counting_allocator() = default;
+
+  template<typename U>
+  counting_allocator(counting_allocator<U> const &)
+  noexcept
+  { }
+
+  T *
+  allocate(std::size_t const n)
+  {
+    ++allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+
+  void
+  deallocate(T * const ptr, std::size_t const n)
+  noexcept
+  { std::allocator<T>{}.deallocate(ptr, n); }
+
+  template<typename U>
+  bool
+  operator==(counting_allocator<U> const &) const
+  noexcept
+  { return true; }
+};
+
+struct huge { std::byte bytes[heim::huge_page_size + 64]; };
+
+bool
+aligned(void const * const ptr)
+{ return reinterpret_cast<std::uintptr_t>(ptr) % heim::huge_page_size == 0; }
+
+template<typename T>
+using allocator
+= heim::huge_page_allocator<T, counting_allocator<T>>;
+
+
+// allocations below the threshold go to the underlying allocator, and those of at least the threshold
+// are mapped aligned to huge pages, and can be written to their end
+void
+test_threshold()
+{
+  allocator<std::uint32_t> alloc{};
+  constexpr std::size_t    large{heim::huge_page_size / sizeof(std::uint32_t)};
+
+  std::size_t const before{counting_allocator<std::uint32_t>::allocations};
+
+  std::uint32_t *const small{alloc.allocate(large - 1)};
+  HEIM_CHECK(counting_allocator<std::uint32_t>::allocations == before + 1);
+  alloc.deallocate(small, large - 1);
+
+  for (std::size_t const n : {large, large + 1, 3 * large + 7})
+  {
+    std::uint32_t *const ptr{alloc.allocate(n)};
+
+    HEIM_CHECK(counting_allocator<std::uint32_t>::allocations == before + 1);
+    HEIM_CHECK(aligned(ptr));
+
+    for (std::size_t i{}; i < n; ++i)
+      ptr[i] = static_cast<std::uint32_t>(i);
+
+    bool intact{true};
+    for (std::size_t i{}; i < n; ++i)
+      intact = intact && ptr[i] == static_cast<std::uint32_t>(i);
+    HEIM_CHECK(intact);
+
+    alloc.deallocate(ptr, n);
+  }
+}
+
+// elements larger than a huge page are mapped from a single one, while no element at all goes to the
+// underlying allocator instead of mapping nothing
+void
+test_large_elements()
+{
+  allocator<huge>   alloc{};
+  std::size_t const before{counting_allocator<huge>::allocations};
+
+  huge *const none{alloc.allocate(0)};
+  HEIM_CHECK(counting_allocator<huge>::allocations == before + 1);
+  alloc.deallocate(none, 0);
+
+  huge *const one{alloc.allocate(1)};
+  HEIM_CHECK(counting_allocator<huge>::allocations == before + 1);
+  HEIM_CHECK(aligned(one));
+  one->bytes[sizeof(huge) - 1] = std::byte{7};
+  HEIM_CHECK(one->bytes[sizeof(huge) - 1] == std::byte{7});
+  alloc.deallocate(one, 1);
+}
+
+// containers round trip through the allocator as they grow past the threshold and shrink back
+void
+test_container()
+{
+  std::vector<std::uint64_t, allocator<std::uint64_t>> values;
+
+  for (std::uint64_t i{}; i < 1'000'000; ++i)
+    values.push_back(i);
+  HEIM_CHECK(aligned(values.data()));
+  HEIM_CHECK(values[999'999] == 999'999);
+
+  values.resize(16);
+  values.shrink_to_fit();
+  HEIM_CHECK(values.size() == 16 && values[15] == 15);
+}
+
+
+int
+main()
+{
+  test_threshold();
+  test_large_elements();
+  test_container();
+  return heim::test::failures;
+}
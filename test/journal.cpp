@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <heim/registry.hpp>
+#include <heim/ecs/registry/sparse/journal.hpp>
+#include "check.hpp"
+
+struct position { float x, y; };
+struct health   { int points; };
+struct tag      { };
+
+template<>
+struct heim::sparse::component_hash<position>
+{
+  [[nodiscard]]
+  std::uint64_t
+  operator()(position const &p, std::uint64_t const seed) const
+  noexcept
+  { return heim::hash_values(seed, p.x, p.y); }
+};
+
+using registry
+= heim::sparse::static_registry::with_all<position, health, tag>;
+
+using identifier
+= registry::identifier_type;
+
+
+// makes operations of every kind on the specified registry through a journal written to the
+// specified file
+void
+record(registry &reg, char const * const path)
+{
+  heim::sparse::registry_journal journal{reg, path};
+
+  std::vector<identifier> ids;
+
+  ids.push_back(journal.create());
+  journal.create(100, std::back_inserter(ids));
+
+  for (std::size_t i{}; i < ids.size(); ++i)
+  {
+    journal.emplace<position>(ids[i], static_cast<float>(i), 1.f);
+    if (i % 2 == 0)
+      journal.emplace<health>(ids[i], static_cast<int>(i));
+    if (i % 5 == 0)
+      journal.emplace<tag>(ids[i]);
+  }
+
+  journal.assign<position>(ids[3], position{-1.f, -2.f});
+  journal.erase <health>  (ids[4]);
+  journal.disable(ids[6]);
+  journal.disable(ids[7]);
+  journal.enable (ids[7]);
+  journal.destroy(ids[8]);
+  journal.destroy(ids[9]);
+
+  // recycles the indices of the destroyed identifiers
+  journal.create(3, std::back_inserter(ids));
+  journal.emplace<health>(ids.back(), 42);
+
+  journal.flush();
+}
+
+// replaying a journal on a registry in the state the journaled one was in when the journal was
+// opened recreates the same identifiers, components and enabled states
+void
+test_replay(char const * const path)
+{
+  registry original{};
+  registry replayed{};
+
+  record(original, path);
+
+  std::size_t const operations{heim::sparse::replay_journal(replayed, path)};
+
+  HEIM_CHECK(operations > 0);
+  HEIM_CHECK(replayed.size() == original.size());
+  HEIM_CHECK(replayed.hash() == original.hash());
+  HEIM_CHECK(replayed.container<health>().size() == original.container<health>().size());
+
+  bool same{true};
+
+  for (auto e : original.query<heim::conjunction<position>>())
+  {
+    same = same
+        && replayed.enabled(e.identifier()) == e.enabled()
+        && replayed.get<position>(e.identifier()).x == e.get<position>().x;
+  }
+  HEIM_CHECK(same);
+}
+
+// an operation truncated by a crash is ignored, and a journal of another registry is rejected
+void
+test_truncated(char const * const path)
+{
+  registry original{};
+  registry replayed{};
+
+  record(original, path);
+
+  std::size_t const full{heim::sparse::replay_journal(replayed, path)};
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 3);
+
+  registry truncated{};
+
+  HEIM_CHECK(heim::sparse::replay_journal(truncated, path) == full - 1);
+
+  using other_registry
+  = heim::sparse::static_registry::with_all<position>;
+
+  other_registry other{};
+  bool           rejected{};
+
+  try
+  { static_cast<void>(heim::sparse::replay_journal(other, path)); }
+  catch (std::runtime_error const &)
+  { rejected = true; }
+
+  HEIM_CHECK(rejected);
+}
+
+
+int main()
+{
+  std::string const path{(std::filesystem::temp_directory_path() / ("heim-journal-" + std::to_string(::getpid()))).string()};
+
+  test_replay   (path.c_str());
+  test_truncated(path.c_str());
+
+  std::filesystem::remove(path);
+  return heim::test::failures;
+}
@@ -0,0 +1,118 @@
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <unistd.h>
+#include <heim/lib.hpp>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { double x, y; };
+struct velocity { double dx, dy; };
+
+using allocator
+= heim::numa_allocator<heim::default_identifier_t<>>;
+
+using registry
+= heim::sparse::generic_static_registry<heim::default_identifier_t<>, allocator>
+    ::with<position>
+    ::with<velocity, heim::sparse::default_page_size_v<>, 0>;
+
+bool
+valid_node(int const node)
+{ return node == heim::numa_first_touch || (node >= 0 && node < heim::numa_node_count()); }
+
+
+// the pool of a descriptor bound to a node keeps that node through copies, moves and allocator-extended
+// copies, while the other pools follow the allocator of the registry
+void
+test_descriptor_node()
+{
+  registry reg{allocator{heim::numa_first_touch}};
+
+  HEIM_CHECK(reg.container<position>().get_allocator().node() == heim::numa_first_touch);
+  HEIM_CHECK(reg.container<velocity>().get_allocator().node() == 0);
+
+  for (int i{}; i < 20000; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(double(i), 0.);
+    e.emplace<velocity>(1., double(i));
+  }
+
+  // the dense arrays are large enough to be mapped with the policy of their allocator, which a
+  // machine of a single node, or without memory policies, ignores
+  HEIM_CHECK(valid_node(heim::numa_node_of(reg.container<velocity>().components().data())));
+  HEIM_CHECK(valid_node(heim::numa_node_of(reg.container<position>().components().data())));
+
+  registry copy{reg};
+  HEIM_CHECK(copy.container<velocity>().get_allocator().node() == 0);
+  HEIM_CHECK(copy.container<position>().get_allocator().node() == heim::numa_first_touch);
+
+  registry moved{std::move(copy)};
+  HEIM_CHECK(moved.container<velocity>().get_allocator().node() == 0);
+  HEIM_CHECK(moved.size() == 20000);
+
+  bool consistent{true};
+  for (auto e : moved.query<heim::conjunction<position, velocity>>())
+    consistent = consistent && e.get<position>().x == e.get<velocity>().dy;
+  HEIM_CHECK(consistent);
+}
+
+// touching a range from a worker leaves its contents as they were, whatever the alignment of its ends
+void
+test_touch()
+{
+  registry reg{allocator{}};
+
+  for (int i{}; i < 20000; ++i)
+    reg.entity().emplace<position>(double(i), -double(i));
+
+  auto const components{reg.container<position>().components()};
+
+  heim::numa_touch(std::span{components}.subspan(3, 9000));
+  heim::numa_touch(std::span{components}.subspan(0, 0));
+  heim::numa_touch(components);
+
+  bool unchanged{true};
+  for (std::size_t i{}; i < components.size(); ++i)
+  {
+    auto const id{reg.container<position>().identifiers()[i]};
+    unchanged = unchanged && components[i].x == -components[i].y && reg.get<position>(id).x == components[i].x;
+  }
+  HEIM_CHECK(unchanged && components.size() == 20000);
+  HEIM_CHECK(valid_node(heim::numa_node_of(components.data())));
+  HEIM_CHECK(heim::numa_current_node() >= 0 && heim::numa_current_node() < heim::numa_node_count());
+
+  // binding to a node the machine lacks fails without changing the range
+  HEIM_CHECK(!heim::numa_bind(components, heim::numa_node_count() + 1024));
+  HEIM_CHECK(components[5].x == -components[5].y);
+}
+
+// elements larger than the threshold are mapped one at a time, while no element at all is never mapped
+void
+test_large_elements()
+{
+  struct large { std::byte bytes[heim::numa_allocator<std::byte>::threshold + 8]; };
+
+  heim::numa_allocator<large> alloc{};
+
+  large *const none{alloc.allocate(0)};
+  alloc.deallocate(none, 0);
+
+  large *const one{alloc.allocate(1)};
+  HEIM_CHECK(reinterpret_cast<std::uintptr_t>(one) % static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE)) == 0);
+  one->bytes[sizeof(large) - 1] = std::byte{1};
+  alloc.deallocate(one, 1);
+}
+
+
+int
+main()
+{
+  test_descriptor_node();
+  test_touch();
+  test_large_elements();
+  return heim::test::failures;
+}
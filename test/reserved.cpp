@@ -0,0 +1,123 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+struct velocity { int dx; };
+
+using registry
+= heim::sparse::static_registry
+    ::with<position, heim::sparse::reserved_page_size_v<>>
+    ::with<velocity, heim::sparse::reserved_page_size_v<>>;
+
+
+// creates the specified number of entities, all with a position and every third with a velocity,
+// then checks lookups, queries, erasure, recycling, copies and clearing
+void
+run(std::size_t const n)
+{
+  registry                               reg{};
+  std::vector<registry::identifier_type> ids;
+
+  for (std::size_t i{}; i < n; ++i)
+  {
+    auto e{reg.entity()};
+
+    e.emplace<position>(static_cast<int>(i));
+    if (i % 3 == 0)
+      e.emplace<velocity>(static_cast<int>(i));
+    ids.push_back(e.identifier());
+  }
+
+  std::size_t matched{};
+  bool        consistent{true};
+  for (auto e : reg.query<heim::conjunction<position, velocity>>())
+  {
+    consistent = consistent && e.get<position>().x == e.get<velocity>().dx;
+    ++matched;
+  }
+  HEIM_CHECK(consistent && matched == (n + 2) / 3);
+
+  for (std::size_t i{}; i < n; i += 2)
+    reg.destroy(ids[i]);
+
+  bool found{true};
+  for (std::size_t i{}; i < n; ++i)
+  {
+    bool const alive{i % 2 == 1};
+
+    found = found
+         && reg.expired(ids[i]) != alive
+         && (reg.get_if<position>(ids[i]) != nullptr) == alive
+         && (!alive || reg.get<position>(ids[i]).x == static_cast<int>(i))
+         && reg.matches<velocity>(ids[i]) == (alive && i % 3 == 0);
+  }
+  HEIM_CHECK(found);
+
+  auto const recycled{reg.entity().identifier()};
+  reg.emplace<position>(recycled, -1);
+  HEIM_CHECK(reg.get<position>(recycled).x == -1 && !reg.matches<velocity>(recycled));
+
+  HEIM_CHECK(!reg.matches<position>(heim::identifier_traits<registry::identifier_type>::null));
+  HEIM_CHECK(!reg.matches<velocity>(heim::identifier_traits<registry::identifier_type>::from(static_cast<std::uint32_t>(n * 4), 0)));
+
+  registry copy{reg};
+
+  reg.clear();
+  HEIM_CHECK(reg.empty() && !reg.matches<position>(recycled));
+  HEIM_CHECK(copy.get<position>(recycled).x == -1);
+  HEIM_CHECK(copy.get<position>(ids[1]).x == 1 && copy.expired(ids[0]));
+  HEIM_CHECK(copy.container<position>().size() == n / 2 + 1);
+}
+
+
+// a registry of reserved containers behaves the same whether every index is reserved
+void
+test_reserved()
+{ run(5000); }
+
+// or whether the address space is too small for that reservation, in which case the containers map
+// the positions of the indices they hold and grow those mappings
+void
+test_limited()
+{
+  pid_t const pid{::fork()};
+
+  if (pid == 0)
+  {
+    long       pages{};
+    std::FILE *file {std::fopen("/proc/self/statm", "r")};
+
+    if (file == nullptr || std::fscanf(file, "%ld", &pages) != 1)
+      ::_exit(1);
+    std::fclose(file);
+
+    auto const used {static_cast<rlim_t>(pages) * static_cast<rlim_t>(::sysconf(_SC_PAGESIZE))};
+    rlimit     limit{used + (rlim_t{1} << 30), used + (rlim_t{1} << 30)};
+
+    if (::setrlimit(RLIMIT_AS, &limit) != 0)
+      ::_exit(1);
+
+    run(5000);
+    ::_exit(heim::test::failures);
+  }
+
+  int status{};
+  HEIM_CHECK(pid > 0 && ::waitpid(pid, &status, 0) == pid);
+  HEIM_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+
+int
+main()
+{
+  test_reserved();
+  test_limited();
+  return heim::test::failures;
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct shield { int strength; bool operator==(shield const &) const = default; };
+struct burn   { int damage;   bool operator==(burn   const &) const = default; };
+
+using registry
+= heim::sparse::static_registry::with_all<shield, burn>;
+
+using scheduler
+= heim::sparse::detail::registry_scheduler<std::uint64_t>;
+
+
+// every scheduled action becomes due at its exact tick, including those beyond the range of the
+// wheel, which wait in its overflow
+void
+test_wheel()
+{
+  constexpr std::uint64_t horizon{std::uint64_t{1} << 24};
+
+  scheduler                  wheel   {std::allocator<std::uint64_t>{}};
+  std::mt19937_64            rng     {78};
+  std::vector<std::uint64_t> expected;
+
+  for (std::uint64_t id{}; id < 2000; ++id)
+  {
+    std::uint64_t const ticks{id < 1000 ? rng() % 5000 : rng() % (horizon + 1000)};
+
+    wheel.schedule(id, 0, ticks);
+    expected.push_back(std::max(ticks, std::uint64_t{1}));
+  }
+  std::ranges::sort(expected);
+
+  bool        exact{true};
+  std::size_t next {};
+
+  for (std::uint64_t tick{1}; tick <= horizon + 1000; ++tick)
+  {
+    auto const &due{wheel.advance()};
+
+    if (due.empty() && (next == expected.size() || expected[next] != tick))
+      continue;
+
+    for (auto const &e : due)
+      exact = exact && e.due == tick && next < expected.size() && expected[next++] == tick;
+  }
+
+  HEIM_CHECK(exact);
+  HEIM_CHECK(next == expected.size());
+}
+
+// scheduled removals and destructions are performed by the ticks of the registry, and skipped once
+// their target is gone
+void
+test_registry()
+{
+  registry reg{};
+
+  auto a{reg.entity()};
+  auto b{reg.entity()};
+  auto c{reg.entity()};
+
+  a.emplace<shield>(3);
+  a.emplace<burn>  (1);
+  b.emplace<burn>  (2);
+  c.emplace<shield>(4);
+
+  a.expire_after<shield>(2);
+  b.expire_after<burn>  (1);
+  c.destroy_after       (3);
+  b.destroy_after       (2);
+  b.destroy();
+
+  // recycles the index of b, which the destruction scheduled for b must not affect
+  auto d{reg.entity()};
+
+  reg.tick();
+  HEIM_CHECK(a.matches<shield>());
+  HEIM_CHECK(b.expired());
+
+  reg.tick();
+  HEIM_CHECK(!a.matches<shield>());
+  HEIM_CHECK( a.matches<burn>());
+  HEIM_CHECK(!c.expired());
+
+  reg.tick();
+  HEIM_CHECK(c.expired());
+  HEIM_CHECK(!d.expired());
+  HEIM_CHECK(reg.current_tick() == 3);
+  HEIM_CHECK(reg.size() == 2);
+}
+
+// registries of the same entities and components are equal whatever their ticks and scheduled actions
+void
+test_equality()
+{
+  registry lhs{};
+  registry rhs{};
+
+  auto a{lhs.entity()};
+  auto b{lhs.entity()};
+  auto c{rhs.entity()};
+  auto d{rhs.entity()};
+
+  a.emplace<shield>(1);
+  b.emplace<burn>  (2);
+  c.emplace<shield>(1);
+  d.emplace<burn>  (2);
+
+  a.expire_after<shield>(5);
+  b.destroy_after       (7);
+  d.destroy_after       (7);
+  c.expire_after<shield>(5);
+  rhs.tick();
+
+  HEIM_CHECK(lhs == rhs);
+
+  rhs.get<burn>(d.identifier()).damage = 3;
+  HEIM_CHECK(lhs != rhs);
+}
+
+
+int main()
+{
+  test_wheel();
+  test_registry();
+  test_equality();
+
+  return heim::test::failures;
+}
@@ -0,0 +1,240 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <heim/registry.hpp>
+#include <heim/ecs/registry/sparse/shared_registry.hpp>
+#include "check.hpp"
+
+struct value { int v; };
+struct twice { int v; };
+
+using registry
+= heim::sparse::shared_static_registry<value, twice>;
+
+using identifier
+= registry::identifier_type;
+
+
+// runs queries on the registry in place, checking in each read section that every entity has both
+// components, consistent with each other, and that there are as many as the specified number if it is
+// not zero, until the specified number of read sections is done and the registry has grown to the
+// specified size, and returns the number of failures
+int
+reader(std::string const &name, std::size_t const entities, std::size_t const reads, std::size_t const until)
+{
+  auto const segment{heim::shared_memory_segment::attach(name)};
+
+  for (std::size_t done{}, size{}; done < reads || size < until; )
+  {
+    bool consistent{true};
+    bool found     {segment.read<registry>([&](registry const &reg)
+    {
+      std::size_t matched{};
+
+      for (auto e : reg.query<heim::conjunction<value, twice>>())
+      {
+        consistent = consistent && e.get<twice>().v == 2 * e.get<value>().v;
+        ++matched;
+      }
+      consistent = consistent && matched == reg.size() && (entities == 0 || matched == entities);
+      size       = matched;
+    })};
+
+    if (found)
+    {
+      ++done;
+      HEIM_CHECK(consistent);
+    }
+  }
+  return heim::test::failures;
+}
+
+// runs the specified writer in back-to-back write sections while a forked reader runs the specified
+// number of read sections, and checks that the reader neither crashed, nor observed a state being
+// modified, nor was starved
+template<typename F>
+void
+race(heim::shared_memory_segment &segment, std::size_t const entities, std::size_t const reads, std::size_t const until, F &&f)
+{
+  pid_t const child{::fork()};
+
+  // the failures of the parent so far are not the reader's
+  if (child == 0)
+  {
+    heim::test::failures = 0;
+    std::_Exit(reader(segment.name(), entities, reads, until));
+  }
+
+  auto const deadline{std::chrono::steady_clock::now() + std::chrono::seconds{60}};
+  int        status  {};
+
+  while (::waitpid(child, &status, WNOHANG) == 0)
+  {
+    if (std::chrono::steady_clock::now() > deadline)
+    {
+      ::kill(child, SIGKILL);
+      ::waitpid(child, &status, 0);
+      break;
+    }
+
+    segment.write(f);
+  }
+
+  HEIM_CHECK(WIFEXITED(status));
+  HEIM_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+// a reader running queries while the writer recycles entities
+void
+test_reader_writer()
+{
+  constexpr std::size_t entities{1024};
+
+  std::string const name{"/heim-test-" + std::to_string(::getpid())};
+
+  auto      segment{heim::shared_memory_segment::create(name, std::size_t{64} << 20)};
+  registry &reg    {segment.construct<registry>(segment.get_allocator<identifier>())};
+
+  std::vector<identifier> ids;
+  int                     next{static_cast<int>(entities)};
+
+  segment.write([&]
+  {
+    for (int i{}; i < static_cast<int>(entities); ++i)
+    {
+      auto e{reg.entity()};
+
+      e.emplace<value>(i);
+      e.emplace<twice>(2 * i);
+      ids.push_back(e.identifier());
+    }
+  });
+
+  race(segment, entities, 2000, 0, [&]
+  {
+    for (std::size_t i{}; i < 64; ++i)
+    {
+      identifier &id{ids[(static_cast<std::size_t>(next) * 7 + i) % ids.size()]};
+
+      reg.destroy(id);
+
+      auto e{reg.entity()};
+
+      e.emplace<value>(next);
+      e.emplace<twice>(2 * next++);
+      id = e.identifier();
+    }
+  });
+
+  heim::shared_memory_segment::remove(name);
+
+  HEIM_CHECK(segment.sequence() > 2);
+}
+
+// a reader running queries while the writer grows the registry, hence reallocates its containers
+void
+test_growth()
+{
+  std::string const name{"/heim-test-growth-" + std::to_string(::getpid())};
+
+  auto      segment{heim::shared_memory_segment::create(name, std::size_t{64} << 20)};
+  registry &reg    {segment.construct<registry>(segment.get_allocator<identifier>())};
+  int       next   {};
+
+  race(segment, 0, 500, 1 << 12, [&]
+  {
+    for (std::size_t i{}; i < 16 && next < (1 << 12); ++i)
+    {
+      auto e{reg.entity()};
+
+      e.emplace<value>(next);
+      e.emplace<twice>(2 * next++);
+    }
+  });
+
+  heim::shared_memory_segment::remove(name);
+
+  HEIM_CHECK(next == 1 << 12);
+}
+
+// the slots of the readers are limited, freed on detaching, and reclaimed from the processes that are
+// gone, even in the middle of a read section
+void
+test_readers()
+{
+  std::string const name{"/heim-test-readers-" + std::to_string(::getpid())};
+
+  auto      segment{heim::shared_memory_segment::create(name, std::size_t{1} << 20)};
+  registry &reg    {segment.construct<registry>(segment.get_allocator<identifier>())};
+
+  std::vector<heim::shared_memory_segment> readers;
+
+  for (std::size_t i{}; i < heim::shared_memory_arena::max_readers; ++i)
+    readers.push_back(heim::shared_memory_segment::attach(name));
+
+  bool exhausted{};
+  try
+  { static_cast<void>(heim::shared_memory_segment::attach(name)); }
+  catch (std::system_error const &e)
+  { exhausted = e.code() == std::errc::resource_unavailable_try_again; }
+  HEIM_CHECK(exhausted);
+
+  readers.pop_back();
+
+  pid_t const child{::fork()};
+
+  if (child == 0)
+  {
+    auto const attached{heim::shared_memory_segment::attach(name)};
+    static_cast<void>(attached.read<registry>([](registry const &) { std::_Exit(0); }));
+    std::_Exit(1);
+  }
+
+  int status{};
+  ::waitpid(child, &status, 0);
+  HEIM_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  // the write section waits for the read section the child left open until its slot is reclaimed
+  segment.write([&] { reg.entity().emplace<value>(1); });
+  readers.push_back(heim::shared_memory_segment::attach(name));
+
+  heim::shared_memory_segment::remove(name);
+
+  HEIM_CHECK(readers.back().read<registry>([](registry const &r) { HEIM_CHECK(r.size() == 1); }));
+}
+
+// a segment holds no root before it is constructed, and rejects roots of other types
+void
+test_root()
+{
+  std::string const name{"/heim-test-root-" + std::to_string(::getpid())};
+
+  auto segment{heim::shared_memory_segment::create(name, std::size_t{1} << 20)};
+  auto reader {heim::shared_memory_segment::attach(name)};
+
+  heim::shared_memory_segment::remove(name);
+
+  HEIM_CHECK(!reader.read<registry>([](registry const &) { }));
+
+  segment.construct<registry>(segment.get_allocator<identifier>());
+
+  HEIM_CHECK( reader.read<registry>([](registry const &reg) { HEIM_CHECK(reg.size() == 0); }));
+  HEIM_CHECK(!reader.read<value>   ([](value const &) { }));
+  HEIM_CHECK(segment.root<registry>() != nullptr);
+}
+
+
+int main()
+{
+  test_root();
+  test_reader_writer();
+  test_growth();
+  test_readers();
+
+  return heim::test::failures;
+}
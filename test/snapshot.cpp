@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include <heim/registry.hpp>
+#include <heim/ecs/registry/sparse/snapshot_writer.hpp>
+#include "check.hpp"
+
+struct position { float x, y; };
+struct health   { int hp; };
+struct tag      { };
+struct name     { char value[8]; };
+
+template<>
+struct heim::sparse::is_tracked_component<health>
+  : std::true_type
+{ };
+
+using registry
+= heim::sparse::static_registry::with_all<position, health, tag, name>;
+
+using writer
+= heim::sparse::snapshot_writer<registry, position, health, tag>;
+
+using identifier
+= registry::identifier_type;
+
+
+// writes the image of the specified registry to the specified file, then restores it on another
+// registry, which must then match it, and create the same identifiers
+void
+check_round_trip(writer &w, registry &original, char const * const path)
+{
+  HEIM_CHECK(w.capture(original) != 0);
+  w.wait();
+
+  auto const snapshot{heim::sparse::read_snapshot<registry, position, health, tag>(path)};
+
+  // the components of types that are not part of the image are cleared
+  registry restored{};
+
+  restored.entity().emplace<name>();
+
+  HEIM_CHECK(snapshot.restore(restored));
+  HEIM_CHECK(restored.container<name>().empty());
+  HEIM_CHECK(restored.size()           == original.size());
+  HEIM_CHECK(restored.destroyed_size() == original.destroyed_size());
+  HEIM_CHECK(restored.disabled_size()  == original.disabled_size());
+  HEIM_CHECK(restored.container<health>().enabled_size() == original.container<health>().enabled_size());
+
+  bool same{true};
+
+  for (auto e : original.query<heim::conjunction<position>>())
+  {
+    same = same
+        && !restored.expired(e.identifier())
+        && restored.get<position>(e.identifier()).x == e.get<position>().x
+        && restored.container<tag>().contains(e.identifier()) == e.matches<tag>();
+  }
+  for (auto e : original.query<heim::conjunction<health>>())
+    same = same && restored.get<health>(e.identifier()).hp == e.get<health>().hp;
+  for (auto const id : original.identifiers().subspan(original.destroyed_size()))
+    same = same && restored.enabled(id) == original.enabled(id);
+  HEIM_CHECK(same);
+
+  // the destroyed identifiers are recycled in the same order
+  registry copy{};
+
+  HEIM_CHECK(snapshot.restore(copy));
+  for (int i{}; i < 5; ++i)
+    HEIM_CHECK(copy.entity().identifier() == restored.entity().identifier());
+}
+
+// a registry restored from an image has the same identifiers, destroyed and disabled ones included,
+// and the same components of the captured types, after a first capture and after incremental ones
+void
+test_round_trip(char const * const path)
+{
+  registry                original{};
+  writer                  w       {path};
+  std::vector<identifier> ids;
+
+  for (int i{}; i < 3000; ++i)
+  {
+    auto e{original.entity()};
+
+    e.emplace<position>(static_cast<float>(i), 0.f);
+    if (i % 2 == 0)
+      e.emplace<health>(i);
+    if (i % 7 == 0)
+      e.emplace<tag>();
+    e.emplace<name>();
+    ids.push_back(e.identifier());
+  }
+
+  for (std::size_t i{}; i < ids.size(); i += 11)
+    original.destroy(ids[i]);
+  for (std::size_t i{1}; i < ids.size(); i += 13)
+    original.disable(ids[i]);
+
+  check_round_trip(w, original, path);
+
+  original.get<health>(ids[2]).hp = -2;
+  original.get<position>(ids[3]).x = -3.f;
+  original.destroy(ids[4]);
+  original.enable (ids[14]);
+  original.entity().emplace<health>(7);
+
+  check_round_trip(w, original, path);
+}
+
+// an image of another registry, or a truncated one, is rejected
+void
+test_rejected(char const * const path)
+{
+  registry original{};
+
+  {
+    writer w{path};
+
+    original.entity().emplace<health>(1);
+    HEIM_CHECK(w.capture(original) != 0);
+    w.wait();
+  }
+
+  bool rejected{};
+
+  try
+  { static_cast<void>(heim::sparse::read_snapshot<registry, position, health>(path)); }
+  catch (std::runtime_error const &)
+  { rejected = true; }
+
+  HEIM_CHECK(rejected);
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  rejected = false;
+
+  try
+  { static_cast<void>(heim::sparse::read_snapshot<registry, position, health, tag>(path)); }
+  catch (std::runtime_error const &)
+  { rejected = true; }
+
+  HEIM_CHECK(rejected);
+}
+
+
+int main()
+{
+  std::string const path{(std::filesystem::temp_directory_path() / ("heim-snapshot-" + std::to_string(::getpid()))).string()};
+
+  test_round_trip(path.c_str());
+  test_rejected  (path.c_str());
+
+  std::filesystem::remove(path);
+  return heim::test::failures;
+}
@@ -0,0 +1,117 @@
+#include <cstddef>
+#include <span>
+#include <vector>
+#include <heim/lib.hpp>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+struct velocity { int dx; };
+
+using registry
+= heim::sparse::generic_static_registry<
+    heim::default_identifier_t<>,
+    heim::guarded_allocator<heim::default_identifier_t<>>>
+    ::with_all<position, velocity>;
+
+constexpr std::size_t s_capacity{4096};
+
+
+// churns the specified registry through every operation covered by the steady-state contract, while
+// never holding more entities than the reserved capacity
+void
+churn(registry &reg)
+{
+  std::vector<registry::identifier_type> ids;
+  ids.reserve(s_capacity);
+
+  for (int round{}; round < 8; ++round)
+  {
+    for (std::size_t i{}; i < s_capacity; ++i)
+    {
+      auto e{reg.entity()};
+
+      e.emplace<position>(static_cast<int>(i));
+      if (i % 2 == 0)
+        e.emplace<velocity>(1);
+      ids.push_back(e.identifier());
+    }
+
+    for (auto e : reg.query<heim::conjunction<position, velocity>>())
+      e.get<position>().x += e.get<velocity>().dx;
+
+    reg.query<heim::conjunction<position, velocity>>().each_chunk<position, velocity const>(
+        [](auto, std::span<position> const p, std::span<velocity const> const v)
+        {
+          for (std::size_t i{}; i < p.size(); ++i)
+            p[i].x += v[i].dx;
+        });
+
+    for (std::size_t i{}; i < ids.size(); i += 3)
+      reg.disable(ids[i]);
+    for (std::size_t i{}; i < ids.size(); i += 3)
+      reg.enable(ids[i]);
+
+    for (std::size_t i{}; i < ids.size(); i += 2)
+      reg.erase<velocity>(ids[i]);
+
+    for (auto const id : ids)
+      reg.destroy(id);
+    ids.clear();
+  }
+}
+
+// a reserved registry does not allocate while churning within its reservation
+void
+test_reserved()
+{
+  registry reg{};
+  reg.reserve(s_capacity);
+
+  heim::freeze_allocations(heim::allocation_guard_mode::record);
+  churn(reg);
+  heim::thaw_allocations();
+
+  HEIM_CHECK(heim::allocation_guard::violations().empty());
+  heim::allocation_guard::clear();
+}
+
+// the guard does catch the allocations of a registry that is not reserved, and only those made while
+// frozen
+void
+test_unreserved()
+{
+  registry reg{};
+
+  heim::freeze_allocations(heim::allocation_guard_mode::record);
+  churn(reg);
+  heim::thaw_allocations();
+
+  std::size_t const violations{heim::allocation_guard::violations().size()};
+
+  HEIM_CHECK(violations > 0);
+  for (auto const &violation : heim::allocation_guard::violations())
+    HEIM_CHECK(violation.bytes > 0 && !violation.stack.empty());
+
+  // once storage has grown to its peak, churning again does not allocate
+  heim::allocation_guard::clear();
+  heim::freeze_allocations(heim::allocation_guard_mode::record);
+  churn(reg);
+  heim::thaw_allocations();
+
+  HEIM_CHECK(heim::allocation_guard::violations().empty());
+
+  registry other{};
+  other.reserve(16);
+  HEIM_CHECK(!heim::allocation_guard::frozen());
+  HEIM_CHECK(heim::allocation_guard::violations().empty());
+}
+
+
+int
+main()
+{
+  test_reserved();
+  test_unreserved();
+  return heim::test::failures;
+}
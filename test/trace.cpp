@@ -0,0 +1,385 @@
+#define HEIM_ENABLE_TRACE
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <heim/lib.hpp>
+#include <heim/registry.hpp>
+#include "check.hpp"
+
+struct position { int x; };
+
+
+// a JSON value, whose objects keep their keys next to their elements
+struct json_value
+{
+  char                     kind; // one of "{[\"0tfn"
+  std::string              text;
+  std::vector<std::string> keys;
+  std::vector<json_value>  elements;
+
+  [[nodiscard]]
+  json_value const *
+  find(std::string_view const key) const
+  {
+    for (std::size_t i{}; i < keys.size(); ++i)
+      if (keys[i] == key)
+        return &elements[i];
+    return nullptr;
+  }
+};
+
+// a strict parser of RFC 8259 documents, which is enough to tell whether the exported trace loads in
+// a trace viewer
+class json_parser
+{
+private:
+  std::string_view m_input;
+  std::size_t      m_pos;
+
+private:
+  void
+  m_skip()
+  {
+    while (m_pos < m_input.size() && (m_input[m_pos] == ' ' || m_input[m_pos] == '\n' || m_input[m_pos] == '\r' || m_input[m_pos] == '\t'))
+      ++m_pos;
+  }
+
+  bool
+  m_eat(char const c)
+  {
+    m_skip();
+    if (m_pos < m_input.size() && m_input[m_pos] == c)
+    {
+      ++m_pos;
+      return true;
+    }
+    return false;
+  }
+
+  bool
+  m_literal(std::string_view const word)
+  {
+    if (m_input.substr(m_pos, word.size()) != word)
+      return false;
+    m_pos += word.size();
+    return true;
+  }
+
+  bool
+  m_digits()
+  {
+    std::size_t const first{m_pos};
+    while (m_pos < m_input.size() && std::isdigit(static_cast<unsigned char>(m_input[m_pos])))
+      ++m_pos;
+    return m_pos != first;
+  }
+
+  bool
+  m_string(std::string &out)
+  {
+    if (!m_eat('"'))
+      return false;
+
+    while (m_pos < m_input.size())
+    {
+      char const c{m_input[m_pos++]};
+
+      if (c == '"')
+        return true;
+      if (static_cast<unsigned char>(c) < 0x20)
+        return false;
+      if (c != '\\')
+      {
+        out.push_back(c);
+        continue;
+      }
+      if (m_pos == m_input.size())
+        return false;
+
+      char const escaped{m_input[m_pos++]};
+      switch (escaped)
+      {
+      case '"': case '\\': case '/': out.push_back(escaped); break;
+      case 'b': out.push_back('\b'); break;
+      case 'f': out.push_back('\f'); break;
+      case 'n': out.push_back('\n'); break;
+      case 'r': out.push_back('\r'); break;
+      case 't': out.push_back('\t'); break;
+      case 'u':
+        for (int i{}; i < 4; ++i, ++m_pos)
+          if (m_pos == m_input.size() || !std::isxdigit(static_cast<unsigned char>(m_input[m_pos])))
+            return false;
+        out.push_back('?');
+        break;
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  bool
+  m_value(json_value &out, int const depth)
+  {
+    m_skip();
+    if (m_pos == m_input.size() || depth > 64)
+      return false;
+
+    char const c{m_input[m_pos]};
+
+    if (c == '{' || c == '[')
+    {
+      char const close{c == '{' ? '}' : ']'};
+
+      out.kind = c;
+      ++m_pos;
+      if (m_eat(close))
+        return true;
+
+      do
+      {
+        if (c == '{')
+        {
+          m_skip();
+          if (!m_string(out.keys.emplace_back()) || !m_eat(':'))
+            return false;
+        }
+        if (!m_value(out.elements.emplace_back(), depth + 1))
+          return false;
+      }
+      while (m_eat(','));
+
+      return m_eat(close);
+    }
+
+    if (c == '"')
+    {
+      out.kind = '"';
+      return m_string(out.text);
+    }
+
+    if (c == 't' || c == 'f' || c == 'n')
+    {
+      out.kind = c;
+      return m_literal(c == 't' ? "true" : c == 'f' ? "false" : "null");
+    }
+
+    std::size_t const first{m_pos};
+
+    out.kind = '0';
+    if (m_input[m_pos] == '-')
+      ++m_pos;
+    if (m_pos < m_input.size() && m_input[m_pos] == '0')
+      ++m_pos;
+    else if (!m_digits())
+      return false;
+    if (m_pos < m_input.size() && m_input[m_pos] == '.' && (++m_pos, !m_digits()))
+      return false;
+    if (m_pos < m_input.size() && (m_input[m_pos] == 'e' || m_input[m_pos] == 'E'))
+    {
+      ++m_pos;
+      if (m_pos < m_input.size() && (m_input[m_pos] == '+' || m_input[m_pos] == '-'))
+        ++m_pos;
+      if (!m_digits())
+        return false;
+    }
+
+    out.text = m_input.substr(first, m_pos - first);
+    return true;
+  }
+
+public:
+  explicit
+  json_parser(std::string_view const input)
+    : m_input{input}
+    , m_pos  {}
+  { }
+
+  [[nodiscard]]
+  bool
+  parse(json_value &out)
+  {
+    bool const ok{m_value(out, 0)};
+
+    m_skip();
+    return ok && m_pos == m_input.size();
+  }
+};
+
+
+struct parsed_event
+{
+  std::string   name;
+  std::uint64_t tid;
+  double        ts;
+  double        dur;
+};
+
+// exports the recorded zones, checks that the document is valid JSON in the Chrome trace-event format,
+// and returns its events
+std::vector<parsed_event>
+export_events()
+{
+  std::ostringstream os;
+  heim::trace_recorder::instance().write_chrome_json(os);
+
+  std::string const document{os.str()};
+  json_value        root{};
+
+  bool const parsed{json_parser{document}.parse(root)};
+  HEIM_CHECK(parsed);
+  if (!parsed)
+    return {};
+
+  json_value const *const unit  {root.find("displayTimeUnit")};
+  json_value const *const events{root.find("traceEvents")};
+
+  HEIM_CHECK(root.kind == '{');
+  HEIM_CHECK(unit   != nullptr && unit->kind   == '"' && unit->text == "ns");
+  HEIM_CHECK(events != nullptr && events->kind == '[');
+  if (events == nullptr)
+    return {};
+
+  std::vector<parsed_event> result;
+
+  for (json_value const &event : events->elements)
+  {
+    json_value const *const name{event.find("name")};
+    json_value const *const ph  {event.find("ph")};
+    json_value const *const tid {event.find("tid")};
+    json_value const *const ts  {event.find("ts")};
+    json_value const *const dur {event.find("dur")};
+
+    bool const complete{
+        name != nullptr && name->kind == '"'
+     && ph   != nullptr && ph->kind   == '"' && ph->text == "X"
+     && tid  != nullptr && tid->kind  == '0'
+     && ts   != nullptr && ts->kind   == '0'
+     && dur  != nullptr && dur->kind  == '0'
+     && event.find("pid") != nullptr};
+
+    HEIM_CHECK(complete);
+    if (complete)
+      result.push_back(parsed_event{name->text, std::stoull(tid->text), std::stod(ts->text), std::stod(dur->text)});
+  }
+
+  return result;
+}
+
+
+// a thread recording more zones than its buffer holds keeps the most recent ones, in order
+void
+test_wraparound()
+{
+  constexpr std::size_t size {heim::trace_recorder::buffer_size};
+  constexpr std::size_t extra{100};
+
+  heim::trace_recorder &recorder{heim::trace_recorder::instance()};
+  recorder.clear();
+
+  for (std::uint64_t i{}; i < size + extra; ++i)
+    recorder.record(heim::trace_event{"wrap", i * 1000, i * 1000 + 500});
+
+  std::vector<parsed_event> const events{export_events()};
+
+  HEIM_CHECK(events.size() == size);
+  if (events.size() != size)
+    return;
+
+  bool ordered{true};
+  for (std::size_t i{}; i < size; ++i)
+    ordered = ordered
+           && events[i].name == "wrap"
+           && events[i].ts   == static_cast<double>(i + extra)
+           && events[i].dur  == 0.5;
+  HEIM_CHECK(ordered);
+
+  recorder.clear();
+  HEIM_CHECK(export_events().empty());
+}
+
+// threads record into their own buffers, which are exported after the threads are joined, and names
+// are escaped
+void
+test_threads()
+{
+  constexpr int thread_count{4};
+  constexpr int zone_count  {1000};
+
+  heim::trace_recorder::instance().clear();
+
+  std::vector<std::thread> threads;
+  for (int t{}; t < thread_count; ++t)
+    threads.emplace_back(
+        []
+        {
+          for (int i{}; i < zone_count; ++i)
+          {
+            HEIM_TRACE_ZONE("worker \"zone\" \\");
+          }
+        });
+  for (auto &thread : threads)
+    thread.join();
+
+  std::vector<parsed_event> const events{export_events()};
+  std::map<std::uint64_t, int>    per_thread;
+
+  for (auto const &event : events)
+  {
+    HEIM_CHECK(event.name == "worker \"zone\" \\");
+    HEIM_CHECK(event.ts >= 0.0 && event.dur >= 0.0);
+    ++per_thread[event.tid];
+  }
+
+  HEIM_CHECK(events.size() == thread_count * zone_count);
+  HEIM_CHECK(per_thread.size() == thread_count);
+  for (auto const &[tid, count] : per_thread)
+    HEIM_CHECK(count == zone_count);
+}
+
+// the zones of the library are recorded, and writing to a file reports its failure
+void
+test_library_zones()
+{
+  heim::trace_recorder::instance().clear();
+
+  heim::sparse::static_registry::with<position> reg{};
+  for (int i{}; i < 10; ++i)
+    reg.entity().emplace<position>(i);
+
+  reg.query<heim::conjunction<position>>().each_chunk<position>(
+      [](auto, std::span<position> const p)
+      {
+        for (auto &pos : p)
+          ++pos.x;
+      });
+  reg.clear();
+
+  std::set<std::string> names;
+  for (auto const &event : export_events())
+    names.insert(event.name);
+
+  HEIM_CHECK(names.contains("heim::query::each_chunk"));
+  HEIM_CHECK(names.contains("heim::registry::clear"));
+
+  HEIM_CHECK(!heim::trace_recorder::instance().write_chrome_json("/dev/full"));
+}
+
+
+int
+main()
+{
+  test_wraparound();
+  test_threads();
+  test_library_zones();
+  return heim::test::failures;
+}
@@ -0,0 +1,146 @@
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <heim/lib/type_sequence.hpp>
+#include "check.hpp"
+
+using heim::type_sequence;
+
+using empty = type_sequence<>;
+using abc   = type_sequence<char, short, int>;
+using dupes = type_sequence<int, char, int, long, char, int>;
+
+template<typename T, typename U>
+inline constexpr
+bool
+same
+= std::is_same_v<T, U>;
+
+template<typename T>
+struct is_integral_meta
+  : std::is_integral<T>
+{ };
+
+template<typename T>
+struct pointer_meta
+  : std::add_pointer<T>
+{ };
+
+template<typename T, std::size_t N>
+concept gettable
+= requires { typename heim::type_sequence_get_t<T, N>; };
+
+template<typename T>
+concept has_back
+= requires { typename heim::type_sequence_back_t<T>; };
+
+
+// take and drop clamp their count to the size of the sequence
+static_assert(same<abc::take<0>,   empty>);
+static_assert(same<abc::take<2>,   type_sequence<char, short>>);
+static_assert(same<abc::take<3>,   abc>);
+static_assert(same<abc::take<7>,   abc>);
+static_assert(same<empty::take<1>, empty>);
+static_assert(same<abc::drop<0>,   abc>);
+static_assert(same<abc::drop<2>,   type_sequence<int>>);
+static_assert(same<abc::drop<3>,   empty>);
+static_assert(same<abc::drop<7>,   empty>);
+static_assert(same<empty::drop<1>, empty>);
+
+// unique keeps the first occurrence of each type, in order
+static_assert(same<dupes::unique, type_sequence<int, char, long>>);
+static_assert(same<abc::unique,   abc>);
+static_assert(same<empty::unique, empty>);
+static_assert(!dupes::is_unique);
+static_assert( abc  ::is_unique);
+static_assert( empty::is_unique);
+
+// reverse
+static_assert(same<abc::reverse,                  type_sequence<int, short, char>>);
+static_assert(same<type_sequence<int>::reverse,   type_sequence<int>>);
+static_assert(same<empty::reverse,                empty>);
+static_assert(same<abc::reverse::reverse,         abc>);
+
+// index is the first occurrence, or the size if there is none, and count counts every occurrence
+static_assert(dupes::index<int>    == 0);
+static_assert(dupes::index<char>   == 1);
+static_assert(dupes::index<long>   == 3);
+static_assert(dupes::index<float>  == dupes::size);
+static_assert(empty::index<int>    == 0);
+static_assert(dupes::count<int>    == 3);
+static_assert(dupes::count<char>   == 2);
+static_assert(dupes::count<float>  == 0);
+static_assert(empty::count<int>    == 0);
+static_assert( dupes::contains<long>);
+static_assert(!dupes::contains<float>);
+static_assert(!empty::contains<int>);
+
+// get, front and back, which are not defined past the end
+static_assert(same<abc::get<0>, char>);
+static_assert(same<abc::get<2>, int>);
+static_assert(same<abc::front,  char>);
+static_assert(same<abc::back,   int>);
+static_assert(same<type_sequence<long>::back, long>);
+static_assert( gettable<abc, 2>);
+static_assert(!gettable<abc, 3>);
+static_assert(!gettable<empty, 0>);
+static_assert( has_back<abc>);
+static_assert(!has_back<empty>);
+
+// join flattens one level, keeps non-sequence types and drops empty sequences
+static_assert(same<
+    type_sequence<char, type_sequence<short, int>, empty, type_sequence<type_sequence<long>>>::join,
+    type_sequence<char, short, int, type_sequence<long>>>);
+static_assert(same<type_sequence<empty, empty>::join, empty>);
+static_assert(same<empty::join, empty>);
+
+// filter, transform and remove_if
+static_assert(same<
+    type_sequence<float, int, double, char>::filter<is_integral_meta>,
+    type_sequence<int, char>>);
+static_assert(same<
+    type_sequence<float, int, double, char>::remove_if<is_integral_meta>,
+    type_sequence<float, double>>);
+static_assert(same<type_sequence<float>::filter<is_integral_meta>, empty>);
+static_assert(same<empty::filter<is_integral_meta>,               empty>);
+static_assert(same<abc::transform<pointer_meta>, type_sequence<char *, short *, int *>>);
+
+// concat of any number of sequences, empty ones included
+static_assert(same<abc::concat<empty, type_sequence<long>>, type_sequence<char, short, int, long>>);
+static_assert(same<empty::concat<abc, empty>,              abc>);
+static_assert(same<heim::type_sequence_concat_t<empty, empty, empty>, empty>);
+static_assert(same<heim::type_sequence_concat_t<abc>,                 abc>);
+static_assert(same<
+    heim::type_sequence_concat_t<type_sequence<char>, empty, type_sequence<short, int>, abc>,
+    type_sequence<char, short, int, char, short, int>>);
+
+// insert at the front, the middle and the end, erase of several and of out of range indices, and
+// stride
+static_assert(same<abc::insert<0, long>,         type_sequence<long, char, short, int>>);
+static_assert(same<abc::insert<1, long, float>,  type_sequence<char, long, float, short, int>>);
+static_assert(same<abc::insert<3, long>,         type_sequence<char, short, int, long>>);
+static_assert(same<empty::insert<0, long>,       type_sequence<long>>);
+static_assert(same<abc::erase<1>,                type_sequence<char, int>>);
+static_assert(same<abc::erase<2, 0>,             type_sequence<short>>);
+static_assert(same<abc::erase<5>,                abc>);
+static_assert(same<abc::erase<>,                 abc>);
+static_assert(same<dupes::stride<2>,             type_sequence<int, int, char>>);
+static_assert(same<dupes::stride<4>,             type_sequence<int, char>>);
+static_assert(same<abc::stride<1>,               abc>);
+
+// the remaining conveniences
+static_assert(abc::size   == 3 && !abc::empty);
+static_assert(empty::size == 0 &&  empty::empty);
+static_assert(same<abc::tuple,         std::tuple<char, short, int>>);
+static_assert(same<abc::pop_front,     type_sequence<short, int>>);
+static_assert(same<abc::pop_back,      type_sequence<char, short>>);
+static_assert(same<abc::select<2, 0>,  type_sequence<int, char>>);
+static_assert(same<abc::slice<1, 3>,   type_sequence<short, int>>);
+static_assert(same<abc::swap<0, 2>,    type_sequence<int, short, char>>);
+static_assert(same<abc::replace<1, long>, type_sequence<char, long, int>>);
+static_assert(same<dupes::remove<int>,    type_sequence<char, long, char>>);
+
+
+int
+main()
+{ return heim::test::failures; }